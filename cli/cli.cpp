@@ -0,0 +1,384 @@
+#include "cli.h"
+
+#include "account.h"
+#include "getunspentoutputshandler.h"
+#include "gettransactionshandler.h"
+#include "loginhandler.h"
+#include "network.h"
+#include "networkmanager.h"
+#include "receiveaddresscontroller.h"
+#include "resolver.h"
+#include "session.h"
+#include "wallet.h"
+#include "walletmanager.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QTimer>
+
+// transactions are fetched in pages of this size, as in the app
+static const int TRANSACTIONS_PAGE_SIZE = 30;
+
+void Cli::addOptions(QCommandLineParser& args)
+{
+    args.setApplicationDescription(
+        "Runs a command over one or more wallets and writes JSON lines to stdout.\n\n"
+        "Commands:\n"
+        "  networks       list the networks\n"
+        "  accounts       list the accounts with their balances\n"
+        "  transactions   list the transactions of each account\n"
+        "  utxos          list the unspent outputs of each account\n"
+        "  address        generate receive addresses, see --count");
+    args.addPositionalArgument("command", "networks, accounts, transactions, utxos or address");
+    args.addOption(QCommandLineOption("network", "Network of the wallet", "id", "mainnet"));
+    args.addOption(QCommandLineOption("username", "Watch-only username", "username"));
+    args.addOption(QCommandLineOption("password-file", "Read the watch-only password from a file, - for stdin", "file"));
+    args.addOption(QCommandLineOption("mnemonic-file", "Read the mnemonic from a file, - for stdin", "file"));
+    args.addOption(QCommandLineOption("wallets", "Read wallets from a JSON lines file, each with network and mnemonic or username and password", "file"));
+    args.addOption(QCommandLineOption("account", "Only the account with this pointer", "pointer"));
+    args.addOption(QCommandLineOption("count", "Addresses to generate per account", "count", "1"));
+    args.addOption(QCommandLineOption("timeout", "Seconds to wait for each step", "seconds", "120"));
+    args.addOption(QCommandLineOption("verbose", "Log debug and info messages to stderr"));
+    args.addOption(QCommandLineOption("debug", "Set the gdk log level to debug"));
+}
+
+Cli::Cli(const QCommandLineParser& args, QObject* parent)
+    : QObject(parent)
+    , m_args(args)
+    , m_command(args.positionalArguments().value(0))
+    , m_timeout(args.value("timeout").toInt() * 1000)
+{
+    m_out.open(stdout, QIODevice::WriteOnly);
+    m_err.open(stderr, QIODevice::WriteOnly);
+}
+
+void Cli::start()
+{
+    QTimer::singleShot(0, this, [this] {
+        const int exit_code = run();
+        m_out.flush();
+        m_err.flush();
+        QCoreApplication::exit(exit_code);
+    });
+}
+
+int Cli::run()
+{
+    if (m_command == "networks") {
+        listNetworks();
+        return 0;
+    }
+    if (!QStringList{ "accounts", "transactions", "utxos", "address" }.contains(m_command)) {
+        report({{ "error", QString("unknown command '%1'").arg(m_command) }});
+        return 2;
+    }
+
+    QList<QJsonObject> credentials;
+    if (!loadCredentials(credentials)) return 2;
+
+    int exit_code = 0;
+    for (int index = 0; index < credentials.size(); ++index) {
+        const int records = m_records;
+        QElapsedTimer timer;
+        timer.start();
+        QString error;
+        auto wallet = login(credentials.at(index), error);
+        if (!wallet) {
+            report({{ "wallet", index }, { "error", error }});
+            exit_code = 1;
+            continue;
+        }
+        const auto login_ms = timer.nsecsElapsed() / 1e6;
+        timer.restart();
+        if (!runCommand(index, wallet)) exit_code = 1;
+        report({
+            { "wallet", index },
+            { "command", m_command },
+            { "records", m_records - records },
+            { "login_ms", login_ms },
+            { "ms", timer.nsecsElapsed() / 1e6 },
+        });
+        wallet->disconnect();
+        wallet->deleteLater();
+    }
+    return exit_code;
+}
+
+bool Cli::loadCredentials(QList<QJsonObject>& credentials)
+{
+    if (m_args.isSet("wallets")) {
+        QFile file(m_args.value("wallets"));
+        if (!file.open(QFile::ReadOnly)) {
+            report({{ "error", QString("failed to open %1").arg(file.fileName()) }});
+            return false;
+        }
+        while (!file.atEnd()) {
+            const auto line = file.readLine().trimmed();
+            if (line.isEmpty()) continue;
+            const auto document = QJsonDocument::fromJson(line);
+            if (!document.isObject()) {
+                report({{ "error", QString("invalid wallet in %1").arg(file.fileName()) }});
+                return false;
+            }
+            credentials.append(document.object());
+        }
+        return true;
+    }
+
+    QJsonObject wallet{{ "network", m_args.value("network") }};
+    if (m_args.isSet("mnemonic-file")) {
+        QByteArray mnemonic;
+        if (!readFile(m_args.value("mnemonic-file"), mnemonic)) return false;
+        wallet.insert("mnemonic", QString::fromUtf8(mnemonic).simplified());
+    } else if (m_args.isSet("username")) {
+        QByteArray password;
+        if (m_args.isSet("password-file") && !readFile(m_args.value("password-file"), password)) return false;
+        wallet.insert("username", m_args.value("username"));
+        // only the line break that ends the file is dropped, passwords can
+        // start or end with spaces
+        if (password.endsWith('\n')) password.chop(1);
+        if (password.endsWith('\r')) password.chop(1);
+        wallet.insert("password", QString::fromUtf8(password));
+    } else {
+        report({{ "error", "set --wallets, --mnemonic-file or --username" }});
+        return false;
+    }
+    credentials.append(wallet);
+    return true;
+}
+
+bool Cli::readFile(const QString& file_name, QByteArray& data)
+{
+    QFile file;
+    if (file_name == "-") {
+        file.open(stdin, QFile::ReadOnly);
+    } else {
+        file.setFileName(file_name);
+        file.open(QFile::ReadOnly);
+    }
+    if (!file.isOpen()) {
+        report({{ "error", QString("failed to open %1").arg(file_name) }});
+        return false;
+    }
+    data = file.readAll();
+    return true;
+}
+
+Wallet* Cli::login(const QJsonObject& credentials, QString& error)
+{
+    auto network = NetworkManager::instance()->network(credentials.value("network").toString("mainnet"));
+    if (!network) {
+        error = "unknown network";
+        return nullptr;
+    }
+
+    const auto mnemonic = credentials.value("mnemonic").toString().split(' ', Qt::SkipEmptyParts);
+    const auto username = credentials.value("username").toString();
+    if (!mnemonic.isEmpty() && mnemonic.size() != 12 && mnemonic.size() != 24) {
+        error = "mnemonic must have 12 or 24 words";
+        return nullptr;
+    }
+    if (mnemonic.isEmpty() && username.isEmpty()) {
+        error = "missing mnemonic or username";
+        return nullptr;
+    }
+
+    auto session = new Session(network, this);
+    session->setActive(true);
+    if (!wait([session] { return session->isConnected(); })) {
+        error = "failed to connect";
+        session->deleteLater();
+        return nullptr;
+    }
+
+    auto handler = mnemonic.isEmpty()
+        ? new LoginHandler(username, credentials.value("password").toString(), session)
+        : new LoginHandler(mnemonic, session);
+    const bool logged_in = exec(handler, error);
+    handler->deleteLater();
+    if (!logged_in) {
+        session->deleteLater();
+        return nullptr;
+    }
+
+    auto wallet = WalletManager::instance()->createWallet(network, handler->walletHashId());
+    wallet->m_watch_only = mnemonic.isEmpty();
+    wallet->m_username = username;
+    wallet->setSession(session);
+    wallet->setSession();
+    session->setParent(wallet);
+    if (!wait([wallet] { return wallet->ready(); })) {
+        error = "wallet not ready";
+        wallet->deleteLater();
+        return nullptr;
+    }
+    return wallet;
+}
+
+bool Cli::runCommand(int index, Wallet* wallet)
+{
+    if (m_command == "accounts") {
+        listAccounts(index, wallet);
+        return true;
+    }
+    if (m_command == "transactions") return listTransactions(index, wallet);
+    if (m_command == "utxos") return listOutputs(index, wallet);
+    if (m_command == "address") return generateAddresses(index, wallet);
+    Q_UNREACHABLE();
+}
+
+QList<Account*> Cli::accounts(Wallet* wallet) const
+{
+    if (!m_args.isSet("account")) return wallet->m_accounts;
+    QList<Account*> accounts;
+    for (auto account : wallet->m_accounts) {
+        if (QString::number(account->pointer()) == m_args.value("account")) accounts.append(account);
+    }
+    return accounts;
+}
+
+void Cli::listNetworks()
+{
+    for (auto network : NetworkManager::instance()->networks()) {
+        print({{ "id", network->id() }, { "network", network->data() }});
+    }
+}
+
+void Cli::listAccounts(int index, Wallet* wallet)
+{
+    for (auto account : accounts(wallet)) {
+        const auto json = account->json();
+        print({
+            { "wallet", index },
+            { "account", static_cast<qint64>(account->pointer()) },
+            { "name", account->name() },
+            { "type", account->type() },
+            { "hidden", account->isHidden() },
+            { "satoshi", json.value("satoshi") },
+        });
+    }
+}
+
+bool Cli::listTransactions(int index, Wallet* wallet)
+{
+    for (auto account : accounts(wallet)) {
+        for (int first = 0;; first += TRANSACTIONS_PAGE_SIZE) {
+            auto handler = new GetTransactionsHandler(account->pointer(), first, TRANSACTIONS_PAGE_SIZE, wallet->session());
+            QString error;
+            const bool done = exec(handler, error);
+            handler->deleteLater();
+            if (!done) {
+                report({{ "wallet", index }, { "account", static_cast<qint64>(account->pointer()) }, { "error", error }});
+                return false;
+            }
+            const auto transactions = handler->transactions();
+            for (auto transaction : transactions) {
+                print({{ "wallet", index }, { "account", static_cast<qint64>(account->pointer()) }, { "transaction", transaction }});
+            }
+            if (transactions.size() < TRANSACTIONS_PAGE_SIZE) break;
+        }
+    }
+    return true;
+}
+
+bool Cli::listOutputs(int index, Wallet* wallet)
+{
+    for (auto account : accounts(wallet)) {
+        auto handler = new GetUnspentOutputsHandler(0, true, account);
+        QString error;
+        const bool done = exec(handler, error);
+        handler->deleteLater();
+        if (!done) {
+            report({{ "wallet", index }, { "account", static_cast<qint64>(account->pointer()) }, { "error", error }});
+            return false;
+        }
+        const auto outputs = handler->unspentOutputs();
+        for (auto i = outputs.begin(); i != outputs.end(); ++i) {
+            for (auto output : i.value().toArray()) {
+                print({{ "wallet", index }, { "account", static_cast<qint64>(account->pointer()) }, { "asset", i.key() }, { "output", output }});
+            }
+        }
+    }
+    return true;
+}
+
+bool Cli::generateAddresses(int index, Wallet* wallet)
+{
+    const int count = qMax(1, m_args.value("count").toInt());
+    for (auto account : accounts(wallet)) {
+        ReceiveAddressController controller;
+        for (int i = 0; i < count; ++i) {
+            // setting the account generates the first address
+            if (i == 0) {
+                controller.setAccount(account);
+            } else {
+                controller.generate();
+            }
+            if (!controller.generating() || !wait([&] { return !controller.generating(); })) {
+                report({{ "wallet", index }, { "account", static_cast<qint64>(account->pointer()) }, { "error", "failed to generate address" }});
+                return false;
+            }
+            print({{ "wallet", index }, { "account", static_cast<qint64>(account->pointer()) }, { "address", controller.result() }});
+        }
+    }
+    return true;
+}
+
+bool Cli::exec(Handler* handler, QString& error)
+{
+    bool done = false;
+    bool failed = false;
+    bool request_code = false;
+    QObject scope;
+    connect(handler, &Handler::done, &scope, [&] { done = true; });
+    connect(handler, &Handler::error, &scope, [&] { failed = true; });
+    connect(handler, &Handler::requestCode, &scope, [&] { request_code = true; });
+    connect(handler, &Handler::resolver, &scope, [](Resolver* resolver) {
+        resolver->resolve();
+    });
+    handler->exec();
+    if (!wait([&] { return done || failed || request_code; })) {
+        // the handler has no result yet
+        error = "timeout";
+        return false;
+    }
+    if (request_code) {
+        error = "two factor authentication is not supported";
+        return false;
+    }
+    if (failed) {
+        error = handler->result().value("error").toString("failed");
+        return false;
+    }
+    return true;
+}
+
+bool Cli::wait(const std::function<bool()>& done)
+{
+    // wakes the event loop up when no event arrives
+    QTimer ticker;
+    ticker.start(100);
+    QElapsedTimer timeout;
+    timeout.start();
+    while (!done()) {
+        if (timeout.hasExpired(m_timeout)) return false;
+        QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents);
+    }
+    return true;
+}
+
+void Cli::print(const QJsonObject& record)
+{
+    ++m_records;
+    m_out.write(QJsonDocument(record).toJson(QJsonDocument::Compact));
+    m_out.write("\n");
+}
+
+void Cli::report(const QJsonObject& record)
+{
+    m_err.write(QJsonDocument(record).toJson(QJsonDocument::Compact));
+    m_err.write("\n");
+    m_err.flush();
+}
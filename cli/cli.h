@@ -0,0 +1,55 @@
+#ifndef GREEN_CLI_H
+#define GREEN_CLI_H
+
+#include <QCommandLineParser>
+#include <QFile>
+#include <QJsonObject>
+#include <QObject>
+
+#include <functional>
+
+QT_FORWARD_DECLARE_CLASS(Account)
+QT_FORWARD_DECLARE_CLASS(Handler)
+QT_FORWARD_DECLARE_CLASS(Wallet)
+
+// Runs one command over one or more wallets without the UI. Records are
+// written to stdout as JSON lines, errors and per wallet timings to stderr,
+// also as JSON lines. The app quits when done, with exit code 1 if any
+// wallet failed.
+class Cli : public QObject
+{
+    Q_OBJECT
+public:
+    static void addOptions(QCommandLineParser& args);
+    explicit Cli(const QCommandLineParser& args, QObject* parent = nullptr);
+    void start();
+private:
+    int run();
+    bool loadCredentials(QList<QJsonObject>& credentials);
+    // reads the whole file, - for stdin
+    bool readFile(const QString& file_name, QByteArray& data);
+    Wallet* login(const QJsonObject& credentials, QString& error);
+    bool runCommand(int index, Wallet* wallet);
+    QList<Account*> accounts(Wallet* wallet) const;
+    void listNetworks();
+    void listAccounts(int index, Wallet* wallet);
+    bool listTransactions(int index, Wallet* wallet);
+    bool listOutputs(int index, Wallet* wallet);
+    bool generateAddresses(int index, Wallet* wallet);
+    // runs the handler to completion, two factor methods are not supported,
+    // on failure error is "timeout" or the error of the handler
+    bool exec(Handler* handler, QString& error);
+    // processes events until done returns true, false on timeout
+    bool wait(const std::function<bool()>& done);
+    void print(const QJsonObject& record);
+    void report(const QJsonObject& record);
+private:
+    const QCommandLineParser& m_args;
+    const QString m_command;
+    const int m_timeout;
+    QFile m_out;
+    QFile m_err;
+    int m_records{0};
+};
+
+#endif // GREEN_CLI_H
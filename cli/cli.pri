@@ -0,0 +1,14 @@
+# Headless command line front end, green-cli. Enable with
+#   qmake CONFIG+=cli
+# It replaces the QML UI and src/main.cpp, see cli/cli.cpp for the commands.
+
+SOURCES -= $$clean_path($$PWD/../src/main.cpp)
+
+INCLUDEPATH += $$PWD
+
+SOURCES += \
+    $$PWD/cli.cpp \
+    $$PWD/main.cpp
+
+HEADERS += \
+    $$PWD/cli.h
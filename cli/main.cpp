@@ -0,0 +1,52 @@
+#include "cli.h"
+#include "ga.h"
+#include "httpmanager.h"
+#include "walletmanager.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QLoggingCategory>
+#include <QStandardPaths>
+
+extern QString g_data_location;
+QCommandLineParser g_args;
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication::setApplicationName("Green");
+    QCoreApplication::setOrganizationName("Blockstream");
+    QCoreApplication::setOrganizationDomain("blockstream.com");
+    QCoreApplication::setApplicationVersion(QT_STRINGIFY(VERSION));
+
+    // share the data directory, and so the gdk cache, with the app
+    g_data_location = QStandardPaths::writableLocation(QStandardPaths::DataLocation);
+
+#ifdef Q_OS_LINUX
+    QCoreApplication::setApplicationName("Blockstream Green");
+#endif
+
+    QCoreApplication app(argc, argv);
+
+    g_args.addHelpOption();
+    g_args.addVersionOption();
+    Cli::addOptions(g_args);
+    g_args.addOption(QCommandLineOption("gdkrecord", "Record gdk traffic to a file", "file"));
+#ifdef GREEN_MOCK_GDK
+    g_args.addOption(QCommandLineOption("gdkreplay", "Replay gdk traffic from a file", "file"));
+#endif
+    g_args.process(app);
+
+    // stdout is reserved to records, keep stderr to warnings and errors
+    if (!g_args.isSet("verbose")) {
+        QLoggingCategory::setFilterRules("*.debug=false\n*.info=false");
+    }
+
+    gdk::init(g_args);
+
+    HttpManager http_manager;
+    WalletManager wallet_manager;
+
+    Cli cli(g_args);
+    cli.start();
+    return app.exec();
+}
@@ -4,6 +4,18 @@ macos {
     TARGET = "Blockstream Green"
 }
 
+# headless front end, see cli/cli.pri
+cli {
+    TARGET = green-cli
+    CONFIG += cmdline
+}
+
+# benchmarks, see tests/tests.pri
+test {
+    TARGET = green-tests
+    CONFIG += cmdline mockgdk
+}
+
 QMAKE_TARGET_COMPANY = Blockstream Corporation Inc.
 QMAKE_TARGET_PRODUCT = $${TARGET}
 QMAKE_TARGET_DESCRIPTION = $${TARGET}
@@ -40,8 +52,10 @@ include(release.pri)
 include(qzxing.pri)
 include(hidapi.pri)
 include(assets/assets.pri)
-include(qml/qml.pri)
+!cli:!test: include(qml/qml.pri)
 include(src/src.pri)
+cli: include(cli/cli.pri)
+test: include(tests/tests.pri)
 include(sa/sa.pri)
 
 CONFIG += lrelease embed_translations
@@ -55,10 +69,12 @@ macos {
     LIBS += -framework Foundation -framework Cocoa
     ICON = assets/icons/green.icns
 
-    QMAKE_POST_LINK += \
-        plutil -replace CFBundleName -string \"$${TARGET}\" \"$$OUT_PWD/$${TARGET}.app/Contents/Info.plist\" && \
-        plutil -replace CFBundleDisplayName -string \"$${TARGET}\" \"$$OUT_PWD/$${TARGET}.app/Contents/Info.plist\" && \
-        plutil -replace NSCameraUsageDescription -string \"We use the camera to scan QR codes\" \"$$OUT_PWD/$${TARGET}.app/Contents/Info.plist\"
+    !cli:!test {
+        QMAKE_POST_LINK += \
+            plutil -replace CFBundleName -string \"$${TARGET}\" \"$$OUT_PWD/$${TARGET}.app/Contents/Info.plist\" && \
+            plutil -replace CFBundleDisplayName -string \"$${TARGET}\" \"$$OUT_PWD/$${TARGET}.app/Contents/Info.plist\" && \
+            plutil -replace NSCameraUsageDescription -string \"We use the camera to scan QR codes\" \"$$OUT_PWD/$${TARGET}.app/Contents/Info.plist\"
+    }
 
     static {
         LIBS += $${GDK_PATH}/libgreenaddress_full.a
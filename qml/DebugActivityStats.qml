@@ -0,0 +1,53 @@
+import Blockstream.Green.Core 0.1
+import QtQuick 2.0
+import QtQuick.Controls 2.13
+import QtQuick.Layouts 1.13
+
+Pane {
+    parent: Overlay.overlay
+    anchors.top: parent.top
+    anchors.right: parent.right
+    anchors.margins: 4
+    z: 1000
+    visible: Qt.application.arguments.indexOf('--debugstats') > 0
+    background: Rectangle {
+        color: Qt.rgba(0, 0, 0, 0.8)
+        radius: 4
+        border.width: 2
+        border.color: 'black'
+    }
+    padding: 8
+    contentItem: GridLayout {
+        columns: 8
+        columnSpacing: 12
+        rowSpacing: 2
+        Repeater {
+            model: ['type', 'count', 'failed', 'cancelled', 'p50', 'p95', 'p99', 'max']
+            delegate: Label {
+                text: modelData
+                font.bold: true
+            }
+        }
+        Repeater {
+            model: visible ? ActivityManager.stats : []
+            delegate: Repeater {
+                readonly property var stat: modelData
+                model: [
+                    `${stat.kind}: ${stat.type}`,
+                    stat.count,
+                    stat.failed,
+                    stat.cancelled,
+                    stat.p50.toFixed(1),
+                    stat.p95.toFixed(1),
+                    stat.p99.toFixed(1),
+                    stat.max.toFixed(1),
+                ]
+                delegate: Label {
+                    Layout.alignment: index > 0 ? Qt.AlignRight : Qt.AlignLeft
+                    text: modelData
+                    font.pixelSize: 10
+                }
+            }
+        }
+    }
+}
@@ -163,6 +163,9 @@ ApplicationWindow {
     DebugActiveFocus {
     }
 
+    DebugActivityStats {
+    }
+
     Component {
         id: create_account_dialog
         CreateAccountDialog {}
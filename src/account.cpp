@@ -3,6 +3,7 @@
 #include "asset.h"
 #include "balance.h"
 #include "ga.h"
+#include "gdkrecorder.h"
 #include "handlers/getbalancehandler.h"
 #include "json.h"
 #include "network.h"
@@ -144,7 +145,7 @@ void Account::rename(QString name, bool active_focus)
     }
     if (this->name() == name) return;
     if (!active_focus) {
-        int res = GA_rename_subaccount(wallet()->session()->m_session, pointer(), name.toUtf8().constData());
+        int res = GDK_CALL(GA_rename_subaccount, wallet()->session()->m_session, pointer(), name.toUtf8().constData());
         Q_ASSERT(res == GA_OK);
         setName(name);
     }
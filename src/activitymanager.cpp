@@ -1,5 +1,15 @@
 #include "activity.h"
 #include "activitymanager.h"
+#include "trace.h"
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+
+#include <cmath>
+
+#define STATS_NOTIFY_INTERVAL 1000
+#define STATS_WRITE_INTERVAL 60000
 
 ActivityManager::ActivityManager(QObject *parent)
     : QObject(parent)
@@ -8,6 +18,21 @@ ActivityManager::ActivityManager(QObject *parent)
     m_model->setItemRoleNames({
         { Qt::UserRole + 1, QByteArrayLiteral("activity") }
     });
+    m_clock.start();
+
+    // coalesce notifications, each stats() call rebuilds the whole array
+    m_stats_timer.setInterval(STATS_NOTIFY_INTERVAL);
+    connect(&m_stats_timer, &QTimer::timeout, this, [this] {
+        if (!m_stats_dirty) return;
+        m_stats_dirty = false;
+        emit statsChanged();
+    });
+    m_stats_timer.start();
+
+    m_write_timer.setInterval(STATS_WRITE_INTERVAL);
+    connect(&m_write_timer, &QTimer::timeout, this, [this] {
+        if (m_write_dirty) writeStats();
+    });
 }
 
 ActivityManager* ActivityManager::instance()
@@ -22,21 +47,114 @@ void ActivityManager::exec(Activity *activity)
     connect(activity, &Activity::destroyed, [=] {
        removeActivity(activity);
     });
+    const auto finish = [=](Outcome outcome) {
+        auto i = m_activities.find(activity);
+        if (i == m_activities.end() || i->start < 0) return;
+        record("activity", i->type, elapsed() - i->start, outcome);
+        i->start = -1;
+    };
+    connect(activity, &Activity::finished, this, [=] { finish(Outcome::Finished); });
+    connect(activity, &Activity::failed, this, [=] { finish(Outcome::Failed); });
+    if (Trace::enabled()) {
+        const auto type = activity->type();
+        Trace::begin("activity", type, Trace::id(activity));
+        connect(activity, &Activity::finished, [=] {
+            Trace::end("activity", type, Trace::id(activity), {{ "status", "finished" }});
+        });
+        connect(activity, &Activity::failed, [=] {
+            Trace::end("activity", type, Trace::id(activity), {{ "status", "failed" }});
+        });
+    }
     activity->exec();
 }
 
+void ActivityManager::record(const char* kind, const QString& type, qint64 duration, Outcome outcome)
+{
+    auto& counter = m_counters[{ QString(kind), type }];
+    counter.count ++;
+    if (outcome == Outcome::Failed) counter.failed ++;
+    if (outcome == Outcome::Cancelled) counter.cancelled ++;
+    duration = qMax<qint64>(duration, 0);
+    counter.total += duration;
+    counter.max = qMax(counter.max, duration);
+    const int bucket = duration > 1 ? int(4 * std::log2(double(duration))) : 0;
+    counter.histogram[qMin(bucket, HISTOGRAM_SIZE - 1)] ++;
+    m_stats_dirty = true;
+    m_write_dirty = true;
+}
+
+qint64 ActivityManager::Counter::percentile(double p) const
+{
+    const quint64 rank = std::ceil(p * count);
+    quint64 sum = 0;
+    for (int i = 0; i < HISTOGRAM_SIZE; ++i) {
+        sum += histogram[i];
+        // report the bucket upper bound, never above the observed maximum
+        if (sum >= rank) return qMin(max, qint64(std::exp2((i + 1) / 4.0)));
+    }
+    return max;
+}
+
+QJsonArray ActivityManager::stats() const
+{
+    QJsonArray stats;
+    for (auto i = m_counters.begin(); i != m_counters.end(); ++i) {
+        const auto& counter = i.value();
+        // durations in milliseconds
+        stats.append(QJsonObject{
+            { "kind", i.key().first },
+            { "type", i.key().second },
+            { "count", qint64(counter.count) },
+            { "failed", qint64(counter.failed) },
+            { "cancelled", qint64(counter.cancelled) },
+            { "mean", counter.count > 0 ? counter.total / 1000.0 / counter.count : 0 },
+            { "p50", counter.percentile(0.50) / 1000.0 },
+            { "p95", counter.percentile(0.95) / 1000.0 },
+            { "p99", counter.percentile(0.99) / 1000.0 },
+            { "max", counter.max / 1000.0 },
+        });
+    }
+    return stats;
+}
+
+void ActivityManager::setStatsFile(const QString& file_name)
+{
+    m_stats_file = file_name;
+    if (m_stats_file.isEmpty()) {
+        m_write_timer.stop();
+    } else {
+        m_write_timer.start();
+    }
+}
+
+void ActivityManager::writeStats()
+{
+    if (m_stats_file.isEmpty()) return;
+    m_write_dirty = false;
+    QSaveFile file(m_stats_file);
+    if (!file.open(QIODevice::WriteOnly)) return;
+    const QJsonObject data{
+        { "uptime", elapsed() / 1000 },
+        { "stats", stats() },
+    };
+    file.write(QJsonDocument(data).toJson());
+    file.commit();
+}
+
 void ActivityManager::insertActivity(Activity* activity)
 {
     auto item = new QStandardItem;
     item->setData(QVariant::fromValue(activity));
-    m_activities.insert(activity, item);
+    m_activities.insert(activity, { item, activity->type(), elapsed() });
     m_model->appendRow(item);
 }
 
 void ActivityManager::removeActivity(Activity* activity)
 {
-    auto item = m_activities.take(activity);
-    Q_ASSERT(item);
-    m_model->takeRow(item->row());
-    delete item;
+    const auto entry = m_activities.take(activity);
+    Q_ASSERT(entry.item);
+    // destroyed before finishing or failing
+    if (entry.start >= 0) record("activity", entry.type, elapsed() - entry.start, Outcome::Cancelled);
+    m_model->takeRow(entry.item->row());
+    delete entry.item;
 }
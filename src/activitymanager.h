@@ -1,9 +1,14 @@
 #ifndef GREEN_ACTIVITYMANAGER_H
 #define GREEN_ACTIVITYMANAGER_H
 
+#include <QElapsedTimer>
+#include <QJsonArray>
 #include <QMap>
 #include <QObject>
 #include <QStandardItemModel>
+#include <QTimer>
+
+#include <array>
 
 QT_FORWARD_DECLARE_CLASS(Activity)
 
@@ -11,7 +16,14 @@ class ActivityManager : public QObject
 {
     Q_OBJECT
     Q_PROPERTY(QStandardItemModel* model READ model CONSTANT)
+    Q_PROPERTY(QJsonArray stats READ stats NOTIFY statsChanged)
 public:
+    enum class Outcome {
+        Finished,
+        Failed,
+        Cancelled,
+    };
+
     explicit ActivityManager(QObject *parent = nullptr);
 
     static ActivityManager* instance();
@@ -20,13 +32,50 @@ public:
 
     void exec(Activity* activity);
 
+    // aggregates a completed operation of the given kind (activity, handler)
+    // and type, duration is in microseconds
+    void record(const char* kind, const QString& type, qint64 duration, Outcome outcome);
+    qint64 elapsed() const { return m_clock.nsecsElapsed() / 1000; }
+    QJsonArray stats() const;
+    // periodically writes stats to the given file, if there are new samples
+    void setStatsFile(const QString& file_name);
+    void writeStats();
+
+signals:
+    void statsChanged();
+
 private:
     void insertActivity(Activity* activity);
     void removeActivity(Activity* activity);
 
 private:
+    // log-linear histogram with 4 buckets per power of 2 microseconds, the
+    // last bucket covers everything above ~1 hour
+    static constexpr int HISTOGRAM_SIZE = 128;
+    struct Counter {
+        quint64 count{0};
+        quint64 failed{0};
+        quint64 cancelled{0};
+        qint64 total{0};
+        qint64 max{0};
+        std::array<quint32, HISTOGRAM_SIZE> histogram{};
+        qint64 percentile(double p) const;
+    };
+    struct Entry {
+        QStandardItem* item{nullptr};
+        QString type;
+        qint64 start{-1};
+    };
+
     QStandardItemModel* const m_model;
-    QMap<Activity*, QStandardItem*> m_activities;
+    QMap<Activity*, Entry> m_activities;
+    QElapsedTimer m_clock;
+    QMap<QPair<QString, QString>, Counter> m_counters;
+    QTimer m_stats_timer;
+    QTimer m_write_timer;
+    QString m_stats_file;
+    bool m_stats_dirty{false};
+    bool m_write_dirty{false};
 };
 
 #endif // GREEN_ACTIVITYMANAGER_H
@@ -0,0 +1,500 @@
+#include "automationserver.h"
+
+#include "account.h"
+#include "createtransactionhandler.h"
+#include "getunspentoutputshandler.h"
+#include "gettransactionshandler.h"
+#include "network.h"
+#include "networkmanager.h"
+#include "receiveaddresscontroller.h"
+#include "resolver.h"
+#include "session.h"
+#include "wallet.h"
+#include "walletmanager.h"
+#include "watchonlylogincontroller.h"
+
+#include <QDebug>
+#include <QJsonDocument>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QSharedPointer>
+
+namespace {
+
+// error codes defined by JSON-RPC 2.0 and the ones used by the methods
+const int PARSE_ERROR = -32700;
+const int INVALID_REQUEST = -32600;
+const int METHOD_NOT_FOUND = -32601;
+const int INVALID_PARAMS = -32602;
+const int CALL_FAILED = -32000;
+const int CALL_TIMEOUT = -32001;
+
+// time a request may go without progress
+const int TIMEOUT = 120000;
+
+// transactions are fetched in pages of this size, as in the app
+const int TRANSACTIONS_PAGE_SIZE = 30;
+
+void Write(QLocalSocket* socket, const QJsonDocument& document)
+{
+    if (!socket) return;
+    socket->write(document.toJson(QJsonDocument::Compact));
+    socket->write("\n");
+}
+
+// for errors that can't be attributed to a request
+QJsonDocument ErrorResponse(int code, const QString& message)
+{
+    return QJsonDocument(QJsonObject{
+        { "jsonrpc", "2.0" },
+        { "id", QJsonValue::Null },
+        { "error", QJsonObject{{ "code", code }, { "message", message }} },
+    });
+}
+
+QJsonObject WalletJson(Wallet* wallet)
+{
+    return {
+        { "id", wallet->id() },
+        { "name", wallet->name() },
+        { "network", wallet->network()->id() },
+        { "watchOnly", wallet->isWatchOnly() },
+        { "persisted", wallet->isPersisted() },
+        { "hasPinData", wallet->hasPinData() },
+        { "authenticated", wallet->isAuthenticated() },
+        { "ready", wallet->ready() },
+    };
+}
+
+QJsonObject AccountJson(Account* account)
+{
+    return {
+        { "account", static_cast<qint64>(account->pointer()) },
+        { "name", account->name() },
+        { "type", account->type() },
+        { "hidden", account->isHidden() },
+        { "satoshi", account->json().value("satoshi") },
+    };
+}
+
+} // namespace
+
+AutomationCall::AutomationCall(QLocalSocket* socket, const QJsonValue& request, QObject* parent)
+    : QObject(parent)
+    , m_socket(socket)
+{
+    const auto object = request.toObject();
+    const auto params = object.value("params");
+    m_id = request.isObject() ? object.value("id") : QJsonValue(QJsonValue::Null);
+    m_valid = request.isObject()
+        && object.value("jsonrpc").toString() == "2.0"
+        && object.value("method").isString()
+        && (params.isUndefined() || params.isObject());
+    m_method = object.value("method").toString();
+    m_params = params.toObject();
+    m_stream = m_params.value("stream").toBool();
+
+    m_timeout.setSingleShot(true);
+    m_timeout.setInterval(TIMEOUT);
+    connect(&m_timeout, &QTimer::timeout, this, [this] {
+        fail(CALL_TIMEOUT, "timeout");
+    });
+    m_timeout.start();
+}
+
+void AutomationCall::add(const QJsonArray& items)
+{
+    if (m_finished) return;
+    m_count += items.size();
+    if (!m_stream) {
+        for (const auto& item : items) m_items.append(item);
+        return;
+    }
+    m_timeout.start();
+    if (isNotification()) return;
+    Write(m_socket, QJsonDocument(QJsonObject{
+        { "jsonrpc", "2.0" },
+        { "method", "stream" },
+        { "params", QJsonObject{{ "id", m_id }, { "items", items }} },
+    }));
+}
+
+void AutomationCall::finish()
+{
+    if (m_stream) {
+        finish(QJsonObject{{ "count", m_count }});
+    } else {
+        finish(m_items);
+    }
+}
+
+void AutomationCall::finish(const QJsonValue& result)
+{
+    respond({{ "result", result }});
+}
+
+void AutomationCall::fail(int code, const QString& message)
+{
+    respond({{ "error", QJsonObject{{ "code", code }, { "message", message }} }});
+}
+
+void AutomationCall::respond(QJsonObject response)
+{
+    if (m_finished) return;
+    m_finished = true;
+    m_timeout.stop();
+    if (isNotification()) {
+        response = {};
+    } else {
+        response.insert("jsonrpc", "2.0");
+        response.insert("id", m_id.isUndefined() ? QJsonValue(QJsonValue::Null) : m_id);
+    }
+    emit finished(response);
+    deleteLater();
+}
+
+AutomationServer::AutomationServer(QObject* parent)
+    : QObject(parent)
+    , m_server(new QLocalServer(this))
+    , m_methods({
+        { "wallet.list", &AutomationServer::listWallets },
+        { "wallet.login", &AutomationServer::login },
+        { "wallet.logout", &AutomationServer::logout },
+        { "wallet.refresh", &AutomationServer::refresh },
+        { "account.list", &AutomationServer::listAccounts },
+        { "account.transactions", &AutomationServer::listTransactions },
+        { "account.utxos", &AutomationServer::listOutputs },
+        { "account.address", &AutomationServer::generateAddress },
+        { "account.createTransaction", &AutomationServer::createTransaction },
+    })
+{
+    // only the user running the app may connect
+    m_server->setSocketOptions(QLocalServer::UserAccessOption);
+    connect(m_server, &QLocalServer::newConnection, this, &AutomationServer::acceptConnection);
+}
+
+bool AutomationServer::listen(const QString& name)
+{
+    if (!m_server->listen(name) && m_server->serverError() == QAbstractSocket::AddressInUseError) {
+        // a socket left behind by a previous run that didn't quit cleanly
+        // refuses connections, one that accepts them is in use
+        QLocalSocket socket;
+        socket.connectToServer(name);
+        if (!socket.waitForConnected(1000) && socket.error() == QLocalSocket::ConnectionRefusedError) {
+            QLocalServer::removeServer(name);
+            m_server->listen(name);
+        }
+    }
+    if (!m_server->isListening()) {
+        qWarning() << "automation: failed to listen on" << name << m_server->errorString();
+        return false;
+    }
+    qInfo() << "automation: listening on" << m_server->fullServerName();
+    return true;
+}
+
+void AutomationServer::acceptConnection()
+{
+    while (auto socket = m_server->nextPendingConnection()) {
+        connect(socket, &QLocalSocket::readyRead, this, [this, socket] { read(socket); });
+        connect(socket, &QLocalSocket::disconnected, socket, &QObject::deleteLater);
+    }
+}
+
+void AutomationServer::read(QLocalSocket* socket)
+{
+    while (socket->canReadLine()) {
+        const auto line = socket->readLine().trimmed();
+        if (!line.isEmpty()) handle(socket, line);
+    }
+}
+
+void AutomationServer::handle(QLocalSocket* socket, const QByteArray& line)
+{
+    QJsonParseError error;
+    const auto document = QJsonDocument::fromJson(line, &error);
+    if (error.error != QJsonParseError::NoError) {
+        Write(socket, ErrorResponse(PARSE_ERROR, error.errorString()));
+        return;
+    }
+
+    if (document.isObject()) {
+        auto call = new AutomationCall(socket, document.object(), this);
+        connect(call, &AutomationCall::finished, this, [socket = QPointer<QLocalSocket>(socket)](const QJsonObject& response) {
+            if (!response.isEmpty()) Write(socket, QJsonDocument(response));
+        });
+        dispatch(call);
+        return;
+    }
+
+    const auto requests = document.array();
+    if (requests.isEmpty()) {
+        Write(socket, ErrorResponse(INVALID_REQUEST, "empty batch"));
+        return;
+    }
+
+    // responses are kept in request order and written together
+    auto responses = QSharedPointer<QVector<QJsonObject>>::create(requests.size());
+    auto pending = QSharedPointer<int>::create(requests.size());
+    for (int index = 0; index < requests.size(); ++index) {
+        auto call = new AutomationCall(socket, requests.at(index), this);
+        connect(call, &AutomationCall::finished, this, [socket = QPointer<QLocalSocket>(socket), responses, pending, index](const QJsonObject& response) {
+            (*responses)[index] = response;
+            if (--*pending > 0) return;
+            QJsonArray batch;
+            for (const auto& item : *responses) {
+                if (!item.isEmpty()) batch.append(item);
+            }
+            if (!batch.isEmpty()) Write(socket, QJsonDocument(batch));
+        });
+        dispatch(call);
+    }
+}
+
+void AutomationServer::dispatch(AutomationCall* call)
+{
+    if (!call->isValid()) {
+        call->fail(INVALID_REQUEST, "invalid request");
+        return;
+    }
+    const auto method = m_methods.value(call->method());
+    if (!method) {
+        call->fail(METHOD_NOT_FOUND, QString("unknown method '%1'").arg(call->method()));
+        return;
+    }
+    (this->*method)(call);
+}
+
+Wallet* AutomationServer::wallet(AutomationCall* call) const
+{
+    auto wallet = WalletManager::instance()->wallet(call->params().value("wallet").toString());
+    if (!wallet) call->fail(INVALID_PARAMS, "unknown wallet");
+    return wallet;
+}
+
+Wallet* AutomationServer::readyWallet(AutomationCall* call) const
+{
+    auto wallet = this->wallet(call);
+    if (wallet && !wallet->ready()) {
+        call->fail(CALL_FAILED, "wallet not ready");
+        return nullptr;
+    }
+    return wallet;
+}
+
+Account* AutomationServer::account(AutomationCall* call) const
+{
+    auto wallet = readyWallet(call);
+    if (!wallet) return nullptr;
+    const auto pointer = call->params().value("account");
+    for (auto account : wallet->m_accounts) {
+        if (pointer.isDouble() && account->pointer() == static_cast<quint32>(pointer.toInt())) return account;
+    }
+    call->fail(INVALID_PARAMS, "unknown account");
+    return nullptr;
+}
+
+void AutomationServer::finishWhenReady(AutomationCall* call, Wallet* wallet)
+{
+    if (wallet->ready()) {
+        call->finish(WalletJson(wallet));
+        return;
+    }
+    connect(wallet, &Wallet::readyChanged, call, [call, wallet](bool ready) {
+        if (ready) call->finish(WalletJson(wallet));
+    });
+}
+
+void AutomationServer::exec(AutomationCall* call, Handler* handler, const std::function<void()>& done)
+{
+    connect(handler, &Handler::done, call, done);
+    connect(handler, &Handler::error, call, [call, handler] {
+        call->fail(CALL_FAILED, handler->result().value("error").toString());
+    });
+    connect(handler, &Handler::requestCode, call, [call] {
+        call->fail(CALL_FAILED, "two factor authentication is not supported");
+    });
+    // with the handler as context, so that the handler still finishes and is
+    // released when the call is deleted first, for instance on timeout
+    connect(handler, &Handler::resolver, handler, [](Resolver* resolver) {
+        resolver->resolve();
+    });
+    connect(handler, &Handler::done, handler, &QObject::deleteLater);
+    connect(handler, &Handler::error, handler, &QObject::deleteLater);
+    connect(handler, &Handler::requestCode, handler, &QObject::deleteLater);
+    handler->exec();
+}
+
+void AutomationServer::listWallets(AutomationCall* call)
+{
+    QJsonArray wallets;
+    for (auto wallet : WalletManager::instance()->m_wallets) {
+        wallets.append(WalletJson(wallet));
+    }
+    call->finish(wallets);
+}
+
+void AutomationServer::login(AutomationCall* call)
+{
+    const auto params = call->params();
+
+    if (params.contains("pin")) {
+        auto wallet = this->wallet(call);
+        if (!wallet) return;
+        if (!wallet->isAuthenticated()) {
+            if (!wallet->hasPinData()) {
+                call->fail(INVALID_PARAMS, "wallet has no pin");
+                return;
+            }
+            if (wallet->loginAttemptsRemaining() == 0) {
+                call->fail(CALL_FAILED, "no login attempts remaining");
+                return;
+            }
+            // the controller sets the wallet back to unauthenticated on a wrong pin
+            connect(wallet, &Wallet::authenticationChanged, call, [call, wallet] {
+                if (wallet->authentication() == Wallet::Unauthenticated) call->fail(CALL_FAILED, "id_invalid_pin");
+            });
+            auto controller = new LoginWithPinController(call);
+            controller->setWallet(wallet);
+            controller->setPin(params.value("pin").toString().toLocal8Bit());
+        }
+        finishWhenReady(call, wallet);
+        return;
+    }
+
+    auto network = NetworkManager::instance()->network(params.value("network").toString());
+    if (!network) {
+        call->fail(INVALID_PARAMS, "unknown network");
+        return;
+    }
+    const auto username = params.value("username").toString();
+    const auto password = params.value("password").toString();
+    if (username.isEmpty() || password.isEmpty()) {
+        call->fail(INVALID_PARAMS, "missing pin or username and password");
+        return;
+    }
+
+    auto controller = new WatchOnlyLoginController(call);
+    controller->setNetwork(network);
+    controller->setUsername(username);
+    controller->setPassword(password);
+    connect(controller, &WatchOnlyLoginController::unauthorized, call, [call] {
+        call->fail(CALL_FAILED, "unauthorized");
+    });
+    connect(controller, &WatchOnlyLoginController::walletChanged, call, [this, call](Wallet* wallet) {
+        if (wallet) finishWhenReady(call, wallet);
+    });
+    controller->login();
+}
+
+void AutomationServer::logout(AutomationCall* call)
+{
+    auto wallet = this->wallet(call);
+    if (!wallet) return;
+    if (wallet->isAuthenticated()) wallet->disconnect();
+    call->finish(WalletJson(wallet));
+}
+
+void AutomationServer::refresh(AutomationCall* call)
+{
+    auto wallet = readyWallet(call);
+    if (!wallet) return;
+    connect(wallet, &Entity::activitiesChanged, call, [call, wallet] {
+        if (!wallet->hasActivities()) call->finish(WalletJson(wallet));
+    });
+    wallet->reload(true);
+}
+
+void AutomationServer::listAccounts(AutomationCall* call)
+{
+    auto wallet = readyWallet(call);
+    if (!wallet) return;
+    QJsonArray accounts;
+    for (auto account : wallet->m_accounts) {
+        accounts.append(AccountJson(account));
+    }
+    call->add(accounts);
+    call->finish();
+}
+
+void AutomationServer::listTransactions(AutomationCall* call)
+{
+    auto account = this->account(call);
+    if (account) fetchTransactions(call, account, 0);
+}
+
+void AutomationServer::fetchTransactions(AutomationCall* call, Account* account, int first)
+{
+    auto handler = new GetTransactionsHandler(account->pointer(), first, TRANSACTIONS_PAGE_SIZE, account->wallet()->session());
+    exec(call, handler, [this, call, account, first, handler] {
+        const auto transactions = handler->transactions();
+        call->add(transactions);
+        if (transactions.size() < TRANSACTIONS_PAGE_SIZE) {
+            call->finish();
+        } else {
+            fetchTransactions(call, account, first + TRANSACTIONS_PAGE_SIZE);
+        }
+    });
+}
+
+void AutomationServer::listOutputs(AutomationCall* call)
+{
+    auto account = this->account(call);
+    if (!account) return;
+    auto handler = new GetUnspentOutputsHandler(0, true, account);
+    exec(call, handler, [call, handler] {
+        const auto outputs = handler->unspentOutputs();
+        for (auto i = outputs.begin(); i != outputs.end(); ++i) {
+            call->add(i.value().toArray());
+        }
+        call->finish();
+    });
+}
+
+void AutomationServer::generateAddress(AutomationCall* call)
+{
+    auto account = this->account(call);
+    if (!account) return;
+    auto controller = new ReceiveAddressController(call);
+    connect(controller, &ReceiveAddressController::generatingChanged, call, [call, controller](bool generating) {
+        if (!generating) call->finish(controller->result());
+    });
+    // setting the account generates the address
+    controller->setAccount(account);
+    if (!controller->generating()) call->fail(CALL_FAILED, "failed to generate address");
+}
+
+void AutomationServer::createTransaction(AutomationCall* call)
+{
+    auto account = this->account(call);
+    if (!account) return;
+    const auto params = call->params();
+    const auto addressees = params.value("addressees").toArray();
+    if (addressees.isEmpty()) {
+        call->fail(INVALID_PARAMS, "missing addressees");
+        return;
+    }
+
+    // as in the send controller, coins are selected from all the outputs
+    auto handler = new GetUnspentOutputsHandler(0, true, account);
+    exec(call, handler, [this, call, account, params, addressees, handler] {
+        QJsonObject details{
+            { "subaccount", static_cast<qint64>(account->pointer()) },
+            { "addressees", addressees },
+            { "send_all", params.value("send_all").toBool() },
+            { "utxo_strategy", "default" },
+            { "utxos", handler->unspentOutputs() },
+        };
+        if (params.contains("fee_rate")) details.insert("fee_rate", params.value("fee_rate"));
+        auto create = new CreateTransactionHandler(details, account->wallet()->session());
+        exec(call, create, [call, create] {
+            const auto transaction = create->transaction();
+            const auto error = transaction.value("error").toString();
+            if (error.isEmpty()) {
+                call->finish(transaction);
+            } else {
+                call->fail(CALL_FAILED, error);
+            }
+        });
+    });
+}
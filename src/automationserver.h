@@ -0,0 +1,97 @@
+#ifndef GREEN_AUTOMATIONSERVER_H
+#define GREEN_AUTOMATIONSERVER_H
+
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+
+#include <functional>
+
+QT_FORWARD_DECLARE_CLASS(Account)
+QT_FORWARD_DECLARE_CLASS(Handler)
+QT_FORWARD_DECLARE_CLASS(QLocalServer)
+QT_FORWARD_DECLARE_CLASS(QLocalSocket)
+QT_FORWARD_DECLARE_CLASS(Wallet)
+
+// One JSON-RPC request. It is deleted once answered, which also drops the
+// connections made with it as context. Requests that make no progress for
+// a while fail with a timeout.
+class AutomationCall : public QObject
+{
+    Q_OBJECT
+public:
+    AutomationCall(QLocalSocket* socket, const QJsonValue& request, QObject* parent);
+    bool isValid() const { return m_valid; }
+    QString method() const { return m_method; }
+    QJsonObject params() const { return m_params; }
+    // adds items to the result, with "stream": true in the params they are
+    // written right away in stream notifications and the result counts them
+    void add(const QJsonArray& items);
+    // finishes with the added items
+    void finish();
+    void finish(const QJsonValue& result);
+    void fail(int code, const QString& message);
+signals:
+    // empty for notifications, which are not answered
+    void finished(const QJsonObject& response);
+private:
+    bool isNotification() const { return m_valid && m_id.isUndefined(); }
+    void respond(QJsonObject response);
+private:
+    QPointer<QLocalSocket> m_socket;
+    QJsonValue m_id;
+    QString m_method;
+    QJsonObject m_params;
+    bool m_valid{false};
+    bool m_stream{false};
+    bool m_finished{false};
+    int m_count{0};
+    QJsonArray m_items;
+    QTimer m_timeout;
+};
+
+// Serves a JSON-RPC 2.0 API on a local socket so that scripts can drive the
+// running app: log wallets in, refresh them, list their accounts,
+// transactions and outputs, generate addresses and create unsigned
+// transactions. Requests and responses are one JSON document per line, a
+// line with an array is a batch answered with one array once all of its
+// requests finish. Requests run concurrently, the same way the UI runs
+// them. Started with --automation <name>.
+class AutomationServer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit AutomationServer(QObject* parent = nullptr);
+    bool listen(const QString& name);
+private slots:
+    void acceptConnection();
+private:
+    void read(QLocalSocket* socket);
+    void handle(QLocalSocket* socket, const QByteArray& line);
+    void dispatch(AutomationCall* call);
+    Wallet* wallet(AutomationCall* call) const;
+    Wallet* readyWallet(AutomationCall* call) const;
+    Account* account(AutomationCall* call) const;
+    void finishWhenReady(AutomationCall* call, Wallet* wallet);
+    // runs the handler and calls done if it succeeds, otherwise fails the
+    // call, two factor methods are not supported
+    void exec(AutomationCall* call, Handler* handler, const std::function<void()>& done);
+    void fetchTransactions(AutomationCall* call, Account* account, int first);
+    void listWallets(AutomationCall* call);
+    void login(AutomationCall* call);
+    void logout(AutomationCall* call);
+    void refresh(AutomationCall* call);
+    void listAccounts(AutomationCall* call);
+    void listTransactions(AutomationCall* call);
+    void listOutputs(AutomationCall* call);
+    void generateAddress(AutomationCall* call);
+    void createTransaction(AutomationCall* call);
+private:
+    QLocalServer* const m_server;
+    const QHash<QString, void (AutomationServer::*)(AutomationCall*)> m_methods;
+};
+
+#endif // GREEN_AUTOMATIONSERVER_H
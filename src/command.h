@@ -1,6 +1,7 @@
 #ifndef GREEN_COMMAND_H
 #define GREEN_COMMAND_H
 
+#include <QElapsedTimer>
 #include <QObject>
 
 QT_FORWARD_DECLARE_CLASS(Device)
@@ -13,6 +14,9 @@ class Command : public QObject
 public:
     Command(CommandBatch* batch = nullptr);
     virtual ~Command();
+    // called when the command is no longer wanted, after its batch failed,
+    // transports drop it if it wasn't written yet and drop its response
+    virtual void discard() {}
 public slots:
     virtual void exec() = 0;
 signals:
@@ -41,20 +45,29 @@ public:
     QByteArray m_response;
 };
 
+// Runs commands in order. Consecutive device commands are handed to the
+// transport together, up to a small window, so the next APDU is written as
+// soon as the previous response arrives instead of after an event loop
+// round trip. When a command fails the ones already handed to the transport
+// are discarded. Batches with an object name are stages: their duration goes
+// to the activity stats and, when tracing, to a span.
 class CommandBatch : public Command
 {
     Q_OBJECT
 public:
     void add(Command* command) { m_commands.append(command); }
-    void exec() override {
-        if (m_commands.isEmpty()) return emit finished();
-        auto next = m_commands.takeFirst();
-        connect(next, &Command::finished, this, &Command::exec, Qt::QueuedConnection);
-        connect(next, &Command::error, this, &Command::error);
-        next->exec();
-    }
+    void exec() override;
+    void discard() override;
 private:
+    void next();
+    void record(bool failed);
     QList<Command*> m_commands;
+    QElapsedTimer m_timer;
+    QList<Command*> m_pending;
+    int m_count{0};
+    bool m_running{false};
+    bool m_again{false};
+    bool m_failed{false};
 };
 
 class GenericCommand : public DeviceCommand
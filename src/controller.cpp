@@ -1,5 +1,6 @@
 #include "controller.h"
 #include "device.h"
+#include "gdkrecorder.h"
 #include "handler.h"
 #include "json.h"
 #include "output.h"
@@ -28,7 +29,7 @@ class SetUnspentOutputsStatusHandler : public Handler
             { "list", list }
         });
 
-        int err = GA_set_unspent_outputs_status(session, details.get(), auth_handler);
+        int err = GDK_CALL(GA_set_unspent_outputs_status, session, details.get(), auth_handler);
         Q_ASSERT(err == GA_OK);
     }
 public:
@@ -45,7 +46,7 @@ class DisableAllPinLoginsHandler : public Handler
     void call(GA_session* session, GA_auth_handler** auth_handler) override
     {
         Q_UNUSED(auth_handler)
-        int err = GA_disable_all_pin_logins(session);
+        int err = GDK_CALL(GA_disable_all_pin_logins, session);
         Q_ASSERT(err == GA_OK);
     }
 public:
@@ -60,7 +61,7 @@ class ChangeSettingsHandler : public Handler
     QJsonObject m_data;
     void call(GA_session* session, GA_auth_handler** auth_handler) override {
         auto data = Json::fromObject(m_data);
-        int err = GA_change_settings(session, data.get(), auth_handler);
+        int err = GDK_CALL(GA_change_settings, session, data.get(), auth_handler);
         Q_ASSERT(err == GA_OK);
     }
 public:
@@ -75,7 +76,7 @@ class SendNLocktimesHandler : public Handler
 {
     void call(GA_session* session, GA_auth_handler** auth_handler) override {
         Q_UNUSED(auth_handler);
-        int err = GA_send_nlocktimes(session);
+        int err = GDK_CALL(GA_send_nlocktimes, session);
         // Can't Q_ASSERT(err == GA_OK) because err != GA_OK
         // if no utxos found (e.g. new wallet)
         Q_UNUSED(err);
@@ -93,7 +94,7 @@ class ChangeSettingsTwoFactorHandler : public Handler
     QJsonObject m_details;
     void call(GA_session* session, GA_auth_handler** auth_handler) override {
         auto details = Json::fromObject(m_details);
-        int res = GA_change_settings_twofactor(session, m_method.data(), details.get(), auth_handler);
+        int res = GDK_CALL(GA_change_settings_twofactor, session, m_method.data(), details.get(), auth_handler);
         Q_ASSERT(res == GA_OK);
     }
 public:
@@ -110,7 +111,7 @@ class TwoFactorChangeLimitsHandler : public Handler
     QJsonObject m_details;
     void call(GA_session* session, GA_auth_handler** auth_handler) override {
         auto details = Json::fromObject(m_details);
-        GA_twofactor_change_limits(session, details.get(), auth_handler);
+        GDK_CALL(GA_twofactor_change_limits, session, details.get(), auth_handler);
     }
 public:
     TwoFactorChangeLimitsHandler(const QJsonObject& details, Session* session)
@@ -123,7 +124,7 @@ public:
 class TwoFactorCancelResetHandler : public Handler
 {
     void call(GA_session* session, GA_auth_handler** auth_handler) override {
-        int res = GA_twofactor_cancel_reset(session, auth_handler);
+        int res = GDK_CALL(GA_twofactor_cancel_reset, session, auth_handler);
         Q_ASSERT(res == GA_OK);
     }
 public:
@@ -138,7 +139,7 @@ class SetCsvTimeHandler : public Handler
     const int m_value;
     void call(GA_session* session, GA_auth_handler** auth_handler) override {
         auto details = Json::fromObject({{ "value", m_value }});
-        int res = GA_set_csvtime(session, details.get(), auth_handler);
+        int res = GDK_CALL(GA_set_csvtime, session, details.get(), auth_handler);
         Q_ASSERT(res == GA_OK);
     }
 public:
@@ -444,7 +445,7 @@ Handler* Controller::getCredentials()
 
 void TwoFactorResetHandler::call(GA_session *session, GA_auth_handler **auth_handler) {
     const uint32_t is_dispute = GA_FALSE;
-    int res = GA_twofactor_reset(session, m_email.data(), is_dispute, auth_handler);
+    int res = GDK_CALL(GA_twofactor_reset, session, m_email.data(), is_dispute, auth_handler);
     Q_ASSERT(res == GA_OK);
 }
 
@@ -1,6 +1,7 @@
 #include "activitymanager.h"
 #include "command.h"
 #include "ga.h"
+#include "gdkrecorder.h"
 #include "json.h"
 #include "handlers/connecthandler.h"
 #include "handlers/loginhandler.h"
@@ -212,7 +213,7 @@ void LedgerDeviceController::identify()
         const auto net_params = Json::fromObject({{ "name", m_network->id() }});
         const auto params = Json::fromObject({{ "master_xpub", QString::fromLocal8Bit(master_xpub) }});
         GA_json* output;
-        int rc = GA_get_wallet_identifier(net_params.get(), params.get(), &output);
+        int rc = GDK_CALL(GA_get_wallet_identifier, net_params.get(), params.get(), &output);
         Q_ASSERT(rc == GA_OK);
         const auto identifier = Json::toObject(output);
         GA_destroy_json(output);
@@ -1,4 +1,5 @@
 #include "account.h"
+#include "gdkrecorder.h"
 #include "handler.h"
 #include "jadedevice.h"
 #include "jadeapi.h"
@@ -22,7 +23,7 @@ class GetReceiveAddressHandler : public Handler
             { "subaccount", static_cast<qint64>(m_account->pointer()) },
         });
 
-        int err = GA_get_receive_address(session, address_details.get(), auth_handler);
+        int err = GDK_CALL(GA_get_receive_address, session, address_details.get(), auth_handler);
         Q_ASSERT(err == GA_OK);
     }
 public:
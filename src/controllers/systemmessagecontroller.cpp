@@ -1,4 +1,5 @@
 #include "systemmessagecontroller.h"
+#include "gdkrecorder.h"
 #include "resolver.h"
 #include "resolvers/signmessageresolver.h"
 #include "handler.h"
@@ -10,7 +11,7 @@ class AckSystemMessageHandler : public Handler
     QByteArray m_message;
     void call(GA_session* session, GA_auth_handler** auth_handler) override
     {
-        int res = GA_ack_system_message(session, m_message.constData(), auth_handler);
+        int res = GDK_CALL(GA_ack_system_message, session, m_message.constData(), auth_handler);
         Q_ASSERT(res == GA_OK);
     }
 public:
@@ -47,7 +48,7 @@ void SystemMessageController::check()
     if (m_accepted.size() < m_pending.size()) return;
 
     char* raw;
-    int res = GA_get_system_message(session(), &raw);
+    int res = GDK_CALL(GA_get_system_message, session(), &raw);
     if (res != GA_OK) return;
     QString text = QString::fromLocal8Bit(raw);
     GA_destroy_string(raw);
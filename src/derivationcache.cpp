@@ -0,0 +1,125 @@
+#include "derivationcache.h"
+#include "util.h"
+
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStringList>
+
+#include <wally_bip32.h>
+#include <wally_core.h>
+
+namespace {
+
+bool IsHardened(uint32_t index)
+{
+    return index & BIP32_INITIAL_HARDENED_CHILD;
+}
+
+QString PathToString(const QVector<uint32_t>& path)
+{
+    QStringList parts;
+    for (const auto index : path) parts.append(QString::number(index));
+    return parts.join('/');
+}
+
+QVector<uint32_t> PathFromString(const QString& string)
+{
+    QVector<uint32_t> path;
+    for (const auto& part : string.split('/', Qt::SkipEmptyParts)) path.append(part.toUInt());
+    return path;
+}
+
+QString CacheFile(const QByteArray& master_public_key)
+{
+    return GetDataFile("xpubs", Sha256(QString::fromLocal8Bit(master_public_key)));
+}
+
+QByteArray Derive(const QByteArray& public_key, const QVector<uint32_t>& path)
+{
+    ext_key parent, child;
+    if (bip32_key_from_base58(public_key.constData(), &parent) != WALLY_OK) return {};
+    if (bip32_key_from_parent_path(&parent, path.constData(), path.size(), BIP32_FLAG_KEY_PUBLIC, &child) != WALLY_OK) return {};
+    char* base58;
+    if (bip32_key_to_base58(&child, BIP32_FLAG_KEY_PUBLIC, &base58) != WALLY_OK) return {};
+    const QByteArray result(base58);
+    wally_free_string(base58);
+    return result;
+}
+
+} // namespace
+
+DerivationCache* DerivationCache::instance()
+{
+    static DerivationCache cache;
+    return &cache;
+}
+
+QByteArray DerivationCache::get(const QByteArray& master_public_key, const QVector<uint32_t>& path)
+{
+    auto& cache = load(master_public_key);
+
+    const auto public_key = cache.value(path);
+    if (!public_key.isEmpty()) return public_key;
+
+    // find the longest cached prefix which leaves only non-hardened indexes to derive
+    for (int size = path.size() - 1; size >= 0; --size) {
+        if (IsHardened(path.at(size))) break;
+        const auto parent = cache.value(path.mid(0, size));
+        if (parent.isEmpty()) continue;
+        const auto public_key = Derive(parent, path.mid(size));
+        if (public_key.isEmpty()) break;
+        cache.insert(path, public_key);
+        return public_key;
+    }
+
+    return {};
+}
+
+void DerivationCache::insert(const QByteArray& master_public_key, const QVector<uint32_t>& path, const QByteArray& public_key)
+{
+    Q_ASSERT(!public_key.isEmpty());
+    auto& cache = load(master_public_key);
+    if (cache.value(path) == public_key) return;
+    cache.insert(path, public_key);
+    // only keys which can't be derived locally are worth persisting
+    if (path.isEmpty() || IsHardened(path.last())) save(master_public_key);
+}
+
+QMap<QVector<uint32_t>, QByteArray>& DerivationCache::load(const QByteArray& master_public_key)
+{
+    auto it = m_cache.find(master_public_key);
+    if (it != m_cache.end()) return it.value();
+
+    auto& cache = m_cache[master_public_key];
+    QFile file(CacheFile(master_public_key));
+    if (file.open(QFile::ReadOnly)) {
+        const auto data = QJsonDocument::fromJson(file.readAll()).object();
+        // discard the file if it doesn't belong to the given master key
+        if (data.value("master_xpub").toString().toLocal8Bit() == master_public_key) {
+            const auto xpubs = data.value("xpubs").toObject();
+            for (auto i = xpubs.begin(); i != xpubs.end(); ++i) {
+                cache.insert(PathFromString(i.key()), i.value().toString().toLocal8Bit());
+            }
+        }
+    }
+    return cache;
+}
+
+void DerivationCache::save(const QByteArray& master_public_key)
+{
+    QJsonObject xpubs;
+    const auto& cache = m_cache[master_public_key];
+    for (auto i = cache.begin(); i != cache.end(); ++i) {
+        if (!i.key().isEmpty() && !IsHardened(i.key().last())) continue;
+        xpubs.insert(PathToString(i.key()), QString::fromLocal8Bit(i.value()));
+    }
+    const QJsonObject data{
+        { "master_xpub", QString::fromLocal8Bit(master_public_key) },
+        { "xpubs", xpubs }
+    };
+    QFile file(CacheFile(master_public_key));
+    if (file.open(QFile::WriteOnly | QFile::Truncate)) {
+        file.write(QJsonDocument(data).toJson(QJsonDocument::Compact));
+    }
+}
@@ -0,0 +1,25 @@
+#ifndef GREEN_DERIVATIONCACHE_H
+#define GREEN_DERIVATIONCACHE_H
+
+#include <QByteArray>
+#include <QMap>
+#include <QVector>
+
+// Caches extended public keys returned by hardware devices, keyed by the
+// device master xpub. Requests with a non-hardened suffix are derived locally
+// from the nearest cached parent, and hardened entries are persisted so that
+// subsequent logins don't need to ask the device again.
+class DerivationCache
+{
+public:
+    static DerivationCache* instance();
+    QByteArray get(const QByteArray& master_public_key, const QVector<uint32_t>& path);
+    void insert(const QByteArray& master_public_key, const QVector<uint32_t>& path, const QByteArray& public_key);
+private:
+    DerivationCache() = default;
+    QMap<QVector<uint32_t>, QByteArray>& load(const QByteArray& master_public_key);
+    void save(const QByteArray& master_public_key);
+    QMap<QByteArray, QMap<QVector<uint32_t>, QByteArray>> m_cache;
+};
+
+#endif // GREEN_DERIVATIONCACHE_H
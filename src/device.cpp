@@ -1,4 +1,6 @@
+#include "activitymanager.h"
 #include "command.h"
+#include "derivationcache.h"
 #include "device.h"
 #include "device_p.h"
 #include "ga.h"
@@ -6,6 +8,7 @@
 #include "json.h"
 #include "network.h"
 #include "networkmanager.h"
+#include "trace.h"
 #include "util.h"
 #include "wallet.h"
 #include "walletmanager.h"
@@ -15,6 +18,8 @@
 #include <wally_bip32.h>
 #include <wally_elements.h>
 
+#include <utility>
+
 QByteArray pathToData(const QVector<uint32_t>& path)
 {
     Q_ASSERT(path.size() <= 10);
@@ -26,83 +31,54 @@ QByteArray pathToData(const QVector<uint32_t>& path)
     return data;
 }
 
-class GetWalletPublickKeyDispatcher
+DeviceActivity::DeviceActivity(Device* device, Priority priority)
+    : Activity(device)
+    , m_device(device)
+    , m_priority(priority)
 {
-    QMap<QByteArray, QMap<QVector<uint32_t>, QByteArray>> m_cache;
-    QQueue<GetWalletPublicKeyActivity*> m_queue;
-    GetWalletPublicKeyActivity* m_activity{nullptr};
-
-public:
-    void enqueue(GetWalletPublicKeyActivity* activity)
-    {
-        m_queue.enqueue(activity);
-        next();
-    }
-
-    void next()
-    {
-        if (m_activity) return;
-        if (m_queue.isEmpty()) return;
-
-        m_activity = m_queue.dequeue();
-        auto device = m_activity->device();
-        auto master_public_key = device->masterPublicKey(m_activity->network());
-        auto path = m_activity->path();
-
-        if (!master_public_key.isEmpty()) {
-            if (m_cache.contains(master_public_key)) {
-                const auto& public_key = m_cache[master_public_key][path];
-                if (!public_key.isEmpty()) {
-                    m_activity->setPublicKey(public_key);
-                    m_activity->finish();
-                    m_activity = nullptr;
-                    next();
-                    return;
-                }
-            }
-        }
+}
 
-        QObject::connect(m_activity, &Activity::finished, [=]{
-            auto device = m_activity->device();
-            auto master_public_key = device->masterPublicKey(m_activity->network());
-            auto path = m_activity->path();
-            auto publick_key = m_activity->publicKey();
-
-            if (master_public_key.isEmpty() && path.isEmpty()) {
-                master_public_key = publick_key;
-                device->setMasterPublicKey(m_activity->network(), publick_key);
-            }
-            if (!master_public_key.isEmpty()) {
-                m_cache[master_public_key][path] = publick_key;
-            }
-            m_activity = nullptr;
-            next();
-        });
-        QObject::connect(m_activity, &Activity::failed, [=]{
-            m_activity = nullptr;
-            next();
-        });
-        m_activity->fetch();
-    }
-};
+void DeviceActivity::setPriority(Priority priority)
+{
+    m_priority = priority;
+}
 
-static GetWalletPublickKeyDispatcher g_dispatcher;
+void DeviceActivity::exec()
+{
+    m_device->schedule(this);
+}
 
 GetWalletPublicKeyActivity::GetWalletPublicKeyActivity(Network* network, const QVector<uint32_t>& path, Device* device)
-    : Activity(device)
-    , m_device(device)
+    : DeviceActivity(device)
     , m_network(network)
     , m_path(path)
-{}
+{
+    // connected here so that the cache is updated before any other listener runs
+    connect(this, &Activity::finished, this, [this] {
+        auto master_public_key = m_device->masterPublicKey(m_network);
+        if (master_public_key.isEmpty() && m_path.isEmpty()) {
+            master_public_key = m_public_key;
+            m_device->setMasterPublicKey(m_network, m_public_key);
+        }
+        if (!master_public_key.isEmpty()) {
+            DerivationCache::instance()->insert(master_public_key, m_path, m_public_key);
+        }
+    });
+}
 
 void GetWalletPublicKeyActivity::setPublicKey(const QByteArray &public_key)
 {
     m_public_key = public_key;
 }
 
-void GetWalletPublicKeyActivity::exec()
+void GetWalletPublicKeyActivity::run()
 {
-    g_dispatcher.enqueue(this);
+    const auto master_public_key = m_device->masterPublicKey(m_network);
+    if (!master_public_key.isEmpty()) {
+        m_public_key = DerivationCache::instance()->get(master_public_key, m_path);
+        if (!m_public_key.isEmpty()) return finish();
+    }
+    fetch();
 }
 
 Device::Device(QObject* parent)
@@ -134,6 +110,59 @@ void Device::setMasterPublicKey(Network* network, const QByteArray& master_publi
     Q_ASSERT(network);
     Q_ASSERT(!m_master_public_key.contains(network));
     m_master_public_key[network] = master_public_key;
+    emit masterPublicKeyChanged(network, master_public_key);
+}
+
+void Device::schedule(DeviceActivity* activity)
+{
+    Q_ASSERT(activity->device() == this);
+    Q_ASSERT(!m_queue.contains(activity));
+
+    // keep the queue sorted by priority, preserving order within the same priority
+    int index = 0;
+    while (index < m_queue.size() && m_queue.at(index)->priority() >= activity->priority()) ++index;
+    m_queue.insert(index, activity);
+
+    connect(activity, &QObject::destroyed, this, [this, activity] {
+        if (m_queue.removeOne(activity)) emit queueDepthChanged(m_queue.size());
+        done(activity);
+    });
+
+    emit queueDepthChanged(m_queue.size());
+    dispatch();
+}
+
+void Device::dispatch()
+{
+    if (m_running) return;
+    if (m_queue.isEmpty()) return;
+
+    m_running = m_queue.takeFirst();
+    emit queueDepthChanged(m_queue.size());
+
+    auto activity = m_running;
+    connect(activity, &Activity::finished, this, [this, activity] { done(activity); });
+    connect(activity, &Activity::failed, this, [this, activity] { done(activity); });
+
+    m_busy_timer.start();
+    if (Trace::enabled()) {
+        Trace::begin("device", "busy", Trace::id(activity), {{ "activity", activity->type() }, { "device", m_uuid }, { "queue_depth", m_queue.size() }});
+    }
+    activity->run();
+}
+
+void Device::done(DeviceActivity* activity)
+{
+    if (m_running != activity) return;
+    m_running = nullptr;
+
+    const auto elapsed = m_busy_timer.elapsed();
+    m_busy_time += elapsed;
+    // the activity can be under destruction, don't touch it
+    if (Trace::enabled()) Trace::end("device", "busy", Trace::id(activity));
+    emit busyTimeChanged(m_busy_time);
+
+    dispatch();
 }
 
 bool DeviceCommand::readAPDUResponse(Device*, int length, QDataStream &stream)
@@ -168,6 +197,73 @@ Command::~Command()
 
 }
 
+#define COMMAND_PIPELINE_DEPTH 4
+
+void CommandBatch::exec()
+{
+    m_timer.start();
+    if (!objectName().isEmpty() && Trace::enabled()) Trace::begin("command batch", objectName(), Trace::id(this));
+    next();
+}
+
+void CommandBatch::discard()
+{
+    m_failed = true;
+    for (auto command : std::exchange(m_pending, {})) command->discard();
+}
+
+void CommandBatch::record(bool failed)
+{
+    if (objectName().isEmpty()) return;
+    const qint64 duration = m_timer.nsecsElapsed() / 1000;
+    const auto outcome = failed ? ActivityManager::Outcome::Failed : ActivityManager::Outcome::Finished;
+    ActivityManager::instance()->record("command batch", objectName(), duration, outcome);
+    if (Trace::enabled()) Trace::end("command batch", objectName(), Trace::id(this), {{ "commands", m_count }, { "failed", failed }});
+}
+
+void CommandBatch::next()
+{
+    // completions can arrive while commands are being started, loop instead
+    // of recursing
+    if (m_running) {
+        m_again = true;
+        return;
+    }
+    m_running = true;
+    do {
+        m_again = false;
+        if (m_failed) break;
+        if (m_pending.isEmpty() && m_commands.isEmpty()) {
+            record(false);
+            emit finished();
+            break;
+        }
+        while (!m_commands.isEmpty() && m_pending.size() < COMMAND_PIPELINE_DEPTH) {
+            auto command = m_commands.first();
+            const bool pipeline = dynamic_cast<DeviceCommand*>(command);
+            if (!m_pending.isEmpty() && !pipeline) break;
+            m_commands.removeFirst();
+            m_pending.append(command);
+            ++m_count;
+            connect(command, &Command::finished, this, [this, command] {
+                m_pending.removeOne(command);
+                next();
+            });
+            connect(command, &Command::error, this, [this, command] {
+                if (m_failed) return;
+                m_pending.removeOne(command);
+                // don't let the device process the commands issued after it
+                discard();
+                record(true);
+                emit error();
+            });
+            command->exec();
+            if (!pipeline || m_failed) break;
+        }
+    } while (m_again);
+    m_running = false;
+}
+
 bool DeviceCommand::parse(const QByteArray& data)
 {
     QDataStream stream(data);
@@ -2,6 +2,7 @@
 #define GREEN_DEVICE_H
 
 #include <QtQml>
+#include <QElapsedTimer>
 #include <QObject>
 
 #include "activity.h"
@@ -14,58 +15,83 @@ QT_FORWARD_DECLARE_CLASS(Device);
 QT_FORWARD_DECLARE_CLASS(DeviceCommand);
 QT_FORWARD_DECLARE_CLASS(Network);
 
-class GetWalletPublicKeyActivity : public Activity
+// Base class for activities that talk to a device. Instead of running right
+// away, these are queued in the target device and executed one at a time,
+// higher priorities first, so that user facing requests don't wait behind
+// background work.
+class DeviceActivity : public Activity
 {
 public:
-    GetWalletPublicKeyActivity(Network* network, const QVector<uint32_t>& path, Device* device);
+    enum class Priority {
+        Background,
+        Normal,
+        Interactive,
+    };
+    DeviceActivity(Device* device, Priority priority = Priority::Normal);
     Device* device() const { return m_device; }
+    Priority priority() const { return m_priority; }
+    void setPriority(Priority priority);
+private:
+    void exec() override;
+    virtual void run() = 0;
+protected:
+    Device* const m_device;
+private:
+    Priority m_priority;
+    friend class Device;
+};
+
+class GetWalletPublicKeyActivity : public DeviceActivity
+{
+public:
+    GetWalletPublicKeyActivity(Network* network, const QVector<uint32_t>& path, Device* device);
     Network* network() const { return m_network; }
     QVector<uint32_t> path() const { return m_path; }
     QByteArray publicKey() const { return m_public_key; }
     void setPublicKey(const QByteArray& public_key);
-    void exec() override;
     virtual void fetch() = 0;
+private:
+    void run() override;
 protected:
-    Device* const m_device;
     Network* const m_network;
     const QVector<uint32_t> m_path;
     QByteArray m_public_key;
 };
 
-class SignMessageActivity : public Activity
+class SignMessageActivity : public DeviceActivity
 {
 public:
-    SignMessageActivity(QObject* parent) : Activity(parent) {}
+    SignMessageActivity(Device* device) : DeviceActivity(device, Priority::Interactive) {}
     virtual QByteArray signature() const = 0;
     virtual QByteArray signerCommitment() const { return {}; }
 };
 
-class SignTransactionActivity : public Activity
+class SignTransactionActivity : public DeviceActivity
 {
 public:
-    SignTransactionActivity(QObject* parent) : Activity(parent) {}
+    SignTransactionActivity(Device* device) : DeviceActivity(device, Priority::Interactive) {}
     virtual QList<QByteArray> signatures() const = 0;
     virtual QList<QByteArray> signerCommitments() const = 0;
 };
 
-class GetBlindingKeyActivity : public Activity
+class GetBlindingKeyActivity : public DeviceActivity
 {
 public:
-    GetBlindingKeyActivity(QObject* parent) : Activity(parent) {}
+    GetBlindingKeyActivity(Device* device) : DeviceActivity(device) {}
     virtual QByteArray publicKey() const = 0;
 };
 
-class GetBlindingNonceActivity : public Activity
+class GetBlindingNonceActivity : public DeviceActivity
 {
 public:
-    GetBlindingNonceActivity(QObject* parent) : Activity(parent) {}
+    GetBlindingNonceActivity(Device* device) : DeviceActivity(device) {}
     virtual QByteArray nonce() const = 0;
 };
 
-class SignLiquidTransactionActivity : public Activity
+class SignLiquidTransactionActivity : public DeviceActivity
 {
 public:
-    SignLiquidTransactionActivity(QObject* parent) : Activity(parent) {}
+    SignLiquidTransactionActivity(Device* device) : DeviceActivity(device, Priority::Interactive) {}
     virtual QList<QByteArray> signatures() const = 0;
     virtual QList<QByteArray> signerCommitments() const = 0;
     virtual QList<QByteArray> assetCommitments() const = 0;
@@ -74,10 +100,10 @@ public:
     virtual QList<QByteArray> amountBlinders() const = 0;
 };
 
-class GetMasterBlindingKeyActivity : public Activity
+class GetMasterBlindingKeyActivity : public DeviceActivity
 {
 public:
-    GetMasterBlindingKeyActivity(QObject* parent) : Activity(parent) {}
+    GetMasterBlindingKeyActivity(Device* device) : DeviceActivity(device) {}
     virtual QByteArray masterBlindingKey() const = 0;
 };
 
@@ -90,6 +116,8 @@ class Device : public QObject
     Q_PROPERTY(Type type READ type CONSTANT)
     Q_PROPERTY(QString name READ name NOTIFY nameChanged)
     Q_PROPERTY(QJsonObject details READ details NOTIFY detailsChanged)
+    Q_PROPERTY(int queueDepth READ queueDepth NOTIFY queueDepthChanged)
+    Q_PROPERTY(qint64 busyTime READ busyTime NOTIFY busyTimeChanged)
     QML_ELEMENT
     QML_UNCREATABLE("Devices are instanced by DeviceDiscoveryAgent.")
 public:
@@ -129,12 +157,27 @@ public:
     static Type typefromVendorAndProduct(uint32_t vendor_id, uint32_t product_id);
     QByteArray masterPublicKey(Network* network) const;
     void setMasterPublicKey(Network* network, const QByteArray& master_public_key);
+    int queueDepth() const { return m_queue.size(); }
+    qint64 busyTime() const { return m_busy_time; }
+    bool isBusy() const { return m_running || !m_queue.isEmpty(); }
 signals:
     void nameChanged();
     void detailsChanged();
+    void queueDepthChanged(int queue_depth);
+    void busyTimeChanged(qint64 busy_time);
+    void masterPublicKeyChanged(Network* network, const QByteArray& master_public_key);
+private:
+    void schedule(DeviceActivity* activity);
+    void dispatch();
+    void done(DeviceActivity* activity);
 private:
     const QString m_uuid;
     QMap<Network*, QByteArray> m_master_public_key;
+    QList<DeviceActivity*> m_queue;
+    DeviceActivity* m_running{nullptr};
+    QElapsedTimer m_busy_timer;
+    qint64 m_busy_time{0};
+    friend class DeviceActivity;
 };
 
 QT_FORWARD_DECLARE_CLASS(LedgerDevice);
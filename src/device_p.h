@@ -8,6 +8,13 @@ class DevicePrivate
 public:
     virtual ~DevicePrivate() {};
     virtual void exchange(DeviceCommand* command) = 0;
+    // drops a queued command before it is written, the head of the queue
+    // was written already
+    virtual void discard(DeviceCommand* command)
+    {
+        const int index = queue.indexOf(command);
+        if (index > 0) queue.removeAt(index);
+    }
     static DevicePrivate* get(LedgerDevice* device);
     LedgerDevice* q{nullptr};
     Device::Transport m_transport;
@@ -4,11 +4,23 @@
 #include "devicediscoveryagent_linux.h"
 #include "devicediscoveryagent_win.h"
 #include "devicemanager.h"
+#ifdef GREEN_MOCK_GDK
+#include "ledgeremulator.h"
+#endif
+
+#include <QCommandLineParser>
+
+extern QCommandLineParser g_args;
 
 DeviceDiscoveryAgent::DeviceDiscoveryAgent(QObject *parent)
     : QObject(parent)
     , d(new DeviceDiscoveryAgentPrivate(this))
 {
+#ifdef GREEN_MOCK_GDK
+    if (g_args.isSet("ledgeremulator")) {
+        DeviceManager::instance()->addDevice(LedgerEmulatorPrivate::create(this));
+    }
+#endif
 }
 
 DeviceDiscoveryAgent::~DeviceDiscoveryAgent()
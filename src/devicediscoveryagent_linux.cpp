@@ -14,8 +14,15 @@
 #include <linux/hid.h>
 #include <linux/types.h>
 #include <linux/hidraw.h>
+#include <poll.h>
+#include <sys/eventfd.h>
 #include <unistd.h>
 
+#include <utility>
+
+#define CHANNEL_DEFAULT_ID 0x0101
+#define TAG_APDU 0x05
+
 DeviceDiscoveryAgentPrivate::DeviceDiscoveryAgentPrivate(DeviceDiscoveryAgent *q)
     : q(q)
 {
@@ -140,19 +147,12 @@ void DeviceDiscoveryAgentPrivate::addDevice(udev_device* handle)
     impl->handle = handle;
     impl->fd = fd;
     impl->m_type = device_type;
+    // listeners of deviceAdded can exchange commands right away
+    impl->start();
     auto device = new LedgerDevice(impl);
 
     m_devices.insert(devpath, impl);
     DeviceManager::instance()->addDevice(device);
-
-    auto notifier = new QSocketNotifier(fd, QSocketNotifier::Read);
-    notifier->setEnabled(true);
-    QObject::connect(notifier, &QSocketNotifier::activated, [impl, fd, notifier] {
-        char b[64];
-        auto x = read(fd, (void*) b, 64);
-        if (x == 64) impl->inputReport(QByteArray::fromRawData(b, 64));
-        else notifier->deleteLater();
-    });
     // udev_device_unref(handle);
 }
 
@@ -166,70 +166,237 @@ void DeviceDiscoveryAgentPrivate::removeDevice(udev_device* handle)
     delete impl->q;
 }
 
-QList<QByteArray> transport(const QByteArray& data) {
-    QList<QByteArray> packets;
-    int offset = 0;
-    //qDebug() << "wrapping" << data.toHex();
-    while (offset < data.size()) {
-        QByteArray result;
-        auto d = data.mid(offset, 64 - (packets.empty() ? 7 : 5));
-        offset += d.size();
-        QDataStream stream(&result, QIODevice::WriteOnly);
-        stream << uint16_t(0x0101) << uint8_t(0x05) << uint16_t(packets.size());
-        if (packets.empty()) stream << uint16_t(data.length());
-        result.append(d);
-        //qDebug() << "  packet " << result.toHex() << result.size();
-        Q_ASSERT(result.length() <= 64);
-        result = result.leftJustified(64, 0x0);
-        packets.append(result);
+HidrawIOThread::HidrawIOThread(int fd)
+    : m_fd(fd)
+{
+    m_wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    m_notify_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    Q_ASSERT(m_wake_fd >= 0 && m_notify_fd >= 0);
+    m_response.reserve(1024);
+}
+
+HidrawIOThread::~HidrawIOThread()
+{
+    stop();
+    close(m_wake_fd);
+    close(m_notify_fd);
+}
+
+void HidrawIOThread::signal(int fd)
+{
+    const uint64_t value = 1;
+    auto res = ::write(fd, &value, sizeof(value));
+    Q_UNUSED(res);
+}
+
+bool HidrawIOThread::send(const HidrawMessage& request)
+{
+    if (!m_requests.push(request)) return false;
+    signal(m_wake_fd);
+    return true;
+}
+
+bool HidrawIOThread::receive(HidrawMessage& response)
+{
+    return m_responses.pop(response);
+}
+
+void HidrawIOThread::stop()
+{
+    m_stop = true;
+    signal(m_wake_fd);
+    wait();
+}
+
+void HidrawIOThread::run()
+{
+    pollfd fds[2] = {{m_fd, POLLIN, 0}, {m_wake_fd, POLLIN, 0}};
+    // any break out of the loop other than stop() means the device failed
+    while (!m_stop) {
+        if (m_pending && m_responses.push({ m_id, m_response })) {
+            m_response.clear();
+            m_pending = false;
+            m_busy = false;
+            signal(m_notify_fd);
+        }
+        if (!m_busy && !writeNext()) break;
+        // while the GUI thread hasn't drained the responses, retry shortly
+        if (poll(fds, 2, m_pending ? 10 : -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (fds[1].revents & POLLIN) {
+            uint64_t value;
+            auto res = ::read(m_wake_fd, &value, sizeof(value));
+            Q_UNUSED(res);
+        }
+        if (fds[0].revents & (POLLERR | POLLHUP | POLLNVAL)) break;
+        if (fds[0].revents & POLLIN) {
+            if (::read(m_fd, m_input, sizeof(m_input)) != sizeof(m_input)) break;
+            if (!m_busy || m_pending) {
+                qDebug() << "READ UNKNOWN REPORT" << QByteArray::fromRawData((const char*) m_input, sizeof(m_input)).toHex();
+                continue;
+            }
+            m_pending = read();
+        }
+    }
+    if (!m_stop) {
+        qWarning("hidraw: device i/o failed");
+        m_failed = true;
+        signal(m_notify_fd);
     }
-    return packets;
 }
 
-void DevicePrivateImpl::exchange(DeviceCommand* command)
+bool HidrawIOThread::writeNext()
 {
-    const bool send = queue.empty();
-    if (send) {
-        const auto payload = command->payload();
-        for (const auto& packet : transport(payload)) {
-            QByteArray report;
-            report.append(uint8_t(0));
-            report.append(packet);
-            int res = write(fd, report.constData(), report.size());
-            Q_ASSERT(res == report.size());
+    HidrawMessage request;
+    while (m_requests.pop(request)) {
+        quint32 id;
+        while (m_discards.pop(id)) m_discarded.insert(id);
+        // requests come in id order, older discards were written already
+        m_discarded.erase(m_discarded.begin(), m_discarded.lower_bound(request.id));
+        if (m_discarded.erase(request.id) > 0) continue;
+        m_id = request.id;
+        m_busy = true;
+        return write(request.data);
+    }
+    return true;
+}
+
+bool HidrawIOThread::write(const QByteArray& apdu)
+{
+    // report id followed by the 64 byte packet
+    const auto data = reinterpret_cast<const uint8_t*>(apdu.constData());
+    const int length = apdu.size();
+    int offset = 0;
+    uint16_t index = 0;
+    do {
+        memset(m_output, 0, sizeof(m_output));
+        uint8_t* p = m_output + 1;
+        *p++ = CHANNEL_DEFAULT_ID >> 8;
+        *p++ = CHANNEL_DEFAULT_ID & 0xff;
+        *p++ = TAG_APDU;
+        *p++ = index >> 8;
+        *p++ = index & 0xff;
+        if (index == 0) {
+            *p++ = length >> 8;
+            *p++ = length & 0xff;
         }
+        const int chunk = qMin(int(m_output + sizeof(m_output) - p), length - offset);
+        memcpy(p, data + offset, chunk);
+        offset += chunk;
+        ++index;
+        if (::write(m_fd, m_output, sizeof(m_output)) != sizeof(m_output)) return false;
+    } while (offset < length);
+    return true;
+}
+
+bool HidrawIOThread::read()
+{
+    const uint8_t* p = m_input;
+    const uint16_t channel_id = (p[0] << 8) | p[1];
+    const uint8_t command_tag = p[2];
+    const uint16_t index = (p[3] << 8) | p[4];
+    p += 5;
+    if (channel_id != CHANNEL_DEFAULT_ID || command_tag != TAG_APDU) {
+        qDebug() << "hidraw: unexpected report" << channel_id << command_tag;
+        return false;
+    }
+    if (index == 0) {
+        m_expected = (p[0] << 8) | p[1];
+        p += 2;
+        m_response.clear();
     }
-    queue.enqueue(command);
+    const int chunk = qMin(int(m_input + sizeof(m_input) - p), m_expected - m_response.size());
+    m_response.append(reinterpret_cast<const char*>(p), chunk);
+    return m_response.size() == m_expected;
+}
+
+DevicePrivateImpl::~DevicePrivateImpl()
+{
+    delete notifier;
+    delete io;
+    close(fd);
 }
 
-void DevicePrivateImpl::inputReport(const QByteArray& data)
+void DevicePrivateImpl::start()
 {
-    if (queue.empty()) {
-        qDebug() << "READ UNKNOWN REPORT" << data.toHex();
+    io = new HidrawIOThread(fd);
+    notifier = new QSocketNotifier(io->notifyFd(), QSocketNotifier::Read);
+    notifier->setEnabled(true);
+    QObject::connect(notifier, &QSocketNotifier::activated, [this](int notify_fd) {
+        uint64_t value;
+        auto res = read(notify_fd, &value, sizeof(value));
+        Q_UNUSED(res);
+        HidrawMessage message;
+        while (io->receive(message)) response(message);
+        if (io->hasFailed()) fail();
+    });
+    io->start();
+}
+
+void DevicePrivateImpl::exchange(DeviceCommand* command)
+{
+    if (io->hasFailed()) {
+        // callers connect to the command after exchanging it
+        QMetaObject::invokeMethod(command, [command] { emit command->error(); }, Qt::QueuedConnection);
         return;
     }
-    Q_ASSERT(!queue.empty());
-    QDataStream stream(data);
-    auto command = queue.head();
-    int r = command->readHIDReport(q, stream);
-    if (r == 2) return;
-    if (r == 1) qWarning("command failed");
-    queue.dequeue();
-    if (!queue.empty()) {
-        command = queue.head();
-        const auto payload = command->payload();
-        for (const auto& packet : transport(payload)) {
-            QByteArray report;
-            report.append(uint8_t(0));
-            report.append(packet);
-            int res = write(fd, report.constData(), report.size());
-            if (res < 0) {
-                qDebug() << "FAILED";
-                delete command;
+    const auto id = next_id++;
+    commands.insert(id, command);
+    backlog.enqueue({ id, command->payload() });
+    flush();
+}
+
+void DevicePrivateImpl::discard(DeviceCommand* command)
+{
+    for (auto i = commands.begin(); i != commands.end(); ++i) {
+        if (i.value() != command) continue;
+        const auto id = i.key();
+        commands.erase(i);
+        for (int j = 0; j < backlog.size(); ++j) {
+            if (backlog.at(j).id == id) {
+                backlog.removeAt(j);
                 return;
             }
         }
+        // if it was written, or the thread can't be told, its response is
+        // dropped when it arrives
+        io->discard(id);
+        return;
+    }
+}
+
+void DevicePrivateImpl::flush()
+{
+    while (!backlog.empty() && io->send(backlog.head())) {
+        backlog.dequeue();
+    }
+}
+
+void DevicePrivateImpl::response(const HidrawMessage& message)
+{
+    flush();
+    auto command = commands.take(message.id);
+    if (!command) {
+        qDebug() << "hidraw: dropped response of discarded command" << message.data.toHex();
+        return;
+    }
+    const auto& data = message.data;
+    if (data.size() < 2) {
+        qWarning("command failed");
+        emit command->error();
+        return;
     }
+    QDataStream stream(data);
+    if (!command->readAPDUResponse(q, data.size(), stream)) qWarning("command failed");
+}
+
+void DevicePrivateImpl::fail()
+{
+    backlog.clear();
+    const auto failed = std::exchange(commands, {});
+    for (auto command : failed) emit command->error();
 }
 
 #endif // Q_OS_LINUX
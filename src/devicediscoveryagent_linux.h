@@ -5,19 +5,86 @@
 
 #ifdef Q_OS_LINUX
 #include "device_p.h"
+#include "ringbuffer.h"
 
 #include <QSocketNotifier>
+#include <QThread>
 #include <libudev.h>
 
+#include <atomic>
+#include <set>
+
 class DeviceDiscoveryAgent;
 
+// an APDU or its response, tagged with the id of the request
+struct HidrawMessage {
+    quint32 id{0};
+    QByteArray data;
+};
+
+// Owns the hidraw file descriptor. APDUs are framed into 64 byte reports and
+// written from this thread, responses are reassembled here and handed back
+// to the GUI thread through a lock-free queue. The next queued APDU is written
+// as soon as the previous response completes, without a GUI round trip.
+// When writing or reading fails the thread exits and signals the GUI thread,
+// which then fails the pending commands. Discarded requests are skipped if
+// they weren't written yet.
+class HidrawIOThread : public QThread
+{
+public:
+    HidrawIOThread(int fd);
+    ~HidrawIOThread();
+    bool send(const HidrawMessage& request);
+    bool receive(HidrawMessage& response);
+    bool discard(quint32 id) { return m_discards.push(id); }
+    int notifyFd() const { return m_notify_fd; }
+    bool hasFailed() const { return m_failed; }
+    void stop();
+protected:
+    void run() override;
+private:
+    bool writeNext();
+    bool write(const QByteArray& apdu);
+    bool read();
+    static void signal(int fd);
+    const int m_fd;
+    int m_wake_fd{-1};
+    int m_notify_fd{-1};
+    std::atomic<bool> m_stop{false};
+    std::atomic<bool> m_failed{false};
+    RingBuffer<HidrawMessage, 64> m_requests;
+    RingBuffer<HidrawMessage, 64> m_responses;
+    RingBuffer<quint32, 64> m_discards;
+    std::set<quint32> m_discarded;
+    quint32 m_id{0};
+    uint8_t m_output[65];
+    uint8_t m_input[64];
+    QByteArray m_response;
+    int m_expected{0};
+    bool m_busy{false};
+    bool m_pending{false};
+};
+
 class DevicePrivateImpl : public DevicePrivate
 {
 public:
+    ~DevicePrivateImpl();
     udev_device* handle;
     int fd;
+    HidrawIOThread* io{nullptr};
+    QSocketNotifier* notifier{nullptr};
+    QQueue<HidrawMessage> backlog;
+    // commands waiting for a response, by request id
+    QMap<quint32, DeviceCommand*> commands;
+    quint32 next_id{0};
+    // starts the I/O thread, before the device is published
+    void start();
     void exchange(DeviceCommand* command) override;
-    void inputReport(const QByteArray& data);
+    void discard(DeviceCommand* command) override;
+    void flush();
+    void response(const HidrawMessage& message);
+    // fails the pending commands once the I/O thread gave up
+    void fail();
 };
 
 class DeviceDiscoveryAgentPrivate
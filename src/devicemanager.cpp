@@ -2,16 +2,14 @@
 #include "device.h"
 #include "networkmanager.h"
 
+#define PING_INTERVAL 5000
+#define PING_MAX_INTERVAL 60000
+
 DeviceManager::DeviceManager(QObject* parent)
     : QObject(parent)
+    , m_ping_timer(new QTimer(this))
 {
-    auto timer = new QTimer(this);
-    connect(timer, &QTimer::timeout, [this] {
-        for (auto device : m_devices) {
-            device->ping();
-        }
-    });
-    timer->start(5000);
+    connect(m_ping_timer, &QTimer::timeout, this, &DeviceManager::ping);
 }
 
 DeviceManager::~DeviceManager()
@@ -30,35 +28,47 @@ QSet<Device*> DeviceManager::devices() const
 
 Device *DeviceManager::deviceWithId(const QString& id)
 {
-    // track master xpubs by device id
-    for (auto network : NetworkManager::instance()->networks()) {
-        for (auto device : m_devices) {
-            auto xpub = device->masterPublicKey(network);
-            if (xpub.isEmpty()) continue;
-            m_xpubs[id].insert(xpub);
-        }
-    }
     // return device if still available
-    for (auto device : m_devices) {
-        if (device->uuid() == id) {
-            return device;
-        }
-    }
-    // search device for tracked xpubs
-    for (auto network : NetworkManager::instance()->networks()) {
-        for (auto device : m_devices) {
-            auto xpub = device->masterPublicKey(network);
-            if (xpub.isEmpty()) continue;
-            if (m_xpubs[id].contains(xpub)) return device;
-        }
+    auto device = m_devices_by_id.value(id);
+    if (device) return device;
+    // search device for the master xpubs tracked for the given id
+    for (const auto& xpub : m_xpubs.value(id)) {
+        device = m_devices_by_xpub.value(xpub);
+        if (device) return device;
     }
     return nullptr;
 }
 
+void DeviceManager::indexMasterPublicKey(Device* device, const QByteArray& master_public_key)
+{
+    if (master_public_key.isEmpty()) return;
+    // track master xpubs by device id
+    m_xpubs[device->uuid()].insert(master_public_key);
+    m_devices_by_xpub.insert(master_public_key, device);
+}
+
 void DeviceManager::addDevice(Device* device)
 {
     Q_ASSERT(!m_devices.contains(device));
     m_devices.insert(device);
+    m_devices_by_id.insert(device->uuid(), device);
+    for (auto network : NetworkManager::instance()->networks()) {
+        indexMasterPublicKey(device, device->masterPublicKey(network));
+    }
+    connect(device, &Device::masterPublicKeyChanged, this, [this, device](Network*, const QByteArray& master_public_key) {
+        if (m_devices.contains(device)) indexMasterPublicKey(device, master_public_key);
+    });
+    auto& schedule = m_ping_schedules[device];
+    schedule.interval = PING_INTERVAL;
+    schedule.timer.start();
+    // device traffic proves liveness, postpone the next ping
+    connect(device, &Device::busyTimeChanged, this, [this, device] {
+        if (!m_ping_schedules.contains(device)) return;
+        auto& schedule = m_ping_schedules[device];
+        schedule.interval = PING_INTERVAL;
+        schedule.timer.restart();
+    });
+    if (!m_ping_timer->isActive()) m_ping_timer->start(PING_INTERVAL);
     emit deviceAdded(device);
 }
 
@@ -66,5 +76,31 @@ void DeviceManager::removeDevice(Device* device)
 {
     if (!m_devices.contains(device)) return;
     m_devices.remove(device);
+    m_devices_by_id.remove(device->uuid());
+    for (const auto& xpub : m_xpubs.value(device->uuid())) {
+        if (m_devices_by_xpub.value(xpub) == device) m_devices_by_xpub.remove(xpub);
+    }
+    m_ping_schedules.remove(device);
+    disconnect(device, nullptr, this, nullptr);
+    if (m_devices.isEmpty()) m_ping_timer->stop();
     emit deviceRemoved(device);
 }
+
+void DeviceManager::ping()
+{
+    // Disconnection is reported by the transports, pings only refresh device
+    // state, so they are skipped while a device is in use and back off while
+    // it stays idle.
+    for (auto device : m_devices) {
+        auto& schedule = m_ping_schedules[device];
+        if (device->isBusy()) {
+            schedule.interval = PING_INTERVAL;
+            schedule.timer.restart();
+            continue;
+        }
+        if (schedule.timer.elapsed() < schedule.interval) continue;
+        device->ping();
+        schedule.timer.restart();
+        schedule.interval = qMin(schedule.interval * 2, PING_MAX_INTERVAL);
+    }
+}
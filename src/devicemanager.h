@@ -2,11 +2,13 @@
 #define GREEN_DEVICEMANAGER_H
 
 #include <QtQml>
+#include <QElapsedTimer>
 #include <QObject>
 #include <QSet>
 #include <QVector>
 
 class Device;
+QT_FORWARD_DECLARE_CLASS(QTimer)
 
 class DeviceManager : public QObject
 {
@@ -24,8 +26,18 @@ signals:
     void deviceRemoved(Device* device);
 private:
     explicit DeviceManager(QObject* parent = nullptr);
+    void ping();
+    void indexMasterPublicKey(Device* device, const QByteArray& master_public_key);
+    struct PingSchedule {
+        QElapsedTimer timer;
+        int interval;
+    };
+    QTimer* const m_ping_timer;
+    QMap<Device*, PingSchedule> m_ping_schedules;
     QSet<Device*> m_devices;
-    QMap<QString, QSet<QByteArray>> m_xpubs;
+    QHash<QString, Device*> m_devices_by_id;
+    QHash<QByteArray, Device*> m_devices_by_xpub;
+    QHash<QString, QSet<QByteArray>> m_xpubs;
 };
 
 #endif // GREEN_DEVICEMANAGER_H
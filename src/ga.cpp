@@ -1,4 +1,5 @@
 #include "ga.h"
+#include "gdkrecorder.h"
 #include "json.h"
 #include "util.h"
 #include <gdk.h>
@@ -9,18 +10,22 @@ void init(const QCommandLineParser& args)
 {
     const auto log_level = args.isSet("debug") ? QStringLiteral("debug") : qEnvironmentVariable("GREEN_GDK_LOG_LEVEL", "info");
 
-    auto config = Json::fromObject({
+    QJsonObject config{
         { "datadir", GetDataDir("gdk") },
         { "log_level", log_level }
-    });
-    GA_init(config.get());
+    };
+    if (args.isSet("gdkrecord")) GdkRecorder::open(args.value("gdkrecord"));
+#ifdef GREEN_MOCK_GDK
+    if (args.isSet("gdkreplay")) config.insert("mock_replay", args.value("gdkreplay"));
+#endif
+    GA_init(Json::fromObject(config).get());
 }
 
 QJsonObject convert_amount(GA_session* session, const QJsonObject& input)
 {
     auto value_details = Json::fromObject(input);
     GA_json* output;
-    int err = GA_convert_amount(session, value_details.get(), &output);
+    int err = GDK_CALL(GA_convert_amount, session, value_details.get(), &output);
     if (err != GA_OK) return {};
     auto value = Json::toObject(output);
     GA_destroy_json(output);
@@ -32,7 +37,7 @@ QStringList generate_mnemonic(int size)
     Q_ASSERT(size == 12 || size == 24);
 
     char* mnemonic;
-    int err = size == 12 ? GA_generate_mnemonic_12(&mnemonic) : GA_generate_mnemonic(&mnemonic);
+    int err = size == 12 ? GDK_CALL(GA_generate_mnemonic_12, &mnemonic) : GDK_CALL(GA_generate_mnemonic, &mnemonic);
     Q_ASSERT(err == GA_OK);
     auto result = QString(mnemonic).split(' ');
     GA_destroy_string(mnemonic);
@@ -42,7 +47,7 @@ QStringList generate_mnemonic(int size)
 QJsonObject get_settings(GA_session* session)
 {
     GA_json* settings;
-    int err = GA_get_settings(session, &settings);
+    int err = GDK_CALL(GA_get_settings, session, &settings);
     Q_ASSERT(err == GA_OK);
     auto result = Json::toObject(settings);
     GA_destroy_json(settings);
@@ -52,7 +57,7 @@ QJsonObject get_settings(GA_session* session)
 QJsonObject get_twofactor_config(GA_session* session)
 {
     GA_json* config;
-    int err = GA_get_twofactor_config(session, &config);
+    int err = GDK_CALL(GA_get_twofactor_config, session, &config);
     Q_ASSERT(err == GA_OK);
     auto result = Json::toObject(config);
     GA_destroy_json(config);
@@ -62,7 +67,7 @@ QJsonObject get_twofactor_config(GA_session* session)
 QJsonObject get_available_currencies(GA_session* session)
 {
     GA_json* currencies;
-    int err = GA_get_available_currencies(session, &currencies);
+    int err = GDK_CALL(GA_get_available_currencies, session, &currencies);
     Q_ASSERT(err == GA_OK);
     auto result = Json::toObject(currencies);
     GA_destroy_json(currencies);
@@ -72,7 +77,7 @@ QJsonObject get_available_currencies(GA_session* session)
 QJsonArray get_fee_estimates(GA_session* session)
 {
     GA_json* estimates;
-    int err = GA_get_fee_estimates(session, &estimates);
+    int err = GDK_CALL(GA_get_fee_estimates, session, &estimates);
     if (err != GA_OK) return {};
     const auto fees = Json::toObject(estimates).value("fees").toArray();
     GA_destroy_json(estimates);
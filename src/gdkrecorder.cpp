@@ -0,0 +1,123 @@
+#include "gdkrecorder.h"
+
+#include <QDebug>
+
+using nlohmann::json;
+
+namespace {
+
+const json& Details(const GA_json* details)
+{
+    // GA_json is a nlohmann::json, see json.cpp
+    return *reinterpret_cast<const json*>(details);
+}
+
+} // namespace
+
+GdkRecorder* GdkRecorder::s_instance{nullptr};
+
+bool GdkRecorder::open(const QString& file_name)
+{
+    Q_ASSERT(!s_instance);
+    static GdkRecorder recorder;
+    recorder.m_file.open(file_name.toStdString(), std::ios::out | std::ios::trunc);
+    if (!recorder.m_file) {
+        qWarning() << "gdk recorder: failed to open" << file_name;
+        return false;
+    }
+    qInfo() << "gdk recorder: recording to" << file_name;
+    s_instance = &recorder;
+    return true;
+}
+
+GdkRecorder::GdkRecorder()
+    : m_start(std::chrono::steady_clock::now())
+{
+}
+
+int64_t GdkRecorder::elapsed() const
+{
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now() - m_start).count();
+}
+
+int64_t GdkRecorder::id(const void* object)
+{
+    QMutexLocker locker(&m_mutex);
+    auto i = m_ids.find(object);
+    return i == m_ids.end() ? 0 : i->second;
+}
+
+int64_t GdkRecorder::assign(const void* object)
+{
+    QMutexLocker locker(&m_mutex);
+    // addresses are reused, new objects always get a new id
+    return m_ids[object] = ++m_next_id;
+}
+
+void GdkRecorder::write(const char* name, int64_t start, int64_t duration, json inputs, int rc, json outputs)
+{
+    json entry = {
+        { "t", start },
+        { "d", duration },
+        { "fn", name },
+        { "in", std::move(inputs) },
+        { "rc", rc },
+        { "out", std::move(outputs) },
+    };
+    if (rc != GA_OK) {
+        GA_json* details;
+        if (GA_get_thread_error_details(&details) == GA_OK) {
+            entry["error"] = Details(details);
+            GA_destroy_json(details);
+        }
+    }
+    QMutexLocker locker(&m_mutex);
+    entry["seq"] = ++m_seq;
+    m_file << entry.dump() << '\n';
+}
+
+void GdkRecorder::notification(GA_session* session, const GA_json* details)
+{
+    auto recorder = s_instance;
+    if (!recorder) return;
+    json entry = {
+        { "t", recorder->elapsed() },
+        { "fn", "notification" },
+        { "session", recorder->id(session) },
+        { "out", Details(details) },
+    };
+    QMutexLocker locker(&recorder->m_mutex);
+    entry["after"] = recorder->m_seq;
+    recorder->m_file << entry.dump() << '\n';
+}
+
+json GdkRecorder::input(const GA_json* json)
+{
+    return json ? Details(json) : nlohmann::json();
+}
+
+json GdkRecorder::input(const char* string)
+{
+    return string ? json(string) : json();
+}
+
+void GdkRecorder::output(json& outputs, GA_session** session)
+{
+    outputs.push_back(assign(*session));
+}
+
+void GdkRecorder::output(json& outputs, GA_auth_handler** call)
+{
+    outputs.push_back(*call ? assign(*call) : 0);
+}
+
+void GdkRecorder::output(json& outputs, GA_json** json)
+{
+    outputs.push_back(*json ? Details(*json) : nlohmann::json());
+}
+
+void GdkRecorder::output(json& outputs, char** string)
+{
+    outputs.push_back(*string ? json(*string) : json());
+}
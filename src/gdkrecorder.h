@@ -0,0 +1,81 @@
+#ifndef GREEN_GDKRECORDER_H
+#define GREEN_GDKRECORDER_H
+
+#include <gdk.h>
+#include <nlohmann/json.hpp>
+
+#include <QMutex>
+#include <QString>
+
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <type_traits>
+
+// Records every GA_* call made with GDK_CALL, with arguments, results and
+// timings, and the notifications received, to a JSON lines file. Started
+// with --gdkrecord <file>, the mock gdk build replays the file with
+// --gdkreplay, see src/mockgdk/gdktraffic.h. Calls are written in
+// completion order, notifications refer to the last completed call.
+class GdkRecorder
+{
+public:
+    // null unless recording
+    static GdkRecorder* instance() { return s_instance; }
+    static bool open(const QString& file_name);
+
+    template <typename... Params>
+    static int call(const char* name, int (*function)(Params...), std::common_type_t<Params>... args);
+    static void notification(GA_session* session, const GA_json* details);
+
+private:
+    GdkRecorder();
+    int64_t elapsed() const;
+    int64_t id(const void* object);
+    int64_t assign(const void* object);
+    void write(const char* name, int64_t start, int64_t duration, nlohmann::json inputs, int rc, nlohmann::json outputs);
+
+    nlohmann::json input(GA_session* session) { return id(session); }
+    nlohmann::json input(GA_auth_handler* call) { return id(call); }
+    nlohmann::json input(const GA_json* json);
+    nlohmann::json input(const char* string);
+    nlohmann::json input(uint32_t value) { return value; }
+    // output arguments are filled after the call
+    template <typename T>
+    nlohmann::json input(T**) { return nullptr; }
+
+    void output(nlohmann::json& outputs, GA_session** session);
+    void output(nlohmann::json& outputs, GA_auth_handler** call);
+    void output(nlohmann::json& outputs, GA_json** json);
+    void output(nlohmann::json& outputs, char** string);
+    template <typename T>
+    void output(nlohmann::json&, T) {}
+
+    static GdkRecorder* s_instance;
+    const std::chrono::steady_clock::time_point m_start;
+    QMutex m_mutex;
+    std::ofstream m_file;
+    int64_t m_seq{0};
+    int64_t m_next_id{0};
+    std::map<const void*, int64_t> m_ids;
+};
+
+template <typename... Params>
+int GdkRecorder::call(const char* name, int (*function)(Params...), std::common_type_t<Params>... args)
+{
+    auto recorder = s_instance;
+    if (!recorder) return function(args...);
+    auto inputs = nlohmann::json::array({ recorder->input(args)... });
+    const auto start = recorder->elapsed();
+    const int rc = function(args...);
+    const auto duration = recorder->elapsed() - start;
+    auto outputs = nlohmann::json::array();
+    if (rc == GA_OK) (recorder->output(outputs, args), ...);
+    recorder->write(name, start, duration, std::move(inputs), rc, std::move(outputs));
+    return rc;
+}
+
+// calls a GA_* function, through the recorder when recording
+#define GDK_CALL(function, ...) GdkRecorder::call(#function, &function, __VA_ARGS__)
+
+#endif // GREEN_GDKRECORDER_H
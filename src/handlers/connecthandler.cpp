@@ -1,3 +1,4 @@
+#include "gdkrecorder.h"
 #include "json.h"
 #include "connecthandler.h"
 #include "network.h"
@@ -40,6 +41,6 @@ void ConnectHandler::exec()
     setFuture(QtConcurrent::run([this] {
         auto params = get_params(m_session);
         auto session = m_session->m_session;
-        return GA_connect(session, Json::fromObject(params).get());
+        return GDK_CALL(GA_connect, session, Json::fromObject(params).get());
     }));
 }
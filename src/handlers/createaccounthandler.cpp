@@ -1,4 +1,5 @@
 #include "createaccounthandler.h"
+#include "gdkrecorder.h"
 #include "json.h"
 
 #include <gdk.h>
@@ -18,7 +19,7 @@ int CreateAccountHandler::pointer() const
 void CreateAccountHandler::call(GA_session *session, GA_auth_handler **auth_handler)
 {
     auto details = Json::fromObject(m_details);
-    int res = GA_create_subaccount(session, details.get(), auth_handler);
+    int res = GDK_CALL(GA_create_subaccount, session, details.get(), auth_handler);
     Q_ASSERT(res == GA_OK);
 }
 
@@ -1,4 +1,5 @@
 #include "createtransactionhandler.h"
+#include "gdkrecorder.h"
 #include "json.h"
 #include "network.h"
 #include "session.h"
@@ -38,7 +39,7 @@ QJsonObject CreateTransactionHandler::transaction() const
 void CreateTransactionHandler::call(GA_session* session, GA_auth_handler** auth_handler)
 {
     auto details = Json::fromObject(m_details);
-    int err = GA_create_transaction(session, details.get(), auth_handler);
+    int err = GDK_CALL(GA_create_transaction, session, details.get(), auth_handler);
     Q_ASSERT(err == GA_OK);
 }
 
@@ -1,4 +1,5 @@
 #include "deletewallethandler.h"
+#include "gdkrecorder.h"
 
 #include <gdk.h>
 
@@ -9,6 +10,6 @@ DeleteWalletHandler::DeleteWalletHandler(Session* session)
 
 void DeleteWalletHandler::call(GA_session* session, GA_auth_handler** auth_handler)
 {
-    int res = GA_remove_account(session, auth_handler);
+    int res = GDK_CALL(GA_remove_account, session, auth_handler);
     Q_ASSERT(res == GA_OK);
 }
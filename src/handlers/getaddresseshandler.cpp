@@ -1,4 +1,5 @@
 #include "account.h"
+#include "gdkrecorder.h"
 #include "json.h"
 #include "getaddresseshandler.h"
 
@@ -10,7 +11,7 @@ void GetAddressesHandler::call(GA_session *session, GA_auth_handler **auth_handl
     if (m_last_pointer != 0) _details["last_pointer"] = m_last_pointer;
     auto details = Json::fromObject(_details);
 
-    int err = GA_get_previous_addresses(session, details.get(), auth_handler);
+    int err = GDK_CALL(GA_get_previous_addresses, session, details.get(), auth_handler);
     Q_ASSERT(err == GA_OK);
 }
 
@@ -1,4 +1,5 @@
 #include "account.h"
+#include "gdkrecorder.h"
 #include "getbalancehandler.h"
 #include "json.h"
 
@@ -17,6 +18,6 @@ void GetBalanceHandler::call(GA_session* session, GA_auth_handler** auth_handler
         { "num_confs", 0 }
     });
 
-    int err = GA_get_balance(session, details.get(), auth_handler);
+    int err = GDK_CALL(GA_get_balance, session, details.get(), auth_handler);
     Q_ASSERT(err == GA_OK);
 }
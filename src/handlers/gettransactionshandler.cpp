@@ -1,3 +1,4 @@
+#include "gdkrecorder.h"
 #include "json.h"
 #include "gettransactionshandler.h"
 
@@ -12,7 +13,7 @@ void GetTransactionsHandler::call(GA_session *session, GA_auth_handler **auth_ha
     });
 
     // TODO: check result value
-    GA_get_transactions(session, details.get(), auth_handler);
+    GDK_CALL(GA_get_transactions, session, details.get(), auth_handler);
 }
 
 GetTransactionsHandler::GetTransactionsHandler(int subaccount, int first, int count, Session *session)
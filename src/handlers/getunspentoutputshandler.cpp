@@ -1,4 +1,5 @@
 #include "account.h"
+#include "gdkrecorder.h"
 #include "json.h"
 #include "getunspentoutputshandler.h"
 
@@ -12,7 +13,7 @@ void GetUnspentOutputsHandler::call(GA_session *session, GA_auth_handler **auth_
         { "all_coins", m_all_coins }
     });
 
-    int err = GA_get_unspent_outputs(session, details.get(), auth_handler);
+    int err = GDK_CALL(GA_get_unspent_outputs, session, details.get(), auth_handler);
     Q_ASSERT(err == GA_OK);
 }
 
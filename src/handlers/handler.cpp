@@ -2,17 +2,30 @@
 #include "device.h"
 #include "devicemanager.h"
 #include "ga.h"
+#include "gdkrecorder.h"
 #include "handler.h"
 #include "json.h"
 #include "resolver.h"
 #include "resolvers/signmessageresolver.h"
 #include "session.h"
+#include "trace.h"
 #include "wallet.h"
 
 #include <gdk.h>
 
 #include <QtConcurrentRun>
 
+#include <typeinfo>
+
+static QString HandlerName(const Handler* handler)
+{
+    // most handlers don't declare Q_OBJECT, use the (itanium mangled) type name
+    QString name = typeid(*handler).name();
+    int i = 0;
+    while (i < name.size() && name.at(i).isDigit()) ++i;
+    return name.mid(i);
+}
+
 Handler::Handler(Session* session)
     : QFutureWatcher<void>(session)
     , m_session(session)
@@ -20,12 +33,29 @@ Handler::Handler(Session* session)
     connect(this, &Handler::finished, this, [this] {
         step();
     });
+    connect(this, &Handler::done, this, [this] {
+        record(ActivityManager::Outcome::Finished);
+    });
+    connect(this, &Handler::error, this, [this] {
+        record(ActivityManager::Outcome::Failed);
+    });
+    if (Trace::enabled()) {
+        connect(this, &Handler::done, this, [this] {
+            Trace::end("handler", HandlerName(this), Trace::id(this), {{ "status", "done" }});
+        });
+        connect(this, &Handler::error, this, [this] {
+            Trace::end("handler", HandlerName(this), Trace::id(this), {{ "status", "error" }});
+        });
+    }
 }
 
 Handler::~Handler()
 {
+    // destroyed before done or error
+    record(ActivityManager::Outcome::Cancelled);
+    endResolve("cancelled");
     waitForFinished();
-    if (m_auth_handler) GA_destroy_auth_handler(m_auth_handler);
+    if (m_auth_handler) GDK_CALL(GA_destroy_auth_handler, m_auth_handler);
 }
 
 static QJsonObject getErrorDetails()
@@ -46,8 +76,19 @@ void Handler::exec()
     m_already_exec = true;
 
     Q_ASSERT(!m_auth_handler);
+    m_type = HandlerName(this);
+    m_exec_time = ActivityManager::instance()->elapsed();
+    if (Trace::enabled()) {
+        Trace::begin("handler", HandlerName(this), Trace::id(this));
+        Trace::begin("handler", "queue", Trace::id(this), {{ "pending", pool.activeThreadCount() }});
+    }
     setFuture(QtConcurrent::run(&pool, [this] {
+        if (Trace::enabled()) {
+            Trace::end("handler", "queue", Trace::id(this));
+            Trace::begin("handler", "call", Trace::id(this));
+        }
         call(m_session->m_session, &m_auth_handler);
+        if (Trace::enabled()) Trace::end("handler", "call", Trace::id(this));
         m_error_details = getErrorDetails();
         if (!m_error_details.isEmpty()) {
             qDebug() << m_error_details;
@@ -57,10 +98,19 @@ void Handler::exec()
 
 void Handler::fail()
 {
+    endResolve("failed");
     setResult({{ "status", "error" }});
     emit error();
 }
 
+void Handler::record(ActivityManager::Outcome outcome)
+{
+    if (m_exec_time < 0) return;
+    const auto manager = ActivityManager::instance();
+    manager->record("handler", m_type, manager->elapsed() - m_exec_time, outcome);
+    m_exec_time = -1;
+}
+
 const QJsonObject& Handler::result() const
 {
     Q_ASSERT(!m_result.empty());
@@ -70,7 +120,7 @@ const QJsonObject& Handler::result() const
 static QJsonObject getResult(GA_auth_handler* auth_handler)
 {
     GA_json* output;
-    int err = GA_auth_handler_get_status(auth_handler, &output);
+    int err = GDK_CALL(GA_auth_handler_get_status, auth_handler, &output);
     Q_ASSERT(err == GA_OK);
     const auto result = Json::toObject(output);
     err = GA_destroy_json(output);
@@ -98,8 +148,10 @@ void Handler::step()
 
         if (status == "call") {
             setFuture(QtConcurrent::run([this] {
-                int res = GA_auth_handler_call(m_auth_handler);
+                if (Trace::enabled()) Trace::begin("handler", "GA_auth_handler_call", Trace::id(this));
+                int res = GDK_CALL(GA_auth_handler_call, m_auth_handler);
                 Q_ASSERT(res == GA_OK);
+                if (Trace::enabled()) Trace::end("handler", "GA_auth_handler_call", Trace::id(this));
             }));
             return;
         }
@@ -119,7 +171,7 @@ void Handler::step()
             Q_ASSERT(methods.size() > 0);
             if (methods.size() == 1) {
                 const auto method = methods.first().toString();
-                int err = GA_auth_handler_request_code(m_auth_handler, method.toLocal8Bit().constData());
+                int err = GDK_CALL(GA_auth_handler_request_code, m_auth_handler, method.toLocal8Bit().constData());
                 Q_ASSERT(err == GA_OK);
                 continue;
             } else {
@@ -141,7 +193,7 @@ void Handler::request(const QByteArray& method)
 {
     Q_ASSERT(m_auth_handler);
     Q_ASSERT(m_result.value("status").toString() == "request_code");
-    int res = GA_auth_handler_request_code(m_auth_handler, method.data());
+    int res = GDK_CALL(GA_auth_handler_request_code, m_auth_handler, method.data());
     Q_ASSERT(res == GA_OK);
     step();
 }
@@ -157,6 +209,15 @@ static Device* GetDeviceFromRequiredData(const QJsonObject& required_data)
 
 void Handler::handleResolveCode(const QJsonObject& result)
 {
+    // a retry, or the device showing up, continues the pending span
+    if (!m_resolving) {
+        m_resolving = true;
+        if (Trace::enabled()) {
+            const auto required_data = result.value("required_data").toObject();
+            const auto action = required_data.isEmpty() ? result.value("method").toString() : required_data.value("action").toString();
+            Trace::begin("handler", "resolve", Trace::id(this), {{ "action", action }});
+        }
+    }
     Resolver* resolver{nullptr};
     if (result.contains("required_data")) {
         const auto required_data = result.value("required_data").toObject();
@@ -205,11 +266,19 @@ void Handler::resolve(const QJsonObject& data)
 void Handler::resolve(const QByteArray& data)
 {
     Q_ASSERT(m_auth_handler);
-    int res = GA_auth_handler_resolve_code(m_auth_handler, data.constData());
+    endResolve("resolved");
+    int res = GDK_CALL(GA_auth_handler_resolve_code, m_auth_handler, data.constData());
     Q_ASSERT(res == GA_OK);
     step();
 }
 
+void Handler::endResolve(const char* status)
+{
+    if (!m_resolving) return;
+    m_resolving = false;
+    if (Trace::enabled()) Trace::end("handler", "resolve", Trace::id(this), {{ "status", status }});
+}
+
 void Handler::setResult(const QJsonObject& result)
 {
     m_result = result;
@@ -225,7 +294,7 @@ GetSubAccountsHandler::GetSubAccountsHandler(Session *session, bool refresh)
 void GetSubAccountsHandler::call(GA_session *session, GA_auth_handler **auth_handler)
 {
     auto details = Json::fromObject({{ "refresh", m_refresh }});
-    int res = GA_get_subaccounts(session, details.get(), auth_handler);
+    int res = GDK_CALL(GA_get_subaccounts, session, details.get(), auth_handler);
     Q_ASSERT(res == GA_OK);
 }
 
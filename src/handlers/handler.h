@@ -1,6 +1,8 @@
 #ifndef GREEN_HANDLER_H
 #define GREEN_HANDLER_H
 
+#include "activitymanager.h"
+
 #include <QtQml>
 #include <QObject>
 #include <QJsonObject>
@@ -43,12 +45,20 @@ private:
     virtual void call(GA_session* session, GA_auth_handler** auth_handler) = 0;
     void step();
     void handleResolveCode(const QJsonObject& result);
+    // ends the resolve span started in handleResolveCode, if any
+    void endResolve(const char* status);
     void setResult(const QJsonObject &result);
+    void record(ActivityManager::Outcome outcome);
 private:
     bool m_already_exec{false};
+    // type name and start of execution in ActivityManager time, captured in
+    // exec() since the destructor can't resolve the dynamic type
+    QString m_type;
+    qint64 m_exec_time{-1};
     Session* const m_session;
     GA_auth_handler* m_auth_handler{nullptr};
     TwoFactorResolver* m_two_factor_resolver{nullptr};
+    bool m_resolving{false};
     QJsonObject m_result;
     QJsonObject m_error_details;
 };
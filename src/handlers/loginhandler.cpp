@@ -1,3 +1,4 @@
+#include "gdkrecorder.h"
 #include "json.h"
 #include "loginhandler.h"
 
@@ -51,7 +52,7 @@ void LoginHandler::call(GA_session *session, GA_auth_handler **auth_handler)
 {
     auto hw_device = Json::fromObject(m_hw_device);
     auto details = Json::fromObject(m_details);
-    GA_login_user(session, hw_device.get(), details.get(), auth_handler);
+    GDK_CALL(GA_login_user, session, hw_device.get(), details.get(), auth_handler);
 }
 
 QString LoginHandler::walletHashId() const
@@ -1,3 +1,4 @@
+#include "gdkrecorder.h"
 #include "json.h"
 #include "registeruserhandler.h"
 
@@ -21,7 +22,7 @@ void RegisterUserHandler::call(GA_session* session, GA_auth_handler** auth_handl
 {
     const auto details = Json::fromObject(m_details);
     auto device_details = Json::fromObject(m_device_details);
-    int err = GA_register_user(session, device_details.get(), details.get(), auth_handler);
+    int err = GDK_CALL(GA_register_user, session, device_details.get(), details.get(), auth_handler);
     Q_ASSERT(err == GA_OK);
 }
 
@@ -1,3 +1,4 @@
+#include "gdkrecorder.h"
 #include "json.h"
 #include "sendtransactionhandler.h"
 
@@ -16,6 +17,6 @@ void SendTransactionHandler::call(GA_session* session, GA_auth_handler** auth_ha
     qDebug() << Q_FUNC_INFO << m_details;
 
     auto details = Json::fromObject(m_details);
-    int err = GA_send_transaction(session, details.get(), auth_handler);
+    int err = GDK_CALL(GA_send_transaction, session, details.get(), auth_handler);
     Q_ASSERT(err == GA_OK);
 }
@@ -1,3 +1,4 @@
+#include "gdkrecorder.h"
 #include "json.h"
 #include "signtransactionhandler.h"
 
@@ -12,6 +13,6 @@ SignTransactionHandler::SignTransactionHandler(const QJsonObject& details, Sessi
 void SignTransactionHandler::call(GA_session* session, GA_auth_handler** auth_handler)
 {
     auto details = Json::fromObject(m_details);
-    int err = GA_sign_transaction(session, details.get(), auth_handler);
+    int err = GDK_CALL(GA_sign_transaction, session, details.get(), auth_handler);
     Q_ASSERT(err == GA_OK);
 }
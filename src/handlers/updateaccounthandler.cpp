@@ -1,3 +1,4 @@
+#include "gdkrecorder.h"
 #include "json.h"
 #include "updateaccounthandler.h"
 
@@ -12,6 +13,6 @@ UpdateAccountHandler::UpdateAccountHandler(const QJsonObject &details, Session*
 void UpdateAccountHandler::call(GA_session *session, GA_auth_handler **auth_handler)
 {
     auto details = Json::fromObject(m_details);
-    int err = GA_update_subaccount(session, details.get(), auth_handler);
+    int err = GDK_CALL(GA_update_subaccount, session, details.get(), auth_handler);
     Q_ASSERT(err == GA_OK);
 }
@@ -1,4 +1,5 @@
 #include "httprequestactivity.h"
+#include "gdkrecorder.h"
 #include "json.h"
 #include "session.h"
 
@@ -74,25 +75,31 @@ void HttpRequestActivity::exec()
         }
     });
 
-    watcher->setFuture(QtConcurrent::run([this] {
-        QJsonObject details;
-        details.insert("method", m_method);
-        details.insert("urls", QJsonArray::fromStringList(m_urls));
+    QJsonObject details;
+    details.insert("method", m_method);
+    details.insert("urls", QJsonArray::fromStringList(m_urls));
 
-        if (!m_accept.isEmpty()) details.insert("accept", m_accept);
-        if (!m_data.isNull()) details.insert("data", m_data);
+    if (!m_accept.isEmpty()) details.insert("accept", m_accept);
+    if (!m_data.isNull()) details.insert("data", m_data);
 
-        if (!m_headers.isEmpty()) details.insert("headers", QJsonObject::fromVariantMap(m_headers));
-        if (m_timeout > 0) details.insert("timeout", m_timeout);
+    if (!m_headers.isEmpty()) details.insert("headers", QJsonObject::fromVariantMap(m_headers));
+    if (m_timeout > 0) details.insert("timeout", m_timeout);
 
-        if (!m_root_certificates.isEmpty()) details.insert("root_certificates", QJsonArray::fromStringList(m_root_certificates));
+    if (!m_root_certificates.isEmpty()) details.insert("root_certificates", QJsonArray::fromStringList(m_root_certificates));
 
+    // the activity can be destroyed while the request runs, the worker only
+    // gets copies, and the session waits for it before destroying the
+    // GA_session
+    GA_session* const session = this->session()->m_session;
+    const auto future = QtConcurrent::run([details, session] {
         auto params = Json::fromObject(details);
         GA_json* output;
-        int rc = GA_http_request(session()->m_session, params.get(), &output);
+        int rc = GDK_CALL(GA_http_request, session, params.get(), &output);
         if (rc != GA_OK) return QJsonObject();
         auto response = Json::toObject(output);
         GA_destroy_json(output);
         return response;
-    }));
+    });
+    this->session()->addPendingCall(future);
+    watcher->setFuture(future);
 }
@@ -8,8 +8,10 @@ HEADERS += \
     $$PWD/jadeconnection.h \
     $$PWD/jadedeviceserialportdiscoveryagent.h \
     $$PWD/jadelogincontroller.h \
+    $$PWD/jaderequestwriter.h \
     $$PWD/jadeserialimpl.h \
     $$PWD/jadedevice.h \
+    $$PWD/jadefirmwarecache.h \
     $$PWD/deviceinfo.h \
     $$PWD/jadeupdatecontroller.h \
     $$PWD/serviceinfo.h
@@ -22,6 +24,13 @@ SOURCES += \
     $$PWD/jadelogincontroller.cpp \
     $$PWD/jadeserialimpl.cpp \
     $$PWD/jadedevice.cpp \
+    $$PWD/jadefirmwarecache.cpp \
     $$PWD/deviceinfo.cpp \
     $$PWD/jadeupdatecontroller.cpp \
     $$PWD/serviceinfo.cpp
+
+# the emulator is only built for development and benchmarks
+mockgdk {
+    HEADERS += $$PWD/jadeemulatorimpl.h
+    SOURCES += $$PWD/jadeemulatorimpl.cpp
+}
@@ -15,6 +15,8 @@
 #include "jadeserialimpl.h"
 
 #include "jadeapi.h"
+#include "jaderequestwriter.h"
+#include "trace.h"
 
 // Useful for sending null values in tx-signing calls
 QVariant JadeAPI::NULL_CHANGE_ENTRY;
@@ -48,7 +50,7 @@ JadeAPI::JadeAPI(const QBluetoothDeviceInfo& deviceInfo, QObject *parent)
     // qDebug() << "JadeAPI::JadeAPI(ble)";
 }
 
-// Private ctor
+// Create with given connection
 JadeAPI::JadeAPI(JadeConnection *connection, QObject *parent)
     : QObject(parent),
       m_idgen(QRandomGenerator::securelySeeded()),
@@ -56,6 +58,7 @@ JadeAPI::JadeAPI(JadeConnection *connection, QObject *parent)
       m_jade(connection)
 {
     m_jade->setParent(this);  // take impl ownership here
+    m_buffer.reserve(4096);
 
     // Connect the underlying connection's 'new message' signal to our handler
     connect(m_jade, &JadeConnection::onNewMessageReceived,
@@ -165,6 +168,7 @@ void JadeAPI::callResponseHandler(const QVariantMap &msg)
     // Get (ie. remove) the response handler for that id from the map of registered handlers
     const ResponseHandler handler = m_responseHandlers.take(id);
     m_request_proxy.remove(id);
+    if (Trace::enabled()) Trace::end("jade", "request", id, {{ "error", msg.contains("error") }});
     if (!handler)
     {
         // qWarning() << "JadeAPI::callResponseHandler() - Message ignored - no handler found for id" << msg;
@@ -242,17 +246,33 @@ void JadeAPI::sendToJade(const QCborMap &msg)
     // qInfo() << "JadeAPI::sendToJade() - Sending message ->" << Qt::endl << msg;
     Q_ASSERT(m_jade);
     m_jade->send(msg);
-    int id = msg["id"].toString().toInt();
+    if (Trace::enabled()) Trace::begin("jade", "request", msg["id"].toString().toInt());
+    startResponseTimeout(msg["id"].toString().toInt());
+}
+
+void JadeAPI::sendToJade(const int id)
+{
+    m_idle_timer.restart();
+    if (Trace::enabled()) Trace::begin("jade", "request", id, {{ "size", m_buffer.size() }});
+
+    Q_ASSERT(m_jade);
+    m_jade->send(m_buffer);
+    startResponseTimeout(id);
+}
+
+void JadeAPI::startResponseTimeout(const int id)
+{
     int timeout = m_msg_timeout.value(id, 0);
     if (timeout > 0) QTimer::singleShot(timeout, this, [=] {
         // Get (ie. remove) the response handler for that id from the map of registered handlers
         const ResponseHandler handler = m_responseHandlers.take(id);
         if (!handler) return;
+        if (Trace::enabled()) Trace::end("jade", "request", id, {{ "error", "timeout" }});
         QVariantMap error = {{ "message", "timeout" }};
         try {
             handler({{ "error", error }});
         } catch(...) {
-            qWarning() << "JadeAPI::callResponseHandler() - Error in client handler for" << msg;
+            qWarning() << "JadeAPI::callResponseHandler() - Error in client handler for timeout of" << id;
         }
     });
 }
@@ -261,22 +281,16 @@ void JadeAPI::sendToJade(const QCborMap &msg)
  *  The API calls
  */
 
-static QCborArray convertPath(const QVector<quint32> &path)
-{
-    QCborArray pathArray;
-    for (const quint32 val : path) {
-        pathArray.append(val);
-    }
-    return pathArray;
-}
 #ifndef QT_NO_DEBUG
 // Set debug mnemonic
 int JadeAPI::setMnemonic(const QString& mnemonic, const ResponseHandler &cb)
 {
     const int id = registerResponseHandler(cb);
-    const QCborMap params = { {"mnemonic", mnemonic} };
-    const QCborMap request = getRequest(id, "debug_set_mnemonic", params);
-    sendToJade(request);
+    {
+        JadeRequestWriter request(&m_buffer, id, "debug_set_mnemonic", 1);
+        request.appendString("mnemonic", mnemonic);
+    }
+    sendToJade(id);
     return id;
 }
 #endif
@@ -285,8 +299,8 @@ int JadeAPI::setMnemonic(const QString& mnemonic, const ResponseHandler &cb)
 int JadeAPI::getVersionInfo(const ResponseHandler &cb)
 {
     const int id = registerResponseHandler(cb, 500);
-    const QCborMap request = getRequest(id, "get_version_info");
-    sendToJade(request);
+    JadeRequestWriter(&m_buffer, id, "get_version_info");
+    sendToJade(id);
     return id;
 }
 
@@ -294,9 +308,11 @@ int JadeAPI::getVersionInfo(const ResponseHandler &cb)
 int JadeAPI::addEntropy(const QByteArray &entropy, const ResponseHandler &cb)
 {
     const int id = registerResponseHandler(cb);
-    const QCborMap params = { {"entropy", entropy} };
-    const QCborMap request = getRequest(id, "add_entropy", params);
-    sendToJade(request);
+    {
+        JadeRequestWriter request(&m_buffer, id, "add_entropy", 1);
+        request.appendBytes("entropy", entropy);
+    }
+    sendToJade(id);
     return id;
 }
 
@@ -308,21 +324,35 @@ int JadeAPI::authUser(const QString &network, const ResponseHandler &cb, const H
     m_request_proxy[id] = request_proxy;
 
     const qint64 now_epoch_secs = QDateTime::currentSecsSinceEpoch();
-    const QCborMap params = { {"network", network}, {"epoch", now_epoch_secs } };
-    const QCborMap request = getRequest(id, "auth_user", params);
-    sendToJade(request);
+    {
+        JadeRequestWriter request(&m_buffer, id, "auth_user", 2);
+        request.appendString("network", network);
+        request.appendInteger("epoch", now_epoch_secs);
+    }
+    sendToJade(id);
     return id;
 }
 
 // OTA update the connected Jade
-int JadeAPI::otaUpdate(const QByteArray& fwcmp, const int fwlen, const int chunkSize, const ResponseHandler &cbProgress, const ResponseHandler &cb)
+int JadeAPI::otaUpdate(const QByteArray& fwcmp, const int fwlen, const int chunkSize, const int window, const ResponseHandler &cbProgress, const ResponseHandler &cb)
 {
+    Q_ASSERT(chunkSize > 0);
+    Q_ASSERT(window > 0);
+
     // The exposed/returned id that will key the caller's handler (invoked
     // when the OTA completes successfully or errors).
     const int id = registerResponseHandler(cb);
 
-    // Register the recursive callback used to upload ota data chunks
-    const int tmpId = registerResponseHandler(makeOtaChunkCallback(id, fwcmp, chunkSize, 0, cbProgress));
+    QSharedPointer<OtaState> state(new OtaState);
+    state->id = id;
+    state->fwcmp = fwcmp;
+    state->chunkSize = chunkSize;
+    state->window = window;
+    state->cbProgress = cbProgress;
+
+    // Register the callback which acknowledges the ota request itself
+    const int tmpId = registerResponseHandler(makeOtaChunkCallback(state, 0));
+    state->pending.insert(tmpId);
 
     QCryptographicHash hash(QCryptographicHash::Sha256);
     hash.addData(fwcmp);
@@ -330,33 +360,65 @@ int JadeAPI::otaUpdate(const QByteArray& fwcmp, const int fwlen, const int chunk
 
     // Initiate OTA process, and return the exposed id
     const int compressedSize = fwcmp.length();
-    const QCborMap params = { {"fwsize", fwlen}, {"cmpsize", compressedSize}, {"cmphash", cmphash} };
-    const QCborMap request = getRequest(tmpId, "ota", params);
-    sendToJade(request);
+    {
+        JadeRequestWriter request(&m_buffer, tmpId, "ota", 3);
+        request.appendInteger("fwsize", fwlen);
+        request.appendInteger("cmpsize", compressedSize);
+        request.appendBytes("cmphash", cmphash);
+    }
+    state->timer.start();
+    sendToJade(tmpId);
     return id;
 }
 
+// Send data chunks until the window of unacknowledged chunks is full
+void JadeAPI::sendOtaChunks(const QSharedPointer<OtaState> &state)
+{
+    while (!state->failed && state->sent < state->fwcmp.length() &&
+           state->sent - state->acked < state->window * state->chunkSize)
+    {
+        const int nextChunkLen = qMin(state->chunkSize, state->fwcmp.length() - state->sent);
+        // raw view on the firmware data, the chunk is copied only into the request buffer
+        const QByteArray nextChunk = QByteArray::fromRawData(state->fwcmp.constData() + state->sent, nextChunkLen);
+        state->sent += nextChunkLen;
+        qDebug() << "JadeAPI::sendOtaChunks() for" << state->id << "sending chunk of size" << nextChunkLen << "in flight" << state->sent - state->acked;
+
+        const int tmpId = registerResponseHandler(makeOtaChunkCallback(state, state->sent));
+        state->pending.insert(tmpId);
+        JadeRequestWriter(&m_buffer, tmpId, "ota_data", nextChunk);
+        sendToJade(tmpId);
+    }
+}
+
 // Helper for OTA (per-)chunk upload
-JadeAPI::ResponseHandler JadeAPI::makeOtaChunkCallback(const int id, const QByteArray &fwcmp, const int chunkSize, const int currentPos, const ResponseHandler &cbProgress)
+JadeAPI::ResponseHandler JadeAPI::makeOtaChunkCallback(const QSharedPointer<OtaState> &state, const int endPos)
 {
-    return [this, id, fwcmp, chunkSize, currentPos, cbProgress](const QVariantMap& rslt)
+    return [this, state, endPos](const QVariantMap& rslt)
     {
-        Q_ASSERT(currentPos >= 0);
-        Q_ASSERT(currentPos <= fwcmp.length());
+        Q_ASSERT(endPos >= 0);
+        Q_ASSERT(endPos <= state->fwcmp.length());
+
+        state->pending.remove(rslt["id"].toString().toInt());
+        if (state->failed) return;
 
-        // If all good, send next chunk (or final message)
+        // If all good, send next chunks (or final message)
         if (rslt.contains("result") && rslt["result"].toBool())
         {
-            qDebug() << "JadeAPI::makeOtaChunkCallback()::lambda for" << id << "uploaded" << currentPos << "/" << fwcmp.length();
+            // Chunks are acknowledged in order
+            state->acked = endPos;
+            const qint64 elapsed = qMax<qint64>(1, state->timer.elapsed());
+            const qint64 speed = qint64(state->acked) * 1000 / elapsed;
+            qDebug() << "JadeAPI::makeOtaChunkCallback()::lambda for" << state->id << "uploaded" << state->acked << "/" << state->fwcmp.length() << "at" << speed << "bytes/s";
 
             // Call progress callback if provided
-            if (cbProgress)
+            if (state->cbProgress)
             {
                 try
                 {
-                    cbProgress(QVariantMap { {"id", QString::number(id)},
-                                             {"size", fwcmp.length()},
-                                             {"uploaded", currentPos} });
+                    state->cbProgress(QVariantMap { {"id", QString::number(state->id)},
+                                                    {"size", state->fwcmp.length()},
+                                                    {"uploaded", state->acked},
+                                                    {"speed", speed} });
                 }
                 catch(...)
                 {
@@ -364,31 +426,30 @@ JadeAPI::ResponseHandler JadeAPI::makeOtaChunkCallback(const int id, const QByte
                 }
             }
 
-            // Upload next data chunk
-            if (currentPos < fwcmp.length())
+            if (state->acked < state->fwcmp.length())
             {
-                // Locate next chunk
-                const int nextChunkLen = fwcmp.length() - currentPos >= chunkSize ? chunkSize : fwcmp.size() - currentPos;
-                const QByteArray nextChunk = fwcmp.mid(currentPos, nextChunkLen);
-                qDebug() << "JadeAPI::makeOtaChunkCallback()::lambda for" << id << "sending chunk of size" << nextChunkLen;
-
-                // Send chunk to Jade, creating a new instance of this callback
-                const int tmpId = registerResponseHandler(makeOtaChunkCallback(id, fwcmp, chunkSize, currentPos+nextChunkLen, cbProgress));
-                const QCborMap otaData = getRequest(tmpId, "ota_data", nextChunk);
-                sendToJade(otaData);
+                // Upload next data chunks
+                sendOtaChunks(state);
             }
             else
             {
                 // Upload complete - send final message using exposed id (and hence directing response at callers handler)
-                qDebug() << "JadeAPI::makeOtaChunkCallback()::lambda for" << id << "all chunks uploaded - sending ota_complete";
-                const QCborMap otaData = getRequest(id, "ota_complete");
-                sendToJade(otaData);
+                qDebug() << "JadeAPI::makeOtaChunkCallback()::lambda for" << state->id << "all chunks uploaded in" << elapsed << "ms - sending ota_complete";
+                JadeRequestWriter(&m_buffer, state->id, "ota_complete");
+                sendToJade(state->id);
             }
         }
         else
         {
-            // Error - stop loading chunks and forward error to caller's response handler
-            forwardToResponseHandler(id, rslt);
+            // Error - stop loading chunks, drop the handlers of chunks still
+            // in flight and forward error to caller's response handler
+            state->failed = true;
+            for (const int pendingId : qAsConst(state->pending))
+            {
+                m_responseHandlers.remove(pendingId);
+            }
+            state->pending.clear();
+            forwardToResponseHandler(state->id, rslt);
         }
     };
 }
@@ -398,15 +459,16 @@ int JadeAPI::getReceiveAddress(const QString &network, const quint32 subaccount,
                                const QString &recoveryxpub, const quint32 csvBlocks, const ResponseHandler &cb)
 {
     const int id = registerResponseHandler(cb);
-    const QCborMap params = { {"network", network},
-                              {"subaccount", subaccount},
-                              {"branch", branch},
-                              {"pointer", pointer},
-                              {"recovery_xpub", recoveryxpub},
-                              {"csv_blocks", csvBlocks}
-                            };
-    const QCborMap request = getRequest(id, "get_receive_address", params);
-    sendToJade(request);
+    {
+        JadeRequestWriter request(&m_buffer, id, "get_receive_address", 6);
+        request.appendString("network", network);
+        request.appendInteger("subaccount", subaccount);
+        request.appendInteger("branch", branch);
+        request.appendInteger("pointer", pointer);
+        request.appendString("recovery_xpub", recoveryxpub);
+        request.appendInteger("csv_blocks", csvBlocks);
+    }
+    sendToJade(id);
     return id;
 }
 
@@ -414,12 +476,13 @@ int JadeAPI::getReceiveAddress(const QString &network, const quint32 subaccount,
 int JadeAPI::getReceiveAddress(const QString& network, const QString& variant, const QVector<quint32>& path, const ResponseHandler &cb)
 {
     const int id = registerResponseHandler(cb);
-    const QCborMap params = { {"network", network},
-                              {"variant", variant},
-                              {"path", convertPath(path) },
-                            };
-    const QCborMap request = getRequest(id, "get_receive_address", params);
-    sendToJade(request);
+    {
+        JadeRequestWriter request(&m_buffer, id, "get_receive_address", 3);
+        request.appendString("network", network);
+        request.appendString("variant", variant);
+        request.appendPath("path", path);
+    }
+    sendToJade(id);
     return id;
 }
 
@@ -427,9 +490,12 @@ int JadeAPI::getReceiveAddress(const QString& network, const QString& variant, c
 int JadeAPI::getXpub(const QString &network, const QVector<quint32> &path, const ResponseHandler &cb)
 {
     const int id = registerResponseHandler(cb);
-    const QCborMap params = { {"network", network}, {"path", convertPath(path)} };
-    const QCborMap request = getRequest(id, "get_xpub", params);
-    sendToJade(request);
+    {
+        JadeRequestWriter request(&m_buffer, id, "get_xpub", 2);
+        request.appendString("network", network);
+        request.appendPath("path", path);
+    }
+    sendToJade(id);
     return id;
 }
 
@@ -442,13 +508,19 @@ int JadeAPI::signMessage(const QVector<quint32> &path, const QString &message, c
             const auto signature = rslt.value("result").toString();
             cb({ {"signature", signature}, {"signer_commitment", signer_commitment} });
         });
-        const QCborMap params = { {"ae_host_entropy", ae_host_entropy} };
-        const QCborMap request = getRequest(id, "get_signature", params);
-        sendToJade(request);
+        {
+            JadeRequestWriter request(&m_buffer, id, "get_signature", 1);
+            request.appendBytes("ae_host_entropy", ae_host_entropy);
+        }
+        sendToJade(id);
     });
-    const QCborMap params = { {"path", convertPath(path)}, {"message", message}, {"ae_host_commitment", ae_host_commitment} };
-    const QCborMap request = getRequest(id, "sign_message", params);
-    sendToJade(request);
+    {
+        JadeRequestWriter request(&m_buffer, id, "sign_message", 3);
+        request.appendPath("path", path);
+        request.appendString("message", message);
+        request.appendBytes("ae_host_commitment", ae_host_commitment);
+    }
+    sendToJade(id);
     return id;
 }
 
@@ -471,13 +543,15 @@ int JadeAPI::signTx(const QString &network, const QByteArray &txn, const QVarian
     const int tmpId = registerResponseHandler(makeSignTxInitialCallback(id, inputs));
 
     // Initiate signing process, and return the exposed id
-    const QCborMap params = { {"network", network},
-                              {"use_ae_signatures", true},
-                              {"txn", txn},
-                              {"num_inputs", inputs.size()},
-                              {"change", QCborArray::fromVariantList(change)} };
-    const QCborMap request = getRequest(tmpId, "sign_tx", params);
-    sendToJade(request);
+    {
+        JadeRequestWriter request(&m_buffer, tmpId, "sign_tx", 5);
+        request.appendString("network", network);
+        request.appendBool("use_ae_signatures", true);
+        request.appendBytes("txn", txn);
+        request.appendInteger("num_inputs", inputs.size());
+        request.appendValue("change", change);
+    }
+    sendToJade(tmpId);
     return id;
 }
 
@@ -514,11 +588,15 @@ void JadeAPI::sendTxInput(const int id, const int index, const QVariantList &inp
 
     auto input = inputs.at(index).toMap();
     input.remove("ae_host_entropy");
-    const QCborMap params = QCborMap::fromVariantMap(input);
 
     const int inputId = registerResponseHandler(makeReceiveCommitmentCallback(id, index, inputs, commitments));
-    const QCborMap request = getRequest(inputId, "tx_input", params);
-    sendToJade(request);
+    {
+        JadeRequestWriter request(&m_buffer, inputId, "tx_input", input.size());
+        for (auto i = input.cbegin(); i != input.cend(); ++i) {
+            request.appendValue(i.key(), i.value());
+        }
+    }
+    sendToJade(inputId);
 }
 
 // Helper for signTx / signLiquidTx to receive and collect the signatures
@@ -574,11 +652,13 @@ void JadeAPI::sendTxSignatureRequest(const int id, const int index, const QVaria
 
     auto input = inputs.at(index).toMap();
     auto ae_host_entropy = input.value("ae_host_entropy").toByteArray();
-    const QCborMap params = { {"ae_host_entropy", ae_host_entropy} };
 
     const int sigId = registerResponseHandler(makeReceiveSignatureCallback(id, index, inputs, commitments, signatures));
-    const QCborMap request = getRequest(sigId, "get_signature", params);
-    sendToJade(request);
+    {
+        JadeRequestWriter request(&m_buffer, sigId, "get_signature", 1);
+        request.appendBytes("ae_host_entropy", ae_host_entropy);
+    }
+    sendToJade(sigId);
 }
 
 
@@ -634,9 +714,11 @@ JadeAPI::ResponseHandler JadeAPI::makeReceiveSignatureCallback(const int id, con
 int JadeAPI::getBlindingKey(const QByteArray &script, const ResponseHandler &cb)
 {
     const int id = registerResponseHandler(cb);
-    const QCborMap params = { {"script", script} };
-    const QCborMap request = getRequest(id, "get_blinding_key", params);
-    sendToJade(request);
+    {
+        JadeRequestWriter request(&m_buffer, id, "get_blinding_key", 1);
+        request.appendBytes("script", script);
+    }
+    sendToJade(id);
     return id;
 }
 
@@ -646,9 +728,12 @@ int JadeAPI::getBlindingKey(const QByteArray &script, const ResponseHandler &cb)
 int JadeAPI::getSharedNonce(const QByteArray &script, const QByteArray &their_pubkey, const ResponseHandler &cb)
 {
     const int id = registerResponseHandler(cb);
-    const QCborMap params = { {"script", script}, {"their_pubkey", their_pubkey} };
-    const QCborMap request = getRequest(id, "get_shared_nonce", params);
-    sendToJade(request);
+    {
+        JadeRequestWriter request(&m_buffer, id, "get_shared_nonce", 2);
+        request.appendBytes("script", script);
+        request.appendBytes("their_pubkey", their_pubkey);
+    }
+    sendToJade(id);
     return id;
 }
 
@@ -667,9 +752,13 @@ int JadeAPI::getSharedNonce(const QByteArray &script, const QByteArray &their_pu
 int JadeAPI::getBlindingFactor(const QByteArray &hashPrevouts, const quint32 outputIndex, const QString& type, const ResponseHandler &cb)
 {
     const int id = registerResponseHandler(cb);
-    const QCborMap params = { {"hash_prevouts", hashPrevouts}, {"output_index", outputIndex}, {"type", type} };
-    const QCborMap request = getRequest(id, "get_blinding_factor", params);
-    sendToJade(request);
+    {
+        JadeRequestWriter request(&m_buffer, id, "get_blinding_factor", 3);
+        request.appendBytes("hash_prevouts", hashPrevouts);
+        request.appendInteger("output_index", outputIndex);
+        request.appendString("type", type);
+    }
+    sendToJade(id);
     return id;
 }
 
@@ -684,12 +773,17 @@ int JadeAPI::getBlindingFactor(const QByteArray &hashPrevouts, const quint32 out
 int JadeAPI::getCommitments(const QByteArray& assetId, const qint64 value, const QByteArray &hashPrevouts, const quint32 outputIndex, const QByteArray& vbf, const ResponseHandler &cb)
 {
     const int id = registerResponseHandler(cb);
-    QCborMap params = { {"asset_id", assetId}, {"value", value}, {"hash_prevouts", hashPrevouts}, {"output_index", outputIndex} };
-    if (!vbf.isEmpty()) {
-        params.insert(QCborValue("vbf"), vbf);
+    {
+        JadeRequestWriter request(&m_buffer, id, "get_commitments", vbf.isEmpty() ? 4 : 5);
+        request.appendBytes("asset_id", assetId);
+        request.appendInteger("value", value);
+        request.appendBytes("hash_prevouts", hashPrevouts);
+        request.appendInteger("output_index", outputIndex);
+        if (!vbf.isEmpty()) {
+            request.appendBytes("vbf", vbf);
+        }
     }
-    const QCborMap request = getRequest(id, "get_commitments", params);
-    sendToJade(request);
+    sendToJade(id);
     return id;
 }
 
@@ -712,21 +806,23 @@ int JadeAPI::signLiquidTx(const QString &network, const QByteArray &txn, const Q
     const int tmpId = registerResponseHandler(makeSignTxInitialCallback(id, inputs));
 
     // Initiate signing process, and return the exposed id
-    const QCborMap params = { {"network", network},
-                              {"use_ae_signatures", true},
-                              {"txn", txn},
-                              {"num_inputs", inputs.size()},
-                              {"trusted_commitments", QCborArray::fromVariantList(commitments)},
-                              {"change", QCborArray::fromVariantList(change)} };
-    const QCborMap request = getRequest(tmpId, "sign_liquid_tx", params);
-    sendToJade(request);
+    {
+        JadeRequestWriter request(&m_buffer, tmpId, "sign_liquid_tx", 6);
+        request.appendString("network", network);
+        request.appendBool("use_ae_signatures", true);
+        request.appendBytes("txn", txn);
+        request.appendInteger("num_inputs", inputs.size());
+        request.appendValue("trusted_commitments", commitments);
+        request.appendValue("change", change);
+    }
+    sendToJade(tmpId);
     return id;
 }
 
 int JadeAPI::getMasterBlindingKey(const ResponseHandler &cb)
 {
     const int id = registerResponseHandler(cb);
-    const QCborMap request = getRequest(id, "get_master_blinding_key");
-    sendToJade(request);
+    JadeRequestWriter(&m_buffer, id, "get_master_blinding_key");
+    sendToJade(id);
     return id;
 }
@@ -5,6 +5,8 @@
 #include <QMap>
 #include <QObject>
 #include <QRandomGenerator>
+#include <QSet>
+#include <QSharedPointer>
 
 #include "jadeconnection.h"
 
@@ -29,6 +31,10 @@ public:
     // Create JadeAPI on a ble connection
     explicit JadeAPI(const QBluetoothDeviceInfo& deviceInfo,
                      QObject *parent = nullptr);
+
+    // Create JadeAPI on the given connection (ie. emulator), takes ownership
+    explicit JadeAPI(JadeConnection* connection,
+                     QObject *parent = nullptr);
     ~JadeAPI();
 
     // Manage underlying connection
@@ -66,8 +72,9 @@ public:
     int authUser(const QString &network, const ResponseHandler &cb, const HttpRequestProxy &request_proxy);
 
     // OTA update the connected Jade
+    // Up to 'window' data chunks are sent ahead of the device acknowledgements
     // The passed ResponseHandler will be called multiple times during the update process
-    int otaUpdate(const QByteArray& fwcmp, const int fwlen, const int chunksize, const ResponseHandler &cbProgress, const ResponseHandler &cb);
+    int otaUpdate(const QByteArray& fwcmp, const int fwlen, const int chunksize, const int window, const ResponseHandler &cbProgress, const ResponseHandler &cb);
 
     // Get (receive) green address
     int getReceiveAddress(const QString &network, quint32 subaccount, quint32 branch, quint32 pointer,
@@ -130,9 +137,6 @@ private slots:
     void processResponseMessage(const QCborMap &msg);
 
 private:
-    // Private ctor
-    JadeAPI(JadeConnection* connection, QObject *parent);
-
     // Helper to get a new random id
     int getNewId();
 
@@ -141,8 +145,21 @@ private:
     void callResponseHandler(const QVariantMap &msg);
     void forwardToResponseHandler(const int targetId, const QVariantMap &msg);
 
-    // Helper for OTA (per-)chunk upload
-    ResponseHandler makeOtaChunkCallback(const int id, const QByteArray &fwcmp, const int chunkSize, const int currentPos, const ResponseHandler &cbProgress);
+    // Helpers for OTA (per-)chunk upload
+    struct OtaState {
+        int id;
+        QByteArray fwcmp;
+        int chunkSize;
+        int window;
+        int sent{0};
+        int acked{0};
+        bool failed{false};
+        QSet<int> pending;
+        QElapsedTimer timer;
+        ResponseHandler cbProgress;
+    };
+    void sendOtaChunks(const QSharedPointer<OtaState> &state);
+    ResponseHandler makeOtaChunkCallback(const QSharedPointer<OtaState> &state, const int endPos);
 
     // Helpers for signTx / signLiquidTx to send all tx inputs and receive signer-commitments and signatures
     ResponseHandler makeSignTxInitialCallback(const int id, const QVariantList &inputs);
@@ -154,6 +171,12 @@ private:
     // Send cbor message to Jade
     void sendToJade(const QCborMap &msg);
 
+    // Send the request encoded in m_buffer to Jade
+    void sendToJade(const int id);
+
+    // Arm the response timeout registered for the given message id
+    void startResponseTimeout(const int id);
+
     // Used to measure elapsed time since last activity
     QElapsedTimer m_idle_timer;
 
@@ -166,6 +189,9 @@ private:
     // Map of registered response handlers awaiting response
     QMap<int, ResponseHandler>  m_responseHandlers;
     QMap<int, int>              m_msg_timeout;
+    // Reusable buffer where requests are encoded
+    QByteArray                  m_buffer;
+
     // Underlying connection - lifetime managed by QObject hierarchy
     JadeConnection              *m_jade;
 };
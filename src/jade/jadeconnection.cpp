@@ -47,6 +47,18 @@ int JadeConnection::send(const QCborMap &msg)
     return writeImpl(bytes);
 }
 
+// Send encoded cbor message to Jade
+int JadeConnection::send(const QByteArray &cbor)
+{
+    if (!isConnected()) {
+        qWarning() << "JadeConnection::send() cannot send to disconnected device";
+        return 0;
+    }
+
+    // Pass to specific transport implementation
+    return writeImpl(cbor);
+}
+
 void JadeConnection::onDataReceived(const QByteArray &data) {
     // qDebug() << "JadeConnection::onDataReceived() -" << data.length() << "bytes received";
 
@@ -21,6 +21,9 @@ public:
     // Send cbor message to Jade
     int send(const QCborMap &msg);
 
+    // Send an already encoded cbor message to Jade
+    int send(const QByteArray &cbor);
+
 protected:
     // Called by derived implmentation when new data arrived
     void onDataReceived(const QByteArray &data);
@@ -66,7 +66,7 @@ public:
     {
         return m_signer_commitment;
     }
-    virtual void exec() override
+    void run() override
     {
         m_device->api()->signMessage(m_path, m_message, m_ae_host_commitment, m_ae_host_entropy, [this](const QVariantMap& result) {
             auto sig = QByteArray::fromBase64(result["signature"].toString().toLocal8Bit());
@@ -117,7 +117,7 @@ public:
         return path;
     }
 
-    void exec() override
+    void run() override
     {
         const auto txn = ParseByteArray(m_transaction.value("transaction"));
         QVariantList inputs;
@@ -213,7 +213,7 @@ public:
     {
         return m_public_key;
     }
-    void exec() override
+    void run() override
     {
         // TODO: the following QByteArray::fromHex should be done in resolver (and refactor ledger activity)
         const auto script = QByteArray::fromHex(m_script.toLocal8Bit());
@@ -243,7 +243,7 @@ public:
     {
         return m_nonce;
     }
-    void exec() override
+    void run() override
     {
         m_device->api()->getSharedNonce(m_script, m_pubkey, [this](const QVariantMap& msg) {
             Q_ASSERT(msg.contains("result") && msg["result"].type() == QVariant::ByteArray);
@@ -301,7 +301,7 @@ public:
     QList<QByteArray> valueCommitments() const override { return m_value_commitments; }
     QList<QByteArray> assetBlinders() const override { return m_asset_blinders; }
     QList<QByteArray> amountBlinders() const override { return m_amount_blinders; }
-    void exec() override
+    void run() override
     {
         QByteArray prevouts;
         QDataStream stream_prevouts(&prevouts, QIODevice::WriteOnly);
@@ -478,7 +478,7 @@ public:
     {
         return m_master_blinding_key;
     }
-    void exec() override
+    void run() override
     {
         m_device->api()->getMasterBlindingKey([this](const QVariantMap& msg) {
             if (msg.contains("result")) {
@@ -1,106 +1,248 @@
 #include "jadedeviceserialportdiscoveryagent.h"
 
+#include <QCommandLineParser>
+#include <QDebug>
 #include <QTimer>
 #include <QSerialPortInfo>
 
 #include "jadeapi.h"
 #include "jadedevice.h"
+#ifdef GREEN_MOCK_GDK
+#include "jadeemulatorimpl.h"
+#endif
 
 #include "devicemanager.h"
 
+#ifdef Q_OS_LINUX
+#include <QSocketNotifier>
+#include <libudev.h>
+#endif
+
 namespace {
 
-bool FilterSerialPort(const QSerialPortInfo& info)
+bool FilterVendorAndProduct(quint16 vendor_id, quint16 product_id)
 {
     // Silicon Laboratories USB to UART (0x10c4, 0xea60)
-    if (info.vendorIdentifier() == 0x10c4 && info.productIdentifier() == 0xea60) return false;
+    if (vendor_id == 0x10c4 && product_id == 0xea60) return false;
 
     // WCH CH9102F (0x1a86, 0x55d4)
-    if (info.vendorIdentifier() == 0x1a86 && info.productIdentifier() == 0x55d4) return false;
+    if (vendor_id == 0x1a86 && product_id == 0x55d4) return false;
 
     return true;
 }
 
+bool FilterSerialPort(const QSerialPortInfo& info)
+{
+    return FilterVendorAndProduct(info.vendorIdentifier(), info.productIdentifier());
+}
+
 } // namespace
 
+extern QCommandLineParser g_args;
+
 JadeDeviceSerialPortDiscoveryAgent::JadeDeviceSerialPortDiscoveryAgent(QObject* parent)
     : QObject(parent)
+    , m_timer(new QTimer(this))
 {
-    auto timer = new QTimer(this);
-    connect(timer, &QTimer::timeout, [this] {
-        auto devices = m_devices;
-        m_devices.clear();
-
-        if (m_reset_countdown == 0) {
-            m_failed_locations.clear();
-            m_reset_countdown = 0;
-        } else {
-            --m_reset_countdown;
+#ifdef GREEN_MOCK_GDK
+    if (g_args.isSet("jadeemulator")) addEmulator();
+#endif
+
+#ifdef Q_OS_LINUX
+    // Prefer tty hotplug events from udev, polling is only used as a fallback
+    m_udev = udev_new();
+    if (m_udev) m_monitor = udev_monitor_new_from_netlink(m_udev, "udev");
+    if (m_monitor &&
+        udev_monitor_filter_add_match_subsystem_devtype(m_monitor, "tty", nullptr) >= 0 &&
+        udev_monitor_enable_receiving(m_monitor) >= 0) {
+        auto notifier = new QSocketNotifier(udev_monitor_get_fd(m_monitor), QSocketNotifier::Read, this);
+        connect(notifier, &QSocketNotifier::activated, this, [this] {
+            udev_device* handle = udev_monitor_receive_device(m_monitor);
+            if (!handle) return;
+            const char* action = udev_device_get_action(handle);
+            const char* devnode = udev_device_get_devnode(handle);
+            if (action && devnode) {
+                if (strcmp(action, "add") == 0) {
+                    auto usb_device = udev_device_get_parent_with_subsystem_devtype(handle, "usb", "usb_device");
+                    if (usb_device) {
+                        const quint16 vendor_id = QString::fromLocal8Bit(udev_device_get_sysattr_value(usb_device, "idVendor")).toUInt(nullptr, 16);
+                        const quint16 product_id = QString::fromLocal8Bit(udev_device_get_sysattr_value(usb_device, "idProduct")).toUInt(nullptr, 16);
+                        if (!FilterVendorAndProduct(vendor_id, product_id)) {
+                            addPort(QSerialPortInfo(QString::fromLocal8Bit(udev_device_get_sysname(handle))));
+                        }
+                    }
+                } else if (strcmp(action, "remove") == 0) {
+                    removePort(QString::fromLocal8Bit(devnode));
+                }
+            }
+            udev_device_unref(handle);
+        });
+        m_timer->setSingleShot(true);
+        connect(m_timer, &QTimer::timeout, this, &JadeDeviceSerialPortDiscoveryAgent::retryFailedLocations);
+        for (const auto& info : QSerialPortInfo::availablePorts()) {
+            if (!FilterSerialPort(info)) addPort(info);
         }
+        return;
+    }
+    qDebug() << "jade: udev monitor unavailable, polling serial ports";
+#endif
+    connect(m_timer, &QTimer::timeout, this, &JadeDeviceSerialPortDiscoveryAgent::scan);
+    m_timer->start(2000);
+}
+
+JadeDeviceSerialPortDiscoveryAgent::~JadeDeviceSerialPortDiscoveryAgent()
+{
+#ifdef Q_OS_LINUX
+    if (m_monitor) udev_monitor_unref(m_monitor);
+    if (m_udev) udev_unref(m_udev);
+#endif
+}
+
+void JadeDeviceSerialPortDiscoveryAgent::scan()
+{
+    auto devices = m_devices;
+    m_devices.clear();
 
-        auto failed_locations = m_failed_locations;
+    if (m_reset_countdown == 0) {
         m_failed_locations.clear();
+        m_reset_countdown = 0;
+    } else {
+        --m_reset_countdown;
+    }
+
+    auto failed_locations = m_failed_locations;
+    m_failed_locations.clear();
+
+    for (const auto &info : QSerialPortInfo::availablePorts()) {
+        const auto system_location = info.systemLocation();
+        if (failed_locations.contains(system_location)) {
+            m_failed_locations.insert(system_location);
+            continue;
+        }
 
-        for (const auto &info : QSerialPortInfo::availablePorts()) {
-            const auto system_location = info.systemLocation();
-            if (failed_locations.contains(system_location)) {
-                m_failed_locations.insert(system_location);
-                continue;
-            }
+        if (FilterSerialPort(info)) continue;
 
-            if (FilterSerialPort(info)) continue;
-
-            auto device = devices.take(system_location);
-            if (!device) {
-                auto api = new JadeAPI(info);
-                device = new JadeDevice(api, system_location, this);
-                api->setParent(device);
-                connect(api, &JadeAPI::onConnected, this, [this, device] {
-                    device->api()->getVersionInfo([=](const QVariantMap& data) {
-                        if (data.contains("error")) {
-                            m_devices.remove(device->systemLocation());
-                            m_failed_locations.insert(device->systemLocation());
-                            delete device;
-                            return;
-                        }
-                        const auto result = data.value("result").toMap();
-                        device->setVersionInfo(result);
-                        DeviceManager::instance()->addDevice(device);
-                        connect(device, &JadeDevice::error, [=] {
-                            if (m_devices.take(device->systemLocation())) {
-                                DeviceManager::instance()->removeDevice(device);
-                                delete device;
-                            }
-                        });
-                    });
-                });
-                connect(api, &JadeAPI::onOpenError, this, [this, device] {
-                    m_failed_locations.insert(device->systemLocation());
-                });
-                connect(api, &JadeAPI::onDisconnected, this, [this, device] {
-                    if (m_devices.take(device->systemLocation())) {
-                        DeviceManager::instance()->removeDevice(device);
-                        delete device;
-                    }
-                });
-                m_devices.insert(system_location, device);
-                api->connectDevice();
-            } else if (device->api()->isConnected()) {
-                m_devices.insert(system_location, device);
-            } else {
-                devices.insert(system_location, device);
-            }
+        auto device = devices.take(system_location);
+        if (!device) {
+            addPort(info);
+        } else if (device->api()->isConnected()) {
+            m_devices.insert(system_location, device);
+        } else {
+            devices.insert(system_location, device);
         }
+    }
+
+    if (devices.empty()) return;
 
-        if (devices.empty()) return;
+    while (!devices.empty()) {
+        const auto system_location = devices.firstKey();
+        auto device = devices.take(system_location);
+        DeviceManager::instance()->removeDevice(device);
+        device->api()->disconnectDevice();
+        delete device;
+    }
+}
 
-        while (!devices.empty()) {
-            const auto system_location = devices.firstKey();
-            auto device = devices.take(system_location);
+void JadeDeviceSerialPortDiscoveryAgent::addPort(const QSerialPortInfo& info)
+{
+    const auto system_location = info.systemLocation();
+    if (system_location.isEmpty() || m_devices.contains(system_location)) return;
+
+    auto api = new JadeAPI(info);
+    auto device = new JadeDevice(api, system_location, this);
+    api->setParent(device);
+    connect(api, &JadeAPI::onConnected, this, [this, device] {
+        device->api()->getVersionInfo([=](const QVariantMap& data) {
+            if (data.contains("error")) {
+                m_devices.remove(device->systemLocation());
+                m_failed_locations.insert(device->systemLocation());
+#ifdef Q_OS_LINUX
+                scheduleRetry();
+#endif
+                delete device;
+                return;
+            }
+            const auto result = data.value("result").toMap();
+            device->setVersionInfo(result);
+#ifdef Q_OS_LINUX
+            m_retry_interval = 0;
+#endif
+            DeviceManager::instance()->addDevice(device);
+            connect(device, &JadeDevice::error, [=] {
+                if (m_devices.take(device->systemLocation())) {
+                    DeviceManager::instance()->removeDevice(device);
+                    delete device;
+                }
+            });
+        });
+    });
+    connect(api, &JadeAPI::onOpenError, this, [this, device] {
+        m_failed_locations.insert(device->systemLocation());
+#ifdef Q_OS_LINUX
+        // there's no polling to clean up, drop the device and retry later
+        if (m_devices.take(device->systemLocation())) device->deleteLater();
+        scheduleRetry();
+#endif
+    });
+    connect(api, &JadeAPI::onDisconnected, this, [this, device] {
+        if (m_devices.take(device->systemLocation())) {
             DeviceManager::instance()->removeDevice(device);
-            device->api()->disconnectDevice();
             delete device;
         }
     });
-    timer->start(2000);
+    m_devices.insert(system_location, device);
+    api->connectDevice();
+}
+
+#ifdef GREEN_MOCK_GDK
+void JadeDeviceSerialPortDiscoveryAgent::addEmulator()
+{
+    // the emulator isn't a serial port, keep it out of m_devices so that
+    // scanning doesn't drop it
+    auto api = new JadeAPI(new JadeEmulatorImpl);
+    auto device = new JadeDevice(api, QStringLiteral("emulator"), this);
+    api->setParent(device);
+    connect(api, &JadeAPI::onConnected, this, [device] {
+        device->api()->getVersionInfo([device](const QVariantMap& data) {
+            if (data.contains("error")) {
+                qWarning() << "jade emulator: failed to get version info" << data.value("error");
+                device->deleteLater();
+                return;
+            }
+            device->setVersionInfo(data.value("result").toMap());
+            DeviceManager::instance()->addDevice(device);
+        });
+    });
+    api->connectDevice();
+}
+#endif
+
+void JadeDeviceSerialPortDiscoveryAgent::removePort(const QString& system_location)
+{
+    m_failed_locations.remove(system_location);
+    auto device = m_devices.take(system_location);
+    if (!device) return;
+    DeviceManager::instance()->removeDevice(device);
+    device->api()->disconnectDevice();
+    delete device;
+}
+
+#ifdef Q_OS_LINUX
+void JadeDeviceSerialPortDiscoveryAgent::scheduleRetry()
+{
+    // ports that failed to open or answer are retried with backoff, there's no
+    // udev event when they become usable (e.g. after a permission change)
+    if (m_timer->isActive()) return;
+    m_retry_interval = qBound(2000, m_retry_interval * 2, 60000);
+    m_timer->start(m_retry_interval);
+}
+
+void JadeDeviceSerialPortDiscoveryAgent::retryFailedLocations()
+{
+    const auto failed_locations = m_failed_locations;
+    m_failed_locations.clear();
+    for (const auto& info : QSerialPortInfo::availablePorts()) {
+        if (failed_locations.contains(info.systemLocation())) addPort(info);
+    }
 }
+#endif
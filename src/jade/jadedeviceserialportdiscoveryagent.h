@@ -6,6 +6,13 @@
 #include <QSet>
 
 QT_FORWARD_DECLARE_CLASS(JadeDevice)
+QT_FORWARD_DECLARE_CLASS(QSerialPortInfo)
+QT_FORWARD_DECLARE_CLASS(QTimer)
+
+#ifdef Q_OS_LINUX
+struct udev;
+struct udev_monitor;
+#endif
 
 class JadeDeviceSerialPortDiscoveryAgent : public QObject
 {
@@ -13,10 +20,25 @@ class JadeDeviceSerialPortDiscoveryAgent : public QObject
     QML_ELEMENT
 public:
     explicit JadeDeviceSerialPortDiscoveryAgent(QObject* parent = nullptr);
+    ~JadeDeviceSerialPortDiscoveryAgent();
 private:
+    void scan();
+    void addPort(const QSerialPortInfo& info);
+    void removePort(const QString& system_location);
+#ifdef GREEN_MOCK_GDK
+    void addEmulator();
+#endif
     QMap<QString, JadeDevice*> m_devices;
     QSet<QString> m_failed_locations;
     int m_reset_countdown{0};
+    QTimer* m_timer;
+#ifdef Q_OS_LINUX
+    void scheduleRetry();
+    void retryFailedLocations();
+    udev* m_udev{nullptr};
+    udev_monitor* m_monitor{nullptr};
+    int m_retry_interval{0};
+#endif
 };
 
 #endif // GREEN_JADEDEVICESERIALPORTDISCOVERYAGENT_H
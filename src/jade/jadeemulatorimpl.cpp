@@ -0,0 +1,261 @@
+#include <QCryptographicHash>
+#include <QTimer>
+
+#include "jadeemulatorimpl.h"
+
+#include <wally_bip32.h>
+
+namespace {
+
+// Jade rpc error codes
+const int CBOR_RPC_INVALID_REQUEST = -32600;
+const int CBOR_RPC_UNKNOWN_METHOD = -32601;
+const int CBOR_RPC_BAD_PARAMETERS = -32602;
+
+QCborMap Result(const QCborValue& result)
+{
+    return {{ QStringLiteral("result"), result }};
+}
+
+QCborMap Error(int code, const QString& message)
+{
+    const QCborMap error = {{ QStringLiteral("code"), code }, { QStringLiteral("message"), message }};
+    return {{ QStringLiteral("error"), error }};
+}
+
+// Asks the host to post data to the pinserver and to pass the body of the
+// reply to the on_reply method
+QCborMap HttpRequest(const QString& url, const QCborMap& data, const QString& on_reply)
+{
+    const QCborMap params = {
+        { QStringLiteral("urls"), QCborArray{ url } },
+        { QStringLiteral("method"), QStringLiteral("POST") },
+        { QStringLiteral("accept"), QStringLiteral("json") },
+        { QStringLiteral("data"), data }
+    };
+    const QCborMap http_request = {{ QStringLiteral("params"), params }, { QStringLiteral("on-reply"), on_reply }};
+    return Result(QCborMap{{ QStringLiteral("http_request"), http_request }});
+}
+
+} // namespace
+
+JadeEmulatorImpl::JadeEmulatorImpl(QObject *parent)
+    : JadeConnection(parent),
+      m_latency(qEnvironmentVariableIntValue("GREEN_JADE_EMULATOR_LATENCY")),
+      m_bandwidth(qEnvironmentVariableIntValue("GREEN_JADE_EMULATOR_BANDWIDTH")),
+      m_state(qEnvironmentVariable("GREEN_JADE_EMULATOR_STATE", "READY")),
+      m_pinserver_url(qEnvironmentVariable("GREEN_JADE_EMULATOR_PINSERVER")),
+      m_seed(QCryptographicHash::hash("green jade emulator", QCryptographicHash::Sha512))
+{
+    if (!qEnvironmentVariableIsSet("GREEN_JADE_EMULATOR_LATENCY")) m_latency = 5;
+    m_clock.start();
+}
+
+JadeEmulatorImpl::~JadeEmulatorImpl()
+{
+    disconnectDevice();
+}
+
+// Manage connection
+bool JadeEmulatorImpl::isConnectedImpl()
+{
+    return m_connected;
+}
+
+void JadeEmulatorImpl::connectDeviceImpl()
+{
+    if (m_connected) return;
+    m_connected = true;
+    m_link_free_at = 0;
+    m_device_free_at = 0;
+    m_reply_free_at = 0;
+    QTimer::singleShot(m_latency, this, [this] {
+        if (m_connected) emit onConnected();
+    });
+}
+
+void JadeEmulatorImpl::disconnectDeviceImpl()
+{
+    if (!m_connected) return;
+    m_connected = false;
+    emit onDisconnected();
+}
+
+int JadeEmulatorImpl::writeImpl(const QByteArray &data)
+{
+    Q_ASSERT(isConnected());
+
+    QCborParserError err;
+    const QCborValue cbor = QCborValue::fromCbor(data, &err);
+    const QCborMap request = cbor.toMap();
+    const QString id = request.value(QStringLiteral("id")).toString();
+
+    QCborMap reply;
+    if (err.error != QCborError::NoError || !cbor.isMap() || id.isEmpty()) {
+        reply = Error(CBOR_RPC_INVALID_REQUEST, QStringLiteral("invalid request"));
+    } else {
+        const QString method = request.value(QStringLiteral("method")).toString();
+        reply = handleRequest(method, request.value(QStringLiteral("params")));
+    }
+    reply.insert(QStringLiteral("id"), id);
+    const QByteArray bytes = reply.toCborValue().toCbor();
+
+    // The request crosses the link, waits for the device to handle the
+    // previous ones and the reply crosses back, replies keep request order
+    const qint64 now = m_clock.elapsed();
+    const qint64 request_time = m_bandwidth > 0 ? data.size() * 1000 / m_bandwidth : 0;
+    const qint64 reply_time = m_bandwidth > 0 ? bytes.size() * 1000 / m_bandwidth : 0;
+    m_link_free_at = qMax(now, m_link_free_at) + request_time;
+    m_device_free_at = qMax(m_link_free_at, m_device_free_at) + m_latency;
+    m_reply_free_at = qMax(m_device_free_at, m_reply_free_at) + reply_time;
+    QTimer::singleShot(m_reply_free_at - now, this, [this, bytes] {
+        if (m_connected) onDataReceived(bytes);
+    });
+
+    return data.size();
+}
+
+QCborMap JadeEmulatorImpl::handleRequest(const QString& method, const QCborValue& value)
+{
+    const QCborMap params = value.toMap();
+    if (method == "get_version_info") {
+        return Result(versionInfo());
+    }
+    if (method == "add_entropy") {
+        return Result(true);
+    }
+    if (method == "auth_user") {
+        if (m_pinserver_url.isEmpty()) {
+            // no pinserver round trip, the emulator unlocks right away
+            m_state = QStringLiteral("READY");
+            return Result(true);
+        }
+        return HttpRequest(m_pinserver_url + "/start_handshake", {}, QStringLiteral("handshake_init"));
+    }
+    if (method == "handshake_init") {
+        const auto ske = params.value(QStringLiteral("ske")).toString().toUtf8();
+        if (ske.isEmpty()) return Error(CBOR_RPC_BAD_PARAMETERS, QStringLiteral("invalid handshake"));
+        const QCborMap data = {
+            { QStringLiteral("cke"), QString::fromLatin1(placeholder("cke", ske, 33).toHex()) },
+            { QStringLiteral("encrypted_data"), QString::fromLatin1(placeholder("encrypted data", ske, 64).toHex()) },
+            { QStringLiteral("hmac_encrypted_data"), QString::fromLatin1(placeholder("hmac", ske, 32).toHex()) }
+        };
+        return HttpRequest(m_pinserver_url + "/get_pin", data, QStringLiteral("handshake_complete"));
+    }
+    if (method == "handshake_complete") {
+        if (params.value(QStringLiteral("encrypted_key")).toString().isEmpty()) {
+            return Error(CBOR_RPC_BAD_PARAMETERS, QStringLiteral("invalid pin"));
+        }
+        m_state = QStringLiteral("READY");
+        return Result(true);
+    }
+    if (method == "get_xpub") {
+        const auto xpub = this->xpub(params.value(QStringLiteral("network")).toString(), params.value(QStringLiteral("path")).toArray());
+        if (xpub.isEmpty()) return Error(CBOR_RPC_BAD_PARAMETERS, QStringLiteral("invalid path"));
+        return Result(xpub);
+    }
+    if (method == "sign_message") {
+        m_signing_message = true;
+        return Result(placeholder("commitment", params.value(QStringLiteral("message")).toString().toUtf8(), 33));
+    }
+    if (method == "sign_tx" || method == "sign_liquid_tx") {
+        m_signing_message = false;
+        return Result(true);
+    }
+    if (method == "tx_input") {
+        return Result(placeholder("commitment", params.value(QStringLiteral("ae_host_commitment")).toByteArray(), 33));
+    }
+    if (method == "get_signature") {
+        const auto signature = placeholder("signature", params.value(QStringLiteral("ae_host_entropy")).toByteArray(), 64);
+        if (m_signing_message) return Result(QString::fromLatin1(signature.toBase64()));
+        return Result(QByteArray::fromHex("3044") + signature);
+    }
+    if (method == "get_master_blinding_key") {
+        return Result(placeholder("master blinding key", {}, 32));
+    }
+    if (method == "get_blinding_key") {
+        return Result(placeholder("blinding key", params.value(QStringLiteral("script")).toByteArray(), 33));
+    }
+    if (method == "get_shared_nonce") {
+        return Result(placeholder("shared nonce", params.value(QStringLiteral("their_pubkey")).toByteArray(), 32));
+    }
+    if (method == "get_blinding_factor") {
+        const auto data = params.value(QStringLiteral("hash_prevouts")).toByteArray() + QByteArray::number(params.value(QStringLiteral("output_index")).toInteger()) + params.value(QStringLiteral("type")).toString().toUtf8();
+        return Result(placeholder("blinding factor", data, 32));
+    }
+    if (method == "get_commitments") {
+        const auto data = params.value(QStringLiteral("hash_prevouts")).toByteArray() + QByteArray::number(params.value(QStringLiteral("output_index")).toInteger());
+        const auto asset_id = params.value(QStringLiteral("asset_id")).toByteArray();
+        const auto abf = placeholder("abf", data, 32);
+        const auto vbf = params.contains(QStringLiteral("vbf")) ? params.value(QStringLiteral("vbf")).toByteArray() : placeholder("vbf", data, 32);
+        return Result(QCborMap{
+            { QStringLiteral("asset_id"), asset_id },
+            { QStringLiteral("value"), params.value(QStringLiteral("value")) },
+            { QStringLiteral("abf"), abf },
+            { QStringLiteral("vbf"), vbf },
+            { QStringLiteral("asset_generator"), placeholder("asset generator", asset_id + abf, 33) },
+            { QStringLiteral("value_commitment"), placeholder("value commitment", vbf, 33) },
+            { QStringLiteral("hmac"), placeholder("hmac", data, 32) }
+        });
+    }
+    if (method == "ota") {
+        m_ota_remaining = params.value(QStringLiteral("cmpsize")).toInteger();
+        return Result(true);
+    }
+    if (method == "ota_data") {
+        m_ota_remaining -= value.toByteArray().size();
+        if (m_ota_remaining < 0) return Error(CBOR_RPC_BAD_PARAMETERS, QStringLiteral("unexpected ota data"));
+        return Result(true);
+    }
+    if (method == "ota_complete") {
+        if (m_ota_remaining != 0) return Error(CBOR_RPC_BAD_PARAMETERS, QStringLiteral("incomplete ota"));
+        return Result(true);
+    }
+    return Error(CBOR_RPC_UNKNOWN_METHOD, QStringLiteral("unsupported method %1").arg(method));
+}
+
+QCborMap JadeEmulatorImpl::versionInfo() const
+{
+    return {
+        { QStringLiteral("JADE_VERSION"), QStringLiteral("0.1.48") },
+        { QStringLiteral("JADE_OTA_MAX_CHUNK"), 4096 },
+        { QStringLiteral("JADE_CONFIG"), QStringLiteral("BLE") },
+        { QStringLiteral("BOARD_TYPE"), QStringLiteral("JADE") },
+        { QStringLiteral("JADE_FEATURES"), QStringLiteral("SB") },
+        { QStringLiteral("IDF_VERSION"), QStringLiteral("v4.4.4") },
+        { QStringLiteral("CHIP_FEATURES"), QStringLiteral("32000000") },
+        { QStringLiteral("EFUSEMAC"), QStringLiteral("000000E3E3E3") },
+        { QStringLiteral("BATTERY_STATUS"), 5 },
+        { QStringLiteral("JADE_STATE"), m_state },
+        { QStringLiteral("JADE_NETWORKS"), QStringLiteral("ALL") },
+        { QStringLiteral("JADE_HAS_PIN"), m_state != "UNINIT" }
+    };
+}
+
+QString JadeEmulatorImpl::xpub(const QString& network, const QCborArray& path) const
+{
+    const bool mainnet = network == "mainnet" || network == "liquid";
+    QVector<uint32_t> child_path;
+    for (const auto& value : path) child_path.append(value.toInteger());
+
+    ext_key root, key;
+    int rc = bip32_key_from_seed(reinterpret_cast<const unsigned char*>(m_seed.constData()), BIP32_ENTROPY_LEN_512, mainnet ? BIP32_VER_MAIN_PRIVATE : BIP32_VER_TEST_PRIVATE, 0, &root);
+    if (rc != WALLY_OK) return {};
+    rc = bip32_key_from_parent_path(&root, child_path.constData(), child_path.size(), BIP32_FLAG_KEY_PRIVATE, &key);
+    if (rc != WALLY_OK) return {};
+    char* base58;
+    rc = bip32_key_to_base58(&key, BIP32_FLAG_KEY_PUBLIC, &base58);
+    if (rc != WALLY_OK) return {};
+    const QString xpub = QString::fromLatin1(base58);
+    wally_free_string(base58);
+    return xpub;
+}
+
+QByteArray JadeEmulatorImpl::placeholder(const char* tag, const QByteArray& data, int size) const
+{
+    QCryptographicHash hash(QCryptographicHash::Sha512);
+    hash.addData(tag);
+    hash.addData(m_seed);
+    hash.addData(data);
+    return hash.result().left(size);
+}
@@ -0,0 +1,62 @@
+#ifndef JADEEMULATORIMPL_H
+#define JADEEMULATORIMPL_H
+
+#include "jadeconnection.h"
+
+#include <QCborArray>
+#include <QCborMap>
+#include <QElapsedTimer>
+
+// In-process Jade used to exercise JadeAPI and the jade activities without
+// hardware. Replies are deterministic, derived from a fixed seed. Requests
+// and replies take the transfer time of the link in each direction and the
+// device handles one message at a time, so transfers overlap the handling of
+// the previous message:
+//   GREEN_JADE_EMULATOR_LATENCY    per message handling time in ms (default 5)
+//   GREEN_JADE_EMULATOR_BANDWIDTH  link speed in bytes/s, 0 is unlimited (default 0)
+//   GREEN_JADE_EMULATOR_STATE      initial JADE_STATE (default READY)
+//   GREEN_JADE_EMULATOR_PINSERVER  pinserver url, auth_user then makes the
+//                                  start_handshake and get_pin requests,
+//                                  otherwise it unlocks right away
+// Signatures and blinding data are placeholders, they don't commit to the
+// real transaction and must not be broadcast.
+class JadeEmulatorImpl : public JadeConnection
+{
+    Q_OBJECT
+public:
+    explicit JadeEmulatorImpl(QObject *parent = nullptr);
+    ~JadeEmulatorImpl();
+    void setPinServerUrl(const QString& url) { m_pinserver_url = url; }
+
+private:
+    // Manage connection
+    bool isConnectedImpl();
+    void connectDeviceImpl();
+    void disconnectDeviceImpl();
+
+    // Handles the request and schedules the reply
+    int writeImpl(const QByteArray& data);
+
+    // Returns the reply with either result or error set
+    QCborMap handleRequest(const QString& method, const QCborValue& params);
+    QCborMap versionInfo() const;
+    QString xpub(const QString& network, const QCborArray& path) const;
+    QByteArray placeholder(const char* tag, const QByteArray& data, int size) const;
+
+    bool m_connected{false};
+    int m_latency;
+    int m_bandwidth;
+    QString m_state;
+    QString m_pinserver_url;
+    QByteArray m_seed;
+    // Times at which each direction of the link and the device are free
+    // again, replies are delivered in order
+    QElapsedTimer m_clock;
+    qint64 m_link_free_at{0};
+    qint64 m_device_free_at{0};
+    qint64 m_reply_free_at{0};
+    qint64 m_ota_remaining{0};
+    bool m_signing_message{false};
+};
+
+#endif // JADEEMULATORIMPL_H
@@ -0,0 +1,129 @@
+#include "jadefirmwarecache.h"
+#include "util.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QSet>
+
+namespace {
+
+const qint64 INDEX_TTL = 60 * 60 * 1000;
+const int MAX_FIRMWARES = 4;
+
+QString IndexFile()
+{
+    return GetDataFile("firmware", "index.json");
+}
+
+QString FirmwareFile(const QString& hash)
+{
+    return GetDataFile("firmware", hash + ".bin");
+}
+
+QString Hash(const QByteArray& data)
+{
+    return QString::fromLocal8Bit(QCryptographicHash::hash(data, QCryptographicHash::Sha256).toHex());
+}
+
+} // namespace
+
+JadeFirmwareCache* JadeFirmwareCache::instance()
+{
+    static JadeFirmwareCache cache;
+    return &cache;
+}
+
+JadeFirmwareCache::JadeFirmwareCache()
+{
+    QFile file(IndexFile());
+    if (file.open(QFile::ReadOnly)) {
+        const auto data = QJsonDocument::fromJson(file.readAll()).object();
+        m_indexes = data.value("indexes").toObject();
+        m_firmwares = data.value("firmwares").toObject();
+    }
+}
+
+bool JadeFirmwareCache::index(const QString& path, QString& body)
+{
+    const auto index = m_indexes.value(path).toObject();
+    if (index.isEmpty()) return false;
+    const auto timestamp = qint64(index.value("timestamp").toDouble());
+    const auto age = QDateTime::currentMSecsSinceEpoch() - timestamp;
+    if (age < 0 || age > INDEX_TTL) return false;
+    body = index.value("body").toString();
+    return true;
+}
+
+void JadeFirmwareCache::insertIndex(const QString& path, const QString& body)
+{
+    m_indexes.insert(path, QJsonObject{
+        { "body", body },
+        { "timestamp", double(QDateTime::currentMSecsSinceEpoch()) }
+    });
+    save();
+}
+
+QByteArray JadeFirmwareCache::firmware(const QString& path, QString& hash)
+{
+    hash = m_firmwares.value(path).toObject().value("hash").toString();
+    if (hash.isEmpty()) return {};
+    QFile file(FirmwareFile(hash));
+    if (!file.open(QFile::ReadOnly)) return {};
+    const auto data = file.readAll();
+    // the file name is the content hash, discard corrupted entries
+    if (Hash(data) != hash) {
+        file.remove();
+        m_firmwares.remove(path);
+        save();
+        return {};
+    }
+    return data;
+}
+
+QString JadeFirmwareCache::insertFirmware(const QString& path, const QByteArray& data)
+{
+    const auto hash = Hash(data);
+    if (!QFile::exists(FirmwareFile(hash))) {
+        QSaveFile file(FirmwareFile(hash));
+        if (!file.open(QFile::WriteOnly) || file.write(data) != data.size() || !file.commit()) return hash;
+    }
+    m_firmwares.insert(path, QJsonObject{
+        { "hash", hash },
+        { "timestamp", double(QDateTime::currentMSecsSinceEpoch()) }
+    });
+
+    // keep the most recent downloads and drop unreferenced binaries
+    while (m_firmwares.size() > MAX_FIRMWARES) {
+        auto oldest = m_firmwares.begin();
+        for (auto i = m_firmwares.begin(); i != m_firmwares.end(); ++i) {
+            if (i.value().toObject().value("timestamp").toDouble() < oldest.value().toObject().value("timestamp").toDouble()) oldest = i;
+        }
+        m_firmwares.erase(oldest);
+    }
+    QSet<QString> hashes;
+    for (const auto& value : m_firmwares) hashes.insert(value.toObject().value("hash").toString());
+    QDir dir(GetDataDir("firmware"));
+    for (const auto& name : dir.entryList({ "*.bin" }, QDir::Files)) {
+        if (!hashes.contains(name.chopped(4))) dir.remove(name);
+    }
+
+    save();
+    return hash;
+}
+
+void JadeFirmwareCache::save()
+{
+    const QJsonObject data{
+        { "indexes", m_indexes },
+        { "firmwares", m_firmwares }
+    };
+    QSaveFile file(IndexFile());
+    if (file.open(QFile::WriteOnly)) {
+        file.write(QJsonDocument(data).toJson(QJsonDocument::Compact));
+        file.commit();
+    }
+}
@@ -0,0 +1,27 @@
+#ifndef GREEN_JADEFIRMWARECACHE_H
+#define GREEN_JADEFIRMWARECACHE_H
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QString>
+
+// On-disk cache of Jade firmware channel indexes and binaries. Binaries are
+// stored by their SHA256 and looked up by server path, so every Jade that
+// needs the same firmware reuses a single download. Channel indexes are
+// served from the cache while younger than a short TTL.
+class JadeFirmwareCache
+{
+public:
+    static JadeFirmwareCache* instance();
+    bool index(const QString& path, QString& body);
+    void insertIndex(const QString& path, const QString& body);
+    QByteArray firmware(const QString& path, QString& hash);
+    QString insertFirmware(const QString& path, const QByteArray& data);
+private:
+    JadeFirmwareCache();
+    void save();
+    QJsonObject m_indexes;
+    QJsonObject m_firmwares;
+};
+
+#endif // GREEN_JADEFIRMWARECACHE_H
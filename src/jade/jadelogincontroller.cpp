@@ -1,10 +1,12 @@
 #include "activitymanager.h"
+#include "gdkrecorder.h"
 #include "handlers/connecthandler.h"
 #include "handlers/loginhandler.h"
 #include "handlers/registeruserhandler.h"
 #include "jadeapi.h"
 #include "jadedevice.h"
 #include "jadelogincontroller.h"
+#include "jadeupdatecontroller.h"
 #include "json.h"
 #include "network.h"
 #include "networkmanager.h"
@@ -148,20 +150,17 @@ void JadeLoginController::unlock()
     auto network = NetworkManager::instance()->network(m_network);
 
     m_device->api()->authUser(network->canonicalId(), [=](const QVariantMap& msg) {
-        Q_ASSERT(msg.contains("result"));
-        if (msg["result"] == true) {
+        if (msg.contains("error")) {
+            qDebug() << "unlock failed" << msg.value("error");
+            update();
+        } else if (msg.value("result") == true) {
             m_device->updateVersionInfo();
         } else {
             emit invalidPin();
             update();
         }
     }, [=](JadeAPI& jade, int id, const QJsonObject& req) {
-        const auto params = Json::fromObject(req.value("params").toObject());
-        GA_json* output;
-        GA_http_request(m_session->m_session, params.get(), &output);
-        auto res = Json::toObject(output);
-        GA_destroy_json(output);
-        jade.handleHttpResponse(id, req, res.value("body").toObject());
+        ActivityManager::instance()->exec(new JadePinServerRequestActivity(&jade, id, req, m_session, this));
     });
 }
 
@@ -187,7 +186,7 @@ void JadeLoginController::identify()
         const auto net_params = Json::fromObject({{ "name", m_network }});
         const auto params = Json::fromObject({{ "master_xpub", QString::fromLocal8Bit(master_xpub) }});
         GA_json* output;
-        int rc = GA_get_wallet_identifier(net_params.get(), params.get(), &output);
+        int rc = GDK_CALL(GA_get_wallet_identifier, net_params.get(), params.get(), &output);
         Q_ASSERT(rc == GA_OK);
         const auto identifier = Json::toObject(output);
         GA_destroy_json(output);
@@ -0,0 +1,97 @@
+#ifndef JADEREQUESTWRITER_H
+#define JADEREQUESTWRITER_H
+
+#include <QByteArray>
+#include <QCborStreamWriter>
+#include <QCborValue>
+#include <QString>
+#include <QVariant>
+#include <QVector>
+
+// Encodes a jade request straight into the given (reused) buffer, without
+// building intermediate QCborMap/QVariant trees. The number of params must
+// be known upfront since maps are written with definite length.
+class JadeRequestWriter
+{
+public:
+    JadeRequestWriter(QByteArray* buffer, const int id, const char* method)
+        : m_writer(reset(buffer))
+    {
+        begin(id, method, 2);
+    }
+    JadeRequestWriter(QByteArray* buffer, const int id, const char* method, const int params)
+        : m_writer(reset(buffer))
+    {
+        begin(id, method, 3);
+        m_writer.append(QLatin1String("params"));
+        m_writer.startMap(params);
+        m_params = true;
+    }
+    // Request where params is a single binary value (ie. ota_data)
+    JadeRequestWriter(QByteArray* buffer, const int id, const char* method, const QByteArray& params)
+        : m_writer(reset(buffer))
+    {
+        begin(id, method, 3);
+        m_writer.append(QLatin1String("params"));
+        m_writer.append(params);
+    }
+    ~JadeRequestWriter()
+    {
+        if (m_params) m_writer.endMap();
+        m_writer.endMap();
+    }
+    void appendString(const char* key, const QString& value)
+    {
+        m_writer.append(QLatin1String(key));
+        m_writer.append(value);
+    }
+    void appendBytes(const char* key, const QByteArray& value)
+    {
+        m_writer.append(QLatin1String(key));
+        m_writer.append(value);
+    }
+    void appendInteger(const char* key, const qint64 value)
+    {
+        m_writer.append(QLatin1String(key));
+        m_writer.append(value);
+    }
+    void appendBool(const char* key, const bool value)
+    {
+        m_writer.append(QLatin1String(key));
+        m_writer.append(value);
+    }
+    void appendPath(const char* key, const QVector<quint32>& path)
+    {
+        m_writer.append(QLatin1String(key));
+        m_writer.startArray(path.size());
+        for (const quint32 val : path) {
+            m_writer.append(quint64(val));
+        }
+        m_writer.endArray();
+    }
+    // Fallback for small nested structures (ie. change and commitments lists)
+    void appendValue(const QString& key, const QVariant& value)
+    {
+        m_writer.append(key);
+        QCborValue::fromVariant(value).toCbor(m_writer);
+    }
+private:
+    static QByteArray* reset(QByteArray* buffer)
+    {
+        // keeps the reserved capacity
+        buffer->resize(0);
+        return buffer;
+    }
+    void begin(const int id, const char* method, const int fields)
+    {
+        m_writer.startMap(fields);
+        m_writer.append(QLatin1String("id"));
+        m_writer.append(QString::number(id));
+        m_writer.append(QLatin1String("method"));
+        m_writer.append(QLatin1String(method));
+    }
+    QCborStreamWriter m_writer;
+    bool m_params{false};
+};
+
+#endif // JADEREQUESTWRITER_H
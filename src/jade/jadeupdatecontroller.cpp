@@ -2,6 +2,7 @@
 #include "httpmanager.h"
 #include "jadeupdatecontroller.h"
 #include "jadedevice.h"
+#include "jadefirmwarecache.h"
 #include "network.h"
 #include "networkmanager.h"
 #include "semver.h"
@@ -11,6 +12,7 @@
 
 #include <QCryptographicHash>
 #include <QFile>
+#include <QPointer>
 
 #include <gdk.h>
 
@@ -31,6 +33,27 @@ static const QString JADE_BOARD_TYPE_JADE = "JADE";
 static const QString JADE_BOARD_TYPE_JADE_V1_1 = "JADE_V1.1";
 static const QString JADE_FEATURE_SECURE_BOOT = "SB";
 
+// in seconds, leaves room for slow Tor circuits
+static const int JADE_PINSERVER_TIMEOUT = 30;
+
+QVariantList ParseFirmwares(const QString& base, const QString& body)
+{
+    QVariantList firmwares;
+    for (const auto& line : body.split('\n')) {
+        const auto parts = line.split('_');
+        if (parts.size() == 4 && parts.last() == JADE_FW_SUFFIX) {
+            const auto version = parts[0];
+            QVariantMap firmware;
+            firmware.insert("path", base + line);
+            firmware.insert("version", version);
+            firmware.insert("config", parts[1]);
+            firmware.insert("size", parts[2].toLongLong());
+            firmwares.append(firmware);
+        }
+    }
+    return firmwares;
+}
+
 } // namespace
 
 JadeHttpRequestActivity::JadeHttpRequestActivity(const QString& path, QObject* parent)
@@ -50,20 +73,7 @@ JadeChannelRequestActivity::JadeChannelRequestActivity(const QString& base, cons
 
 QVariantList JadeChannelRequestActivity::firmwares() const
 {
-    QVariantList firmwares;
-    for (const auto& line : body().split('\n')) {
-        const auto parts = line.split('_');
-        if (parts.size() == 4 && parts.last() == JADE_FW_SUFFIX) {
-            const auto version = parts[0];
-            QVariantMap firmware;
-            firmware.insert("path", m_base + line);
-            firmware.insert("version", version);
-            firmware.insert("config", parts[1]);
-            firmware.insert("size", parts[2].toLongLong());
-            firmwares.append(firmware);
-        }
-    }
-    return firmwares;
+    return ParseFirmwares(m_base, body());
 }
 
 JadeBinaryRequestActivity::JadeBinaryRequestActivity(const QString& path, QObject* parent)
@@ -72,6 +82,34 @@ JadeBinaryRequestActivity::JadeBinaryRequestActivity(const QString& path, QObjec
     setAccept("base64");
 }
 
+JadePinServerRequestActivity::JadePinServerRequestActivity(JadeAPI* api, int id, const QJsonObject& request, Session* session, QObject* parent)
+    : HttpRequestActivity(parent)
+{
+    const auto params = request.value("params").toObject();
+    setMethod(params.value("method").toString());
+    for (const auto url : params.value("urls").toArray()) {
+        addUrl(url.toString());
+    }
+    if (params.contains("accept")) setAccept(params.value("accept").toString());
+    if (params.contains("data")) setData(params.value("data"));
+    for (const auto root_certificate : params.value("root_certificates").toArray()) {
+        addRootCertificate(root_certificate.toString());
+    }
+    setTimeout(JADE_PINSERVER_TIMEOUT);
+    setSession(session);
+
+    QPointer<JadeAPI> jade(api);
+    connect(this, &Activity::finished, this, [=] {
+        deleteLater();
+        if (jade) jade->handleHttpResponse(id, request, response().value("body").toObject());
+    });
+    connect(this, &Activity::failed, this, [=] {
+        deleteLater();
+        // let Jade report the failure through the original request
+        if (jade) jade->handleHttpResponse(id, request, {});
+    });
+}
+
 JadeUnlockActivity::JadeUnlockActivity(JadeDevice* device, QObject* parent)
     : SessionActivity(parent)
     , m_device(device)
@@ -82,19 +120,13 @@ void JadeUnlockActivity::exec()
 {
     const auto nets = m_device->versionInfo().value("JADE_NETWORKS").toString();
     m_device->api()->authUser(nets == "TEST" ? "testnet" : "mainnet", [this](const QVariantMap& msg) {
-        Q_ASSERT(msg.contains("result"));
-        if (msg["result"] == true) {
+        if (msg.value("result") == true) {
             finish();
         } else {
             fail();
         }
     }, [=](JadeAPI& jade, int id, const QJsonObject& req) {
-        const auto params = Json::fromObject(req.value("params").toObject());
-        GA_json* output;
-        GA_http_request(session()->m_session, params.get(), &output);
-        auto res = Json::toObject(output);
-        GA_destroy_json(output);
-        jade.handleHttpResponse(id, req, res.value("body").toObject());
+        ActivityManager::instance()->exec(new JadePinServerRequestActivity(&jade, id, req, session(), this));
     });
 }
 
@@ -104,26 +136,33 @@ JadeUpdateActivity::JadeUpdateActivity(const QVariantMap& firmware, const QByteA
     , m_firmware(firmware)
     , m_data(data)
 {
-    QCryptographicHash hash(QCryptographicHash::Sha256);
-    hash.addData(m_data);
-    m_firmware.insert("hash", hash.result().toHex());
+    if (m_firmware.value("hash").toString().isEmpty()) {
+        QCryptographicHash hash(QCryptographicHash::Sha256);
+        hash.addData(m_data);
+        m_firmware.insert("hash", hash.result().toHex());
+    }
 }
 
 void JadeUpdateActivity::exec()
 {
     const auto size = m_firmware.value("size").toLongLong();
     auto chunk_size = m_device->versionInfo().value("JADE_OTA_MAX_CHUNK").toInt();
+    // one chunk at a time, sending chunks ahead of the acknowledgements is
+    // only measured against the emulator and not checked with Jade firmware
+    const int window = 1;
 #ifdef Q_OS_MACOS
     if (m_device->systemLocation().contains("cu.usbmodem")) {
         chunk_size = 256;
     }
 #endif
 
-    m_device->api()->otaUpdate(m_data, size, chunk_size, [this](const QVariantMap& result) {
+    m_device->api()->otaUpdate(m_data, size, chunk_size, window, [this](const QVariantMap& result) {
         Q_ASSERT(result.contains("uploaded"));
         const auto uploaded = result.value("uploaded").toLongLong();
+        m_uploaded = uploaded;
         progress()->setIndeterminate(uploaded <= 12288);
         progress()->setValue(double(uploaded) / double(m_data.size()));
+        setSpeed(result.value("speed").toLongLong());
     }, [this](const QVariantMap& result) {
         if (result["result"] == true) {
             finish();
@@ -147,6 +186,13 @@ void JadeUpdateActivity::exec()
     });
 }
 
+void JadeUpdateActivity::setSpeed(qlonglong speed)
+{
+    if (m_speed == speed) return;
+    m_speed = speed;
+    emit speedChanged(m_speed);
+}
+
 JadeUpdateController::JadeUpdateController(QObject *parent)
     : QObject(parent)
 {
@@ -195,33 +241,58 @@ void JadeUpdateController::check()
 
     const QString channel = m_channel.isEmpty() ? JADE_FW_VERSIONS_FILE : m_channel;
     const bool latest_channel = channel == JADE_FW_VERSIONS_FILE;
+
+    QString body;
+    if (JadeFirmwareCache::instance()->index(path + channel, body)) {
+        updateFirmwares(ParseFirmwares(path, body), config, latest_channel);
+        return;
+    }
+
     auto activity = new JadeChannelRequestActivity(path, channel, this);
     connect(activity, &Activity::finished, this, [=] {
         activity->deleteLater();
-        m_firmwares.clear();
-        for (auto data : activity->firmwares()) {
-            QVariantMap firmware = data.toMap();
-            const bool same_version = SemVer::parse(m_device->version()) == SemVer::parse(firmware.value("version").toString());
-            const bool greater_version = SemVer::parse(m_device->version()) < SemVer::parse(firmware.value("version").toString());
-            const bool same_config = config.compare(firmware.value("config").toString(), Qt::CaseInsensitive) == 0;
-            const bool installed = same_version && same_config;
-            firmware.insert("installed", installed);
-            m_firmwares.append(firmware);
-            if (latest_channel && same_config && greater_version) {
-                m_firmware_available = firmware;
-            }
-        }
-        emit firmwaresChanged(m_firmwares);
-        emit firmwareAvailableChanged();
+        const auto firmwares = activity->firmwares();
+        if (!firmwares.isEmpty()) JadeFirmwareCache::instance()->insertIndex(path + channel, activity->body());
+        updateFirmwares(firmwares, config, latest_channel);
     });
     HttpManager::instance()->exec(activity);
     emit activityCreated(activity);
 }
 
+void JadeUpdateController::updateFirmwares(const QVariantList& firmwares, const QString& config, bool latest_channel)
+{
+    m_firmwares.clear();
+    for (auto data : firmwares) {
+        QVariantMap firmware = data.toMap();
+        const bool same_version = SemVer::parse(m_device->version()) == SemVer::parse(firmware.value("version").toString());
+        const bool greater_version = SemVer::parse(m_device->version()) < SemVer::parse(firmware.value("version").toString());
+        const bool same_config = config.compare(firmware.value("config").toString(), Qt::CaseInsensitive) == 0;
+        const bool installed = same_version && same_config;
+        firmware.insert("installed", installed);
+        m_firmwares.append(firmware);
+        if (latest_channel && same_config && greater_version) {
+            m_firmware_available = firmware;
+        }
+    }
+    emit firmwaresChanged(m_firmwares);
+    emit firmwareAvailableChanged();
+}
+
 void JadeUpdateController::update(const QVariantMap& firmware)
 {
     const auto path = firmware.value("path").toString();
-    const auto data = m_firmware_data.value(path);
+    auto data = m_firmware_data.value(path);
+
+    if (data.isEmpty()) {
+        QString hash;
+        data = JadeFirmwareCache::instance()->firmware(path, hash);
+        if (!data.isEmpty()) {
+            QVariantMap cached_firmware = firmware;
+            cached_firmware.insert("hash", hash);
+            m_firmware_data.insert(path, data);
+            return update(cached_firmware);
+        }
+    }
 
     if (data.isEmpty()) {
         auto activity = new JadeBinaryRequestActivity(path, this);
@@ -232,7 +303,10 @@ void JadeUpdateController::update(const QVariantMap& firmware)
             activity->deleteLater();
             const auto data = QByteArray::fromBase64(activity->body().toLocal8Bit());
             m_firmware_data.insert(path, data);
-            update(firmware);
+            // the cache hashes the binary once, the update activity reuses it
+            QVariantMap downloaded_firmware = firmware;
+            downloaded_firmware.insert("hash", JadeFirmwareCache::instance()->insertFirmware(path, data));
+            update(downloaded_firmware);
         });
         emit activityCreated(activity);
         HttpManager::instance()->exec(activity);
@@ -7,6 +7,7 @@
 #include <QObject>
 
 QT_FORWARD_DECLARE_CLASS(Activity)
+QT_FORWARD_DECLARE_CLASS(JadeAPI)
 QT_FORWARD_DECLARE_CLASS(JadeDevice)
 
 class JadeHttpRequestActivity : public HttpRequestActivity
@@ -36,6 +37,17 @@ public:
     JadeBinaryRequestActivity(const QString& path, QObject* parent);
 };
 
+// Relays an http_request from Jade to the pinserver on a worker thread and
+// forwards the response back to Jade. Destroying the activity, or the API,
+// drops the pending response.
+class JadePinServerRequestActivity : public HttpRequestActivity
+{
+    Q_OBJECT
+    QML_ELEMENT
+public:
+    JadePinServerRequestActivity(JadeAPI* api, int id, const QJsonObject& request, Session* session, QObject* parent);
+};
+
 class JadeUnlockActivity : public SessionActivity
 {
     Q_OBJECT
@@ -55,19 +67,24 @@ class JadeUpdateActivity : public Activity
     Q_OBJECT
     Q_PROPERTY(JadeDevice* device READ device CONSTANT)
     Q_PROPERTY(QVariantMap firmware READ firmware CONSTANT)
+    Q_PROPERTY(qlonglong speed READ speed NOTIFY speedChanged)
     QML_ELEMENT
 public:
     JadeUpdateActivity(const QVariantMap& firmware, const QByteArray& data, JadeDevice* device);
     JadeDevice* device() const { return m_device; }
     QVariantMap firmware() const { return m_firmware; }
+    qlonglong speed() const { return m_speed; }
     void exec() override;
 signals:
     void locked();
+    void speedChanged(qlonglong speed);
 private:
+    void setSpeed(qlonglong speed);
     JadeDevice* const m_device;
     QVariantMap m_firmware;
     const QByteArray m_data;
     qlonglong m_uploaded{0};
+    qlonglong m_speed{0};
 };
 
 class JadeUpdateController : public QObject
@@ -101,6 +118,7 @@ protected:
     void pushActivity(Activity* activity);
     void popActivity();
 private:
+    void updateFirmwares(const QVariantList& firmwares, const QString& config, bool latest_channel);
     JadeDevice* m_device{nullptr};
     QString m_channel;
     QVariantList m_firmwares;
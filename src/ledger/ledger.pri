@@ -17,3 +17,9 @@ HEADERS += \
     $$PWD/ledgersignliquidtransactionactivity.h \
     $$PWD/ledgersignmessageactivity.h \
     $$PWD/ledgersigntransactionactivity.h
+
+# the emulator is only built for development and benchmarks
+mockgdk {
+    HEADERS += $$PWD/ledgeremulator.h
+    SOURCES += $$PWD/ledgeremulator.cpp
+}
@@ -8,6 +8,7 @@
 #include "ledgersignmessageactivity.h"
 #include "ledgersigntransactionactivity.h"
 #include "network.h"
+#include "trace.h"
 
 LedgerDevice::LedgerDevice(DevicePrivate* d, QObject* parent)
     : Device(parent)
@@ -134,6 +135,7 @@ GetFirmwareActivity::GetFirmwareActivity(LedgerDevice* device)
 
 void GetFirmwareActivity::exec()
 {
+    m_device->startSession();
     auto command = m_device->exchange(apdu(BTCHIP_CLA, BTCHIP_INS_GET_FIRMWARE_VERSION, 0x00, 0x00));
     connect(command, &Command::finished, [this, command] {
         command->deleteLater();
@@ -173,6 +175,7 @@ SemVer GetAppActivity::version() const
 
 void GetAppActivity::exec()
 {
+    m_device->startSession();
     auto command = m_device->exchange(apdu(BTCHIP_CLA_COMMON_SDK, BTCHIP_INS_GET_APP_NAME_AND_VERSION, 0x00, 0x00));
     connect(command, &Command::finished, [this, command] {
         command->deleteLater();
@@ -222,6 +225,28 @@ void LedgerDevice::setAppVersion(const QString& app_version)
     emit appVersionChanged(m_app_version);
 }
 
+QByteArray LedgerDevice::trustedInput(const QString& txhash, uint32_t index) const
+{
+    return m_trusted_inputs.value({ txhash, index });
+}
+
+void LedgerDevice::startSession()
+{
+    ++m_session;
+    m_trusted_inputs.clear();
+}
+
+void LedgerDevice::setTrustedInput(int session, const QString& txhash, uint32_t index, const QByteArray& trusted_input)
+{
+    if (session != m_session) return;
+    m_trusted_inputs.insert({ txhash, index }, trusted_input);
+}
+
+void LedgerDevice::removeTrustedInput(const QString& txhash, uint32_t index)
+{
+    m_trusted_inputs.remove({ txhash, index });
+}
+
 DevicePrivate* DevicePrivate::get(LedgerDevice* device)
 {
     return device->d;
@@ -235,9 +260,21 @@ LedgerGenericCommand::LedgerGenericCommand(LedgerDevice *device, const QByteArra
 
 void LedgerGenericCommand::exec()
 {
+    if (Trace::enabled()) {
+        const auto data = payload();
+        const auto name = QString("apdu %1").arg(QString::fromLatin1(data.left(2).toHex()));
+        Trace::begin("apdu", name, Trace::id(this), {{ "size", data.size() }});
+        connect(this, &Command::finished, this, [this, name] { Trace::end("apdu", name, Trace::id(this)); });
+        connect(this, &Command::error, this, [this, name] { Trace::end("apdu", name, Trace::id(this), {{ "status", "error" }}); });
+    }
     DevicePrivate::get(m_device)->exchange(this);
 }
 
+void LedgerGenericCommand::discard()
+{
+    DevicePrivate::get(m_device)->discard(this);
+}
+
 void varInt(QDataStream &stream, int64_t i)
 {
     switch (varIntSize(i)) {
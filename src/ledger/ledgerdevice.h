@@ -72,6 +72,7 @@ class LedgerGenericCommand : public GenericCommand
 public:
     LedgerGenericCommand(LedgerDevice* device, const QByteArray& data);
     void exec() override;
+    void discard() override;
 };
 
 class DevicePrivate;
@@ -106,6 +107,16 @@ public:
 
     QString appVersion() const { return m_app_version; }
     void setAppVersion(const QString& app_version);
+
+    // Trusted inputs are only valid for the app session they were fetched in.
+    // A session starts each time the firmware or the app is queried, which
+    // happens whenever an app is opened, and drops the cached trusted inputs.
+    void startSession();
+    int session() const { return m_session; }
+    QByteArray trustedInput(const QString& txhash, uint32_t index) const;
+    // ignored when fetched in an earlier session
+    void setTrustedInput(int session, const QString& txhash, uint32_t index, const QByteArray& trusted_input);
+    void removeTrustedInput(const QString& txhash, uint32_t index);
 signals:
     void appVersionChanged(const QString& app_version);
 
@@ -113,6 +124,8 @@ private:
     friend class DevicePrivate;
     DevicePrivate* const d;
     QString m_app_version;
+    int m_session{0};
+    QMap<QPair<QString, uint32_t>, QByteArray> m_trusted_inputs;
 };
 
 #endif // GREEN_LEDGERDEVICE_H
@@ -0,0 +1,253 @@
+#include "ledgeremulator.h"
+
+#include "command.h"
+#include "ledgerdevice.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QTimer>
+
+#include <wally_bip32.h>
+#include <wally_crypto.h>
+
+#define SW_OK                   0x9000
+#define SW_INCORRECT_DATA       0x6a80
+#define SW_INS_NOT_SUPPORTED    0x6d00
+#define SW_CLA_NOT_SUPPORTED    0x6e00
+
+namespace {
+
+QByteArray Response(const QByteArray& data, uint16_t sw = SW_OK)
+{
+    QByteArray response = data;
+    response.append(char(sw >> 8));
+    response.append(char(sw & 0xff));
+    return response;
+}
+
+QVector<uint32_t> ReadPath(QDataStream& stream)
+{
+    uint8_t size;
+    stream >> size;
+    QVector<uint32_t> path;
+    for (int i = 0; i < size && !stream.atEnd(); ++i) {
+        uint32_t p;
+        stream >> p;
+        path.append(p);
+    }
+    return path;
+}
+
+bool IsSigning(uint8_t cla, uint8_t ins)
+{
+    if (cla != BTCHIP_CLA) return false;
+    return ins == BTCHIP_INS_GET_TRUSTED_INPUT ||
+           ins == BTCHIP_INS_HASH_INPUT_START ||
+           ins == BTCHIP_INS_HASH_INPUT_FINALIZE_FULL ||
+           ins == BTCHIP_INS_HASH_SIGN;
+}
+
+} // namespace
+
+LedgerEmulatorPrivate::LedgerEmulatorPrivate()
+    : m_latency(qEnvironmentVariableIsSet("GREEN_LEDGER_EMULATOR_LATENCY") ? qEnvironmentVariableIntValue("GREEN_LEDGER_EMULATOR_LATENCY") : 20)
+    , m_app(qEnvironmentVariable("GREEN_LEDGER_EMULATOR_APP", "Bitcoin Test"))
+    , m_seed(QCryptographicHash::hash("green ledger emulator", QCryptographicHash::Sha512))
+{
+    m_transport = Device::USB;
+    m_type = Device::LedgerNanoS;
+    m_unique_id = 0;
+    m_clock.start();
+}
+
+LedgerDevice* LedgerEmulatorPrivate::create(QObject* parent)
+{
+    return new LedgerDevice(new LedgerEmulatorPrivate, parent);
+}
+
+void LedgerEmulatorPrivate::exchange(DeviceCommand* command)
+{
+    queue.enqueue(command);
+    m_responses.enqueue(process(command->payload()));
+
+    // APDUs are answered one at a time, in order, each after the latency
+    const qint64 now = m_clock.elapsed();
+    m_free_at = qMax(now, m_free_at) + m_latency;
+    QTimer::singleShot(m_free_at - now, q, [this] { respond(); });
+}
+
+void LedgerEmulatorPrivate::discard(DeviceCommand* command)
+{
+    // the APDU was already processed, like a device that received it, keep
+    // the slot so that the following responses keep their timing
+    const int index = queue.indexOf(command);
+    if (index >= 0) queue[index] = nullptr;
+}
+
+void LedgerEmulatorPrivate::respond()
+{
+    if (queue.empty()) return;
+    auto command = queue.dequeue();
+    const auto data = m_responses.dequeue();
+    if (!command) return;
+    QDataStream stream(data);
+    if (!command->readAPDUResponse(q, data.size(), stream)) qWarning("command failed");
+}
+
+QByteArray LedgerEmulatorPrivate::process(const QByteArray& apdu)
+{
+    ++m_apdu_total;
+    if (apdu.size() < 5) {
+        m_signing = false;
+        return Response({}, SW_INCORRECT_DATA);
+    }
+
+    const uint8_t cla = apdu.at(0);
+    const uint8_t ins = apdu.at(1);
+    const uint8_t p1 = apdu.at(2);
+
+    // a signing starts with its first trusted input, or with its first input
+    // hash when the trusted inputs are cached, and lasts until another command
+    if (!IsSigning(cla, ins)) {
+        m_signing = false;
+    } else if (!m_signing) {
+        m_signing = true;
+        m_apdu_count = 0;
+    }
+    ++m_apdu_count;
+    const QByteArray data = apdu.mid(5, uint8_t(apdu.at(4)));
+    QDataStream stream(data);
+    stream.setByteOrder(QDataStream::BigEndian);
+
+    if (cla == BTCHIP_CLA_COMMON_SDK) {
+        if (ins == BTCHIP_INS_GET_APP_NAME_AND_VERSION) return Response(appNameAndVersion());
+        return Response({}, SW_INS_NOT_SUPPORTED);
+    }
+    if (cla != BTCHIP_CLA) return Response({}, SW_CLA_NOT_SUPPORTED);
+
+    switch (ins) {
+    case BTCHIP_INS_GET_FIRMWARE_VERSION:
+        // features, arch, firmware and loader versions
+        return Response(QByteArray::fromHex("01300106050102"));
+    case BTCHIP_INS_GET_WALLET_PUBLIC_KEY:
+        return walletPublicKey(stream);
+    case BTCHIP_INS_GET_TRUSTED_INPUT: {
+        // intermediate blocks are acknowledged, any block can be the last one
+        if (p1 == 0x00) m_trusted_input.reset();
+        m_trusted_input.addData(data);
+        QByteArray trusted_input = QByteArray::fromHex("3200") + placeholder("trusted input", m_trusted_input.result(), 54);
+        return Response(trusted_input);
+    }
+    case BTCHIP_INS_HASH_INPUT_START:
+        m_transaction.addData(data);
+        return Response({});
+    case BTCHIP_INS_HASH_INPUT_FINALIZE_FULL:
+        m_transaction.addData(data);
+        return Response({});
+    case BTCHIP_INS_HASH_SIGN: {
+        const auto path = ReadPath(stream);
+        m_transaction.addData(data);
+        const auto hash = m_transaction.result();
+        m_transaction.reset();
+        const auto signature = sign(path, hash);
+        if (signature.isEmpty()) return Response({}, SW_INCORRECT_DATA);
+        qDebug() << "ledger emulator: signature after" << m_apdu_count << "apdus of the signing";
+        return Response(signature + char(1));
+    }
+    case BTCHIP_INS_SIGN_MESSAGE: {
+        if (p1 == 0x00) {
+            m_message_path = ReadPath(stream);
+            uint8_t version, length;
+            stream >> version >> length;
+            m_message = data.mid(data.size() - length);
+            return Response({});
+        }
+        unsigned char hash[SHA256_LEN];
+        size_t written;
+        if (wally_format_bitcoin_message(reinterpret_cast<const unsigned char*>(m_message.constData()), m_message.size(), BITCOIN_MESSAGE_FLAG_HASH, hash, sizeof(hash), &written) != WALLY_OK) {
+            return Response({}, SW_INCORRECT_DATA);
+        }
+        const auto signature = sign(m_message_path, QByteArray(reinterpret_cast<const char*>(hash), sizeof(hash)));
+        if (signature.isEmpty()) return Response({}, SW_INCORRECT_DATA);
+        return Response(signature);
+    }
+    case BTCHIP_INS_GET_LIQUID_BLINDING_KEY:
+        return Response(QByteArray(1, 0x02) + placeholder("blinding key", data, 32));
+    case BTCHIP_INS_GET_LIQUID_NONCE:
+        return Response(placeholder("nonce", data, 32));
+    case BTCHIP_INS_GET_LIQUID_BLINDING_FACTOR:
+        return Response(placeholder("blinding factor", data, 32));
+    default:
+        return Response({}, SW_INS_NOT_SUPPORTED);
+    }
+}
+
+QByteArray LedgerEmulatorPrivate::appNameAndVersion() const
+{
+    const QByteArray name = m_app.toLocal8Bit();
+    const QByteArray version = "2.0.6";
+    QByteArray response;
+    response.append(char(1));
+    response.append(char(name.size()));
+    response.append(name);
+    response.append(char(version.size()));
+    response.append(version);
+    // flags
+    response.append(char(1));
+    response.append(char(0));
+    return response;
+}
+
+QByteArray LedgerEmulatorPrivate::walletPublicKey(QDataStream& stream) const
+{
+    const auto path = ReadPath(stream);
+    const uint32_t version = m_app.endsWith("Test") ? BIP32_VER_TEST_PRIVATE : BIP32_VER_MAIN_PRIVATE;
+
+    ext_key root, key;
+    if (bip32_key_from_seed(reinterpret_cast<const unsigned char*>(m_seed.constData()), BIP32_ENTROPY_LEN_512, version, 0, &root) != WALLY_OK ||
+        bip32_key_from_parent_path(&root, path.constData(), path.size(), BIP32_FLAG_KEY_PRIVATE, &key) != WALLY_OK) {
+        return Response({}, SW_INCORRECT_DATA);
+    }
+    unsigned char pubkey[EC_PUBLIC_KEY_UNCOMPRESSED_LEN];
+    if (wally_ec_public_key_decompress(key.pub_key, sizeof(key.pub_key), pubkey, sizeof(pubkey)) != WALLY_OK) {
+        return Response({}, SW_INCORRECT_DATA);
+    }
+
+    // uncompressed public key, empty address, chain code
+    QByteArray response;
+    response.append(char(sizeof(pubkey)));
+    response.append(reinterpret_cast<const char*>(pubkey), sizeof(pubkey));
+    response.append(char(0));
+    response.append(reinterpret_cast<const char*>(key.chain_code), sizeof(key.chain_code));
+    return Response(response);
+}
+
+QByteArray LedgerEmulatorPrivate::sign(const QVector<uint32_t>& path, const QByteArray& hash) const
+{
+    const uint32_t version = m_app.endsWith("Test") ? BIP32_VER_TEST_PRIVATE : BIP32_VER_MAIN_PRIVATE;
+
+    ext_key root, key;
+    if (bip32_key_from_seed(reinterpret_cast<const unsigned char*>(m_seed.constData()), BIP32_ENTROPY_LEN_512, version, 0, &root) != WALLY_OK ||
+        bip32_key_from_parent_path(&root, path.constData(), path.size(), BIP32_FLAG_KEY_PRIVATE, &key) != WALLY_OK) {
+        return {};
+    }
+    unsigned char signature[EC_SIGNATURE_LEN];
+    if (wally_ec_sig_from_bytes(key.priv_key + 1, EC_PRIVATE_KEY_LEN, reinterpret_cast<const unsigned char*>(hash.constData()), hash.size(), EC_FLAG_ECDSA, signature, sizeof(signature)) != WALLY_OK) {
+        return {};
+    }
+    unsigned char der[EC_SIGNATURE_DER_MAX_LEN];
+    size_t written;
+    if (wally_ec_sig_to_der(signature, sizeof(signature), der, sizeof(der), &written) != WALLY_OK) {
+        return {};
+    }
+    return QByteArray(reinterpret_cast<const char*>(der), written);
+}
+
+QByteArray LedgerEmulatorPrivate::placeholder(const char* tag, const QByteArray& data, int size) const
+{
+    QCryptographicHash hash(QCryptographicHash::Sha512);
+    hash.addData(tag);
+    hash.addData(m_seed);
+    hash.addData(data);
+    return hash.result().left(size);
+}
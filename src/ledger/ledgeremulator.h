@@ -0,0 +1,52 @@
+#ifndef GREEN_LEDGEREMULATOR_H
+#define GREEN_LEDGEREMULATOR_H
+
+#include "device_p.h"
+
+#include <QCryptographicHash>
+#include <QElapsedTimer>
+#include <QQueue>
+
+// Software stand-in for a Ledger running the BTC app, reachable through the
+// same DevicePrivate interface as the USB transports. Keys derive from a fixed
+// seed and each APDU is answered after a per-APDU latency, so APDU counts and
+// signing times can be measured without hardware:
+//   GREEN_LEDGER_EMULATOR_LATENCY  per APDU latency in ms (default 20)
+//   GREEN_LEDGER_EMULATOR_APP      app name (default "Bitcoin Test")
+// Signatures are made with the right key but over the hash of the streamed
+// transaction data, not the real sighash. Liquid commitments are not emulated.
+class LedgerEmulatorPrivate : public DevicePrivate
+{
+public:
+    LedgerEmulatorPrivate();
+    void exchange(DeviceCommand* command) override;
+    void discard(DeviceCommand* command) override;
+    static LedgerDevice* create(QObject* parent = nullptr);
+    // apdus processed since the emulator started
+    qint64 apduCount() const { return m_apdu_total; }
+private:
+    QByteArray process(const QByteArray& apdu);
+    QByteArray appNameAndVersion() const;
+    QByteArray walletPublicKey(QDataStream& stream) const;
+    QByteArray sign(const QVector<uint32_t>& path, const QByteArray& hash) const;
+    QByteArray placeholder(const char* tag, const QByteArray& data, int size) const;
+    void respond();
+
+    const int m_latency;
+    const QString m_app;
+    const QByteArray m_seed;
+    QQueue<QByteArray> m_responses;
+    QElapsedTimer m_clock;
+    qint64 m_free_at{0};
+    qint64 m_apdu_total{0};
+    // apdus since the current signing started
+    int m_apdu_count{0};
+    bool m_signing{false};
+    // state of the streamed commands
+    QCryptographicHash m_trusted_input{QCryptographicHash::Sha256};
+    QCryptographicHash m_transaction{QCryptographicHash::Sha256};
+    QVector<uint32_t> m_message_path;
+    QByteArray m_message;
+};
+
+#endif // GREEN_LEDGEREMULATOR_H
@@ -14,7 +14,7 @@ QByteArray LedgerGetBlindingKeyActivity::publicKey() const
     return m_public_key;
 }
 
-void LedgerGetBlindingKeyActivity::exec()
+void LedgerGetBlindingKeyActivity::run()
 {
     auto command = m_device->exchange(apdu(BTCHIP_CLA, BTCHIP_INS_GET_LIQUID_BLINDING_KEY, 0x00, 0x00, ParseByteArray(m_script)));
     connect(command, &Command::finished, [this, command] {
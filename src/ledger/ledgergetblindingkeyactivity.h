@@ -14,7 +14,7 @@ public:
     LedgerGetBlindingKeyActivity(const QString& script, LedgerDevice* device);
     QByteArray publicKey() const override;
 private:
-    void exec() override;
+    void run() override;
 };
 
 #endif // GREEN_LEDGERGETBLINDINGKEYACTIVITY_H
@@ -17,7 +17,7 @@ QByteArray LedgerGetBlindingNonceActivity::nonce() const
     return m_nonce;
 }
 
-void LedgerGetBlindingNonceActivity::exec()
+void LedgerGetBlindingNonceActivity::run()
 {
     QByteArray pubkey_uncompressed = QByteArray(EC_PUBLIC_KEY_UNCOMPRESSED_LEN, 0);
     int res = wally_ec_public_key_decompress(
@@ -15,7 +15,7 @@ public:
     LedgerGetBlindingNonceActivity(const QByteArray& pubkey, const QByteArray& script, LedgerDevice* device);
     QByteArray nonce() const override;
 private:
-    void exec() override;
+    void run() override;
 };
 
 #endif // GREEN_LEDGERGETBLINDINGNONCEACTIVITY_H
@@ -44,10 +44,11 @@ LedgerSignLiquidTransactionActivity::LedgerSignLiquidTransactionActivity(const Q
     , m_outputs(outputs)
     , m_batch(new CommandBatch)
 {
+    m_batch->setObjectName("sign liquid transaction");
     connect(m_batch, &Command::error, this, [this] { fail(); });
 }
 
-void LedgerSignLiquidTransactionActivity::exec()
+void LedgerSignLiquidTransactionActivity::run()
 {
     exchange_total = 3 + 6 * m_inputs.size() + 5 * m_outputs.size();
     progress()->setTo(exchange_total);
@@ -47,7 +47,7 @@ public:
     int exchange_total{0};
     CommandBatch* m_batch;
 private:
-    void exec() override;
+    void run() override;
 };
 
 #endif // LEDGERSIGNLIQUIDTRANSACTIONACTIVITY_H
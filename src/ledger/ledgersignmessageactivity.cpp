@@ -15,7 +15,7 @@ QByteArray LedgerSignMessageActivity::signature() const
     return m_signature;
 }
 
-void LedgerSignMessageActivity::exec()
+void LedgerSignMessageActivity::run()
 {
     prepare();
 }
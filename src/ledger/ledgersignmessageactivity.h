@@ -17,7 +17,7 @@ public:
     void prepare();
     void sign();
 private:
-    void exec() override;
+    void run() override;
 };
 
 #endif // GREEN_LEDGERSIGNMESSAGEACTIVITY_H
@@ -32,7 +32,7 @@ DeviceCommand *LedgerSignTransactionActivity::exchange(CommandBatch* batch, cons
     return command;
 }
 
-void LedgerSignTransactionActivity::exec()
+void LedgerSignTransactionActivity::run()
 {
     bool sw = false;
     bool p2sh = false;
@@ -45,6 +45,7 @@ void LedgerSignTransactionActivity::exec()
     }
 
     auto batch = new CommandBatch;
+    batch->setObjectName("sign transaction");
 
     m_signatures.resize(m_signing_inputs.size());
     if (sw) batch->add(signSW());
@@ -56,6 +57,12 @@ void LedgerSignTransactionActivity::exec()
     });
     connect(batch, &CommandBatch::error, [this, batch] {
         batch->deleteLater();
+        // the device may have rejected a cached trusted input, fetch them
+        // again next time
+        for (const auto i : m_signing_inputs) {
+            const auto input = i.toObject();
+            m_device->removeTrustedInput(input.value("txhash").toString(), input.value("pt_idx").toDouble());
+        }
         emit fail();
     });
 
@@ -82,6 +89,7 @@ QByteArray LedgerSignTransactionActivity::outputBytes()
 Command* LedgerSignTransactionActivity::finalizeInputFull(const QByteArray &data)
 {
     auto batch = new CommandBatch;
+    batch->setObjectName("hash input finalize");
     QList<QByteArray> datas;
     QByteArray x;
     x.append(uint8_t(0));
@@ -104,6 +112,7 @@ Command* LedgerSignTransactionActivity::untrustedHashSign(int index, const QVect
 {
     const uint8_t sig_hash_type = 1;
     auto batch = new CommandBatch;
+    batch->setObjectName("hash sign");
 
     auto path = pathToData(private_key_path);
     auto _pin = pin.toUtf8();
@@ -127,28 +136,28 @@ Command* LedgerSignTransactionActivity::untrustedHashSign(int index, const QVect
 Command* LedgerSignTransactionActivity::signSW()
 {
     auto batch = new CommandBatch;
-    auto cmd = getHwInputs(true);
-    connect(cmd, &Command::finished, [this, batch] {
+    // each pass has its own inputs, both are fetched before either signs
+    QSharedPointer<QList<Input>> inputs(new QList<Input>);
+    auto cmd = getHwInputs(true, inputs);
+    connect(cmd, &Command::finished, [this, batch, inputs] {
         // Prepare the pseudo transaction
         // Provide the first script instead of a null script to initialize the P2SH confirmation logic
         const uint32_t version = m_transaction.value("transaction_version").toDouble();
         const uint32_t locktime = m_transaction.value("transaction_locktime").toDouble();
         const auto script0 = ParseByteArray(m_signing_inputs[0].toObject().value("prevout_script"));
-        batch->add(startUntrustedTransaction(version, true, 0, m_hw_inputs, script0, true));
+        batch->add(startUntrustedTransaction(version, true, 0, *inputs, script0, true));
         batch->add(finalizeInputFull(outputBytes()));
 
-        for (int i = 0; i < m_hw_inputs.size(); i++) {
+        for (int i = 0; i < inputs->size(); i++) {
             const auto input = m_signing_inputs[i].toObject();
             const auto address_type = input.value("address_type").toString();
             if (address_type == "p2sh") continue;
             const auto script = ParseByteArray(input.value("prevout_script"));
             const auto user_path = ParsePath(input.value("user_path"));
 
-            batch->add(startUntrustedTransaction(version, false, 0, m_hw_inputs.mid(i, 1), script, true));
+            batch->add(startUntrustedTransaction(version, false, 0, inputs->mid(i, 1), script, true));
             batch->add(untrustedHashSign(i, user_path, "0", locktime));
         }
-
-        m_hw_inputs.clear();
     });
     batch->add(cmd);
     return batch;
@@ -157,19 +166,20 @@ Command* LedgerSignTransactionActivity::signSW()
 Command* LedgerSignTransactionActivity::signNonSW()
 {
     auto batch = new CommandBatch;
-    auto cmd = getHwInputs(false);
-    connect(cmd, &Command::finished, [this, batch] {
+    QSharedPointer<QList<Input>> inputs(new QList<Input>);
+    auto cmd = getHwInputs(false, inputs);
+    connect(cmd, &Command::finished, [this, batch, inputs] {
         const uint32_t version = m_transaction.value("transaction_version").toDouble();
         const uint32_t locktime = m_transaction.value("transaction_locktime").toDouble();
         const auto data = outputBytes();
 
-        for (int i = 0; i < m_hw_inputs.size(); i++) {
+        for (int i = 0; i < inputs->size(); i++) {
             const auto input = m_signing_inputs[i].toObject();
             const auto address_type = input.value("address_type").toString();
             const auto script = ParseByteArray(input.value("prevout_script"));
             const auto user_path = ParsePath(input.value("user_path"));
 
-            batch->add(startUntrustedTransaction(version, i == 0, i, m_hw_inputs, script, false));
+            batch->add(startUntrustedTransaction(version, i == 0, i, *inputs, script, false));
             batch->add(finalizeInputFull(data));
             if (address_type == "p2sh") batch->add(untrustedHashSign(i, user_path, "0", locktime));
         }
@@ -188,23 +198,48 @@ QByteArray sequenceBytes(const QJsonObject& in)
     return data;
 }
 
-Command* LedgerSignTransactionActivity::getHwInputs(bool segwit)
+Command* LedgerSignTransactionActivity::getHwInputs(bool segwit, const QSharedPointer<QList<Input>>& inputs)
 {
     const bool shouldUseTrustedInputForSegwit = true;
     const bool prefer_trusted_inputs = !segwit || shouldUseTrustedInputForSegwit;
 
     auto batch = new CommandBatch;
+    batch->setObjectName(segwit ? "trusted inputs (segwit)" : "trusted inputs");
+
+    inputs->reserve(m_signing_inputs.size());
 
     if (prefer_trusted_inputs) {
+        // parse each previous transaction once, even if several inputs spend it
+        QMap<QString, wally_tx*> txs;
         for (const auto i : m_signing_inputs) {
             const auto input = i.toObject();
             const auto txhash = input.value("txhash").toString();
             uint32_t index = input.value("pt_idx").toDouble();
             uint32_t sequence = input.value("sequence").toDouble();
-            Q_ASSERT(m_signing_transactions.contains(txhash));
-            const auto raw = ParseByteArray(m_signing_transactions.value(txhash));
-            batch->add(getTrustedInput(raw, index, sequence, segwit));
+            const int position = inputs->size();
+            inputs->append(Input());
+
+            const auto cached = m_device->trustedInput(txhash, index);
+            if (!cached.isEmpty()) {
+                (*inputs)[position] = trustedInput(cached, sequence, segwit);
+                continue;
+            }
+
+            wally_tx* tx = txs.value(txhash);
+            if (!tx) {
+                Q_ASSERT(m_signing_transactions.contains(txhash));
+                const auto raw = ParseByteArray(m_signing_transactions.value(txhash));
+                int res = wally_tx_from_bytes((const unsigned char*) raw.constData(), raw.size(), WALLY_TX_FLAG_USE_WITNESS, &tx);
+                Q_ASSERT(res == WALLY_OK);
+                txs.insert(txhash, tx);
+            }
+            // the response is used as is, the cache may drop it if a new device
+            // session started meanwhile
+            batch->add(getTrustedInput(tx, txhash, index, [this, inputs, position, sequence, segwit](const QByteArray& value) {
+                (*inputs)[position] = trustedInput(value, sequence, segwit);
+            }));
         }
+        for (auto tx : txs) wally_tx_free(tx);
     } else {
         Q_UNREACHABLE();
     }
@@ -212,12 +247,23 @@ Command* LedgerSignTransactionActivity::getHwInputs(bool segwit)
     return batch;
 }
 
-Command* LedgerSignTransactionActivity::getTrustedInput(const QByteArray& raw, uint32_t index, uint32_t sequence, bool segwit)
+Input LedgerSignTransactionActivity::trustedInput(const QByteArray& value, uint32_t sequence, bool segwit) const
 {
-    auto batch = new CommandBatch;
+    Input input;
+    input.value = value;
+    input.segwit = segwit;
+    input.trusted = true;
+
+    QDataStream stream(&input.sequence, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream << sequence;
+    return input;
+}
 
-    wally_tx* tx;
-    wally_tx_from_bytes((const unsigned char*) raw.constData(), raw.size(), WALLY_TX_FLAG_USE_WITNESS, &tx);
+Command* LedgerSignTransactionActivity::getTrustedInput(const wally_tx* tx, const QString& txhash, uint32_t index, const std::function<void(const QByteArray&)>& done)
+{
+    auto batch = new CommandBatch;
+    batch->setObjectName("trusted input");
 
     {
         QByteArray data;
@@ -277,28 +323,20 @@ Command* LedgerSignTransactionActivity::getTrustedInput(const QByteArray& raw, u
         stream << tx->locktime;
 
         auto cmd = exchange(batch, apdu(BTCHIP_CLA, BTCHIP_INS_GET_TRUSTED_INPUT, 0x80, 0x00, data));
-        connect(cmd, &Command::finished, [this, cmd, sequence, segwit] {
-            Input input;
-            input.value = cmd->m_response;
-            input.segwit = segwit;
-            input.trusted = true;
-
-            QDataStream stream(&input.sequence, QIODevice::WriteOnly);
-            stream.setByteOrder(QDataStream::LittleEndian);
-            stream << sequence;
-
-            m_hw_inputs.append(input);
+        const int session = m_device->session();
+        connect(cmd, &Command::finished, [this, cmd, session, txhash, index, done] {
+            m_device->setTrustedInput(session, txhash, index, cmd->m_response);
+            done(cmd->m_response);
         });
     }
 
-    wally_tx_free(tx);
-
     return batch;
 }
 
 Command* LedgerSignTransactionActivity::startUntrustedTransaction(uint32_t version, bool new_transaction, size_t index, const QList<Input>& used_inputs, const QByteArray& redeem_script, bool segwit)
 {
     auto batch = new CommandBatch;
+    batch->setObjectName("hash input start");
 
     {
         QByteArray data;
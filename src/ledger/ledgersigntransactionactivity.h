@@ -4,6 +4,11 @@
 #include "command.h"
 #include "device.h"
 
+#include <QSharedPointer>
+
+#include <functional>
+
+struct wally_tx;
 
 struct Input {
     QByteArray value;
@@ -21,7 +26,7 @@ public:
     Command *startUntrustedTransaction(uint32_t version, bool new_transaction, size_t index, const QList<Input> &used_inputs, const QByteArray &redeem_script, bool segwit);
     Command *untrustedHashSign(int index, const QVector<uint32_t> &private_key_path, QString pin, uint32_t locktime);
 private:
-    void exec() override;
+    void run() override;
 private:
     DeviceCommand* exchange(CommandBatch *batch, const QByteArray& data);
     Command* signSW();
@@ -29,9 +34,11 @@ private:
 
     QByteArray outputBytes();
 
-    Command* getHwInputs(bool segwit);
+    // fills inputs once the returned command finishes
+    Command* getHwInputs(bool segwit, const QSharedPointer<QList<Input>>& inputs);
     Command* finalizeInputFull(const QByteArray &data);
-    Command* getTrustedInput(const QByteArray &raw, uint32_t index, uint32_t sequence, bool segwit);
+    Command* getTrustedInput(const wally_tx* tx, const QString& txhash, uint32_t index, const std::function<void(const QByteArray&)>& done);
+    Input trustedInput(const QByteArray& value, uint32_t sequence, bool segwit) const;
 
     LedgerDevice* const m_device;
     const QJsonObject m_transaction;
@@ -39,7 +46,6 @@ private:
     const QJsonArray m_transaction_outputs;
     const QJsonObject m_signing_transactions;
 
-    QList<Input> m_hw_inputs;
     QVector<QByteArray> m_signatures;
 };
 
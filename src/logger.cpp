@@ -0,0 +1,169 @@
+#include "logger.h"
+
+#include <QDir>
+#include <QFileInfo>
+
+#define LOG_ROTATE_SIZE (16 * 1024 * 1024)
+#define LOG_MAX_ARCHIVES 5
+
+namespace {
+
+quint32 Crc32(const QByteArray& data)
+{
+    static quint32 table[256] = {0};
+    if (!table[1]) {
+        for (quint32 i = 0; i < 256; ++i) {
+            quint32 c = i;
+            for (int k = 0; k < 8; ++k) c = c & 1 ? 0xedb88320 ^ (c >> 1) : c >> 1;
+            table[i] = c;
+        }
+    }
+    quint32 crc = 0xffffffff;
+    for (const char b : data) crc = table[(crc ^ quint8(b)) & 0xff] ^ (crc >> 8);
+    return crc ^ 0xffffffff;
+}
+
+void AppendLE32(QByteArray& data, quint32 value)
+{
+    for (int i = 0; i < 4; ++i) data.append(char((value >> (8 * i)) & 0xff));
+}
+
+} // namespace
+
+Logger* Logger::instance()
+{
+    static Logger logger;
+    return &logger;
+}
+
+Logger::~Logger()
+{
+    stop();
+}
+
+void Logger::open()
+{
+    Q_ASSERT(!isRunning());
+    start(QThread::LowPriority);
+}
+
+void Logger::log(const char* source, const QString& message)
+{
+    Entry entry;
+    entry.time = QDateTime::currentMSecsSinceEpoch();
+    entry.source = source;
+    entry.message = message;
+    if (m_stopped) {
+        QMutexLocker locker(&m_mutex);
+        drain();
+        write(entry);
+        m_file.flush();
+        return;
+    }
+    if (!m_queue.push(std::move(entry))) ++m_dropped;
+    if (m_idle.exchange(false)) m_wakeup.release();
+}
+
+void Logger::stop()
+{
+    if (!isRunning()) return;
+    m_stop = true;
+    m_wakeup.release();
+    wait();
+    // messages pushed while the thread was finishing
+    QMutexLocker locker(&m_mutex);
+    m_stopped = true;
+    drain();
+}
+
+void Logger::run()
+{
+    m_file.setFileName(m_file_name);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append)) return;
+    m_file_size = m_file.size();
+    m_file_date = m_file_size > 0 ? QFileInfo(m_file).lastModified().date() : QDate::currentDate();
+    for (;;) {
+        // flag the thread idle before draining, a message pushed after the
+        // drain then always releases the semaphore
+        m_idle = true;
+        const bool stop = m_stop;
+        drain();
+        if (stop) break;
+        m_wakeup.acquire();
+    }
+}
+
+void Logger::drain()
+{
+    bool written = false;
+    Entry entry;
+    while (m_queue.pop(entry)) {
+        write(entry);
+        written = true;
+    }
+    if (const auto dropped = m_dropped.exchange(0)) {
+        const auto timestamp = QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss.zzzzzz");
+        const auto line = QString("[%1] [app:warning] logger dropped %2 messages\n").arg(timestamp).arg(dropped).toUtf8();
+        m_file.write(line);
+        m_file_size += line.size();
+        written = true;
+    }
+    if (written) m_file.flush();
+}
+
+void Logger::write(const Entry& entry)
+{
+    const auto time = QDateTime::fromMSecsSinceEpoch(entry.time);
+    if (m_file_size >= LOG_ROTATE_SIZE || time.date() != m_file_date) rotate();
+    const auto line = QString("[%1] [%2] %3\n").arg(time.toString("yyyy-MM-dd hh:mm:ss.zzzzzz"), entry.source, entry.message).toUtf8();
+    m_file.write(line);
+    m_file_size += line.size();
+}
+
+void Logger::rotate()
+{
+    m_file.close();
+    const QFileInfo info(m_file_name);
+    const auto archive = info.dir().filePath(QString("%1.%2.txt").arg(info.completeBaseName(), QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss")));
+    if (QFile::rename(m_file_name, archive)) {
+        compress(archive);
+        prune();
+    }
+    m_file.open(QIODevice::WriteOnly | QIODevice::Append);
+    m_file_size = m_file.size();
+    m_file_date = QDate::currentDate();
+}
+
+void Logger::compress(const QString& file_name)
+{
+    QFile file(file_name);
+    if (!file.open(QIODevice::ReadOnly)) return;
+    const auto data = file.readAll();
+    file.close();
+
+    // wrap the raw deflate stream from qCompress (size prefix, zlib header and
+    // adler32 removed) in a gzip member
+    const auto deflate = qCompress(data, 9);
+    if (deflate.size() < 10) return;
+    QByteArray gzip = QByteArray::fromHex("1f8b08000000000002ff");
+    gzip.append(deflate.constData() + 6, deflate.size() - 10);
+    AppendLE32(gzip, Crc32(data));
+    AppendLE32(gzip, quint32(data.size()));
+
+    QFile output(file_name + ".gz");
+    if (!output.open(QIODevice::WriteOnly) || output.write(gzip) != gzip.size()) {
+        output.remove();
+        return;
+    }
+    output.close();
+    file.remove();
+}
+
+void Logger::prune()
+{
+    const QFileInfo info(m_file_name);
+    auto archives = info.dir().entryList({ info.completeBaseName() + ".*.txt.gz" }, QDir::Files, QDir::Name);
+    while (archives.size() > LOG_MAX_ARCHIVES) {
+        info.dir().remove(archives.takeFirst());
+    }
+}
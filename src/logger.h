@@ -0,0 +1,65 @@
+#ifndef GREEN_LOGGER_H
+#define GREEN_LOGGER_H
+
+#include "ringbuffer.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QMutex>
+#include <QSemaphore>
+#include <QThread>
+
+#include <atomic>
+
+// Asynchronous log writer. Producers only format the message and push it to
+// a lock-free queue, the file is written, rotated and compressed from the
+// logger thread. When the queue is full messages are dropped and the number
+// of dropped messages is logged once there's room again. The logger thread
+// sleeps while the queue is empty, the first message after that wakes it.
+// Once stopped, messages are written synchronously by the caller, so objects
+// destroyed after stop() still get their messages in the file.
+class Logger : public QThread
+{
+public:
+    static Logger* instance();
+    void setFileName(const QString& file_name) { m_file_name = file_name; }
+    QString fileName() const { return m_file_name; }
+    // starts the logger thread
+    void open();
+    // thread safe, never blocks until stopped
+    void log(const char* source, const QString& message);
+    // drains pending messages and stops the logger thread
+    void stop();
+protected:
+    void run() override;
+private:
+    struct Entry {
+        qint64 time{0};
+        const char* source{nullptr};
+        QString message;
+    };
+    Logger() = default;
+    ~Logger();
+    void drain();
+    void write(const Entry& entry);
+    void rotate();
+    void compress(const QString& file_name);
+    void prune();
+
+    QString m_file_name;
+    QFile m_file;
+    QDate m_file_date;
+    qint64 m_file_size{0};
+    MpscRingBuffer<Entry, 4096> m_queue;
+    std::atomic<bool> m_stop{false};
+    std::atomic<quint64> m_dropped{0};
+    // set by the logger thread before it sleeps, the producer that clears it
+    // wakes the thread
+    std::atomic<bool> m_idle{false};
+    QSemaphore m_wakeup;
+    // serializes the synchronous writes once stopped
+    QMutex m_mutex;
+    std::atomic<bool> m_stopped{false};
+};
+
+#endif // GREEN_LOGGER_H
@@ -4,6 +4,7 @@
 #include <QIcon>
 #include <QQmlApplicationEngine>
 #include <QQuickStyle>
+#include <QQuickWindow>
 #include <QStandardPaths>
 #include <QStyleHints>
 #include <QTranslator>
@@ -11,16 +12,24 @@
 #include <QWindow>
 #include <QStandardPaths>
 
+#include "activitymanager.h"
+#include "automationserver.h"
 #include "clipboard.h"
 #include "devicemanager.h"
 #include "networkmanager.h"
 #include "ga.h"
 #include "httpmanager.h"
+#include "logger.h"
 #include "settings.h"
+#include "trace.h"
 #include "walletmanager.h"
 #include "kdsingleapplication.h"
 #include "util.h"
 
+#ifdef GREEN_MOCK_GDK
+#include "benchmark.h"
+#endif
+
 #include <QZXing.h>
 
 #include <QtPlugin>
@@ -45,7 +54,6 @@ Q_IMPORT_PLUGIN(QCocoaIntegrationPlugin);
 
 extern QString g_data_location;
 QCommandLineParser g_args;
-static QFile g_log_file;
 
 #include <boost/log/core.hpp>
 #include <boost/log/sinks/async_frontend.hpp>
@@ -55,35 +63,40 @@ void gMessageHandler(QtMsgType type, const QMessageLogContext &context, const QS
 {
     Q_UNUSED(context)
 
-    static QHash<QtMsgType, QString> msgLevelHash({{QtDebugMsg, "debug"}, {QtInfoMsg, "info"}, {QtWarningMsg, "warning"}, {QtCriticalMsg, "critical"}, {QtFatalMsg, "fatal"}});
-    QByteArray localMsg = msg.toLocal8Bit();
-    QString timestamp = QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss.zzzzzz");
-    QString logLevelName = msgLevelHash[type];
+    const char* source = "app:debug";
+    switch (type) {
+    case QtDebugMsg: source = "app:debug"; break;
+    case QtInfoMsg: source = "app:info"; break;
+    case QtWarningMsg: source = "app:warning"; break;
+    case QtCriticalMsg: source = "app:critical"; break;
+    case QtFatalMsg: source = "app:fatal"; break;
+    }
 
-    QTextStream ts(&g_log_file);
-    ts << QString("[%1] [app:%2] %3").arg(timestamp, logLevelName, msg) << Qt::endl;
+    Logger::instance()->log(source, msg);
 
-    if (type == QtFatalMsg) abort();
+    if (type == QtFatalMsg) {
+        Logger::instance()->stop();
+        abort();
+    }
 }
 
 class gdk_sink : public boost::log::sinks::basic_formatted_sink_backend<char> {
 public:
     void consume(const boost::log::record_view&, const std::string& formatted_message)
     {
-        QTextStream ts(&g_log_file);
-        QString timestamp = QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss.zzzzzz");
-        ts << QString("[%1] [gdk:info] %2").arg(timestamp, QString::fromStdString(formatted_message)) << Qt::endl;
+        Logger::instance()->log("gdk:info", QString::fromStdString(formatted_message));
     }
 };
 
-static QString g_gdk_debug_buffer;
+// Longest gdk output line kept, longer lines are split
+#define GDK_OUTPUT_MAX_LINE 4096
 
 void initLog()
 {
-    g_log_file.setFileName(GetDataFile("logs", QString("%1.%2.%3.txt").arg(VERSION_MAJOR).arg(VERSION_MINOR).arg(VERSION_PATCH)));
+    Logger::instance()->setFileName(GetDataFile("logs", QString("%1.%2.%3.txt").arg(VERSION_MAJOR).arg(VERSION_MINOR).arg(VERSION_PATCH)));
 
     if (QString{"development"} != QT_STRINGIFY(BUILD_TYPE)) {
-        g_log_file.open(QIODevice::WriteOnly | QIODevice::Append);
+        Logger::instance()->open();
         qInstallMessageHandler(gMessageHandler);
 
         using sink_t = boost::log::sinks::asynchronous_sink<gdk_sink>;
@@ -103,17 +116,28 @@ void initLog()
             dup2(pipes[1], 1);
             dup2(pipes[1], 2);
     #endif
+            // the partial line is owned by this thread and never exceeds
+            // GDK_OUTPUT_MAX_LINE, complete lines go to the logger queue
+            QByteArray line;
+            line.reserve(GDK_OUTPUT_MAX_LINE);
             ssize_t read_size;
             char buffer[1024];
-            while ((read_size = read(pipes[0], buffer, sizeof buffer - 1)) > 0) {
-                g_gdk_debug_buffer.append(QByteArray(buffer, read_size));
-                auto lines = g_gdk_debug_buffer.split('\n');
-                QTextStream ts(&g_log_file);
-                QString timestamp = QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss.zzzzzz");
-                while (lines.size() > 1) {
-                    ts << QString("[%1] [gdk:debug] %3").arg(timestamp, lines.takeFirst()) << Qt::endl;
+            while ((read_size = read(pipes[0], buffer, sizeof buffer)) > 0) {
+                const char* begin = buffer;
+                const char* end = buffer + read_size;
+                while (begin < end) {
+                    const char* newline = static_cast<const char*>(memchr(begin, '\n', end - begin));
+                    const char* stop = newline ? newline : end;
+                    const int length = qMin(int(stop - begin), GDK_OUTPUT_MAX_LINE - line.size());
+                    line.append(begin, length);
+                    begin += length;
+                    if (begin == newline) ++begin;
+                    if (begin - 1 == newline || line.size() == GDK_OUTPUT_MAX_LINE) {
+                        if (line.endsWith('\r')) line.chop(1);
+                        Logger::instance()->log("gdk:debug", QString::fromUtf8(line));
+                        line.resize(0);
+                    }
                 }
-                g_gdk_debug_buffer = lines.first();
             }
         });
         logger_thread.detach();
@@ -168,11 +192,25 @@ int main(int argc, char *argv[])
     g_args.addOption(QCommandLineOption("printtoconsole"));
     g_args.addOption(QCommandLineOption("debug"));
     g_args.addOption(QCommandLineOption("debugfocus"));
+    g_args.addOption(QCommandLineOption("debugstats"));
     g_args.addOption(QCommandLineOption("debugjade"));
     g_args.addOption(QCommandLineOption("debugnavigation"));
     g_args.addOption(QCommandLineOption("channel", "", "name", "latest"));
+    g_args.addOption(QCommandLineOption("trace", "Write a Chrome trace event file", "file"));
+    g_args.addOption(QCommandLineOption("automation", "Serve the automation API on a local socket", "name"));
+    g_args.addOption(QCommandLineOption("gdkrecord", "Record gdk traffic to a file", "file"));
+#ifdef GREEN_MOCK_GDK
+    g_args.addOption(QCommandLineOption("gdkreplay", "Replay gdk traffic from a file", "file"));
+    g_args.addOption(QCommandLineOption("jadeemulator"));
+    g_args.addOption(QCommandLineOption("ledgeremulator"));
+    Benchmark::addOptions(g_args);
+#endif
     g_args.process(app);
 
+    if (g_args.isSet("trace")) {
+        Trace::open(g_args.value("trace"));
+    }
+
     if (g_args.isSet("printtoconsole")) {
 #ifdef _WIN32
         if (AttachConsole(ATTACH_PARENT_PROCESS)) {
@@ -199,7 +237,9 @@ int main(int argc, char *argv[])
     qInfo() << "  Product Version:" << qPrintable(QSysInfo::productVersion());
     qInfo() << "Build Type:" << QT_STRINGIFY(BUILD_TYPE);
     qInfo() << "Data directory:" << g_data_location;
-    qInfo() << "Log file:" << g_log_file.fileName();
+    qInfo() << "Log file:" << Logger::instance()->fileName();
+
+    ActivityManager::instance()->setStatsFile(GetDataFile("logs", "stats.json"));
 
     gdk::init(g_args);
 
@@ -239,10 +279,17 @@ int main(int argc, char *argv[])
     app.installTranslator(&locale_translator);
 
     QQuickStyle::setStyle("Material");
+#ifdef GREEN_MOCK_GDK
+    if (g_args.isSet("benchmarkviews")) {
+        // render on the gui thread so that frames can be timed there
+        QQuickWindow::setSceneGraphBackend(QSGRendererInterface::Software);
+    }
+#endif
 
     HttpManager http_manager;
     WalletManager wallet_manager;
 
+    qmlRegisterSingletonInstance<ActivityManager>("Blockstream.Green.Core", 0, 1, "ActivityManager", ActivityManager::instance());
     qmlRegisterSingletonInstance<Clipboard>("Blockstream.Green.Core", 0, 1, "Clipboard", Clipboard::instance());
     qmlRegisterSingletonInstance<DeviceManager>("Blockstream.Green.Core", 0, 1, "DeviceManager", DeviceManager::instance());
     qmlRegisterSingletonInstance<HttpManager>("Blockstream.Green.Core", 0, 1, "HttpManager", HttpManager::instance());
@@ -265,8 +312,8 @@ int main(int argc, char *argv[])
     engine.rootContext()->setContextProperty("languages", languages.values());
     engine.rootContext()->setContextProperty("data_location_path", g_data_location);
     engine.rootContext()->setContextProperty("data_location_url", QUrl::fromLocalFile(g_data_location));
-    engine.rootContext()->setContextProperty("log_file_path", g_log_file.fileName());
-    engine.rootContext()->setContextProperty("log_file_url", QUrl::fromLocalFile(g_log_file.fileName()));
+    engine.rootContext()->setContextProperty("log_file_path", Logger::instance()->fileName());
+    engine.rootContext()->setContextProperty("log_file_url", QUrl::fromLocalFile(Logger::instance()->fileName()));
 
     if (Settings::instance()->language().isEmpty()) {
         Settings::instance()->setLanguage(language);
@@ -293,73 +340,19 @@ int main(int argc, char *argv[])
 
     int ret = hid_init();
     if (ret != 0) return ret;
+    if (g_args.isSet("automation")) {
+        auto automation_server = new AutomationServer(&app);
+        automation_server->listen(g_args.value("automation"));
+    }
+#ifdef GREEN_MOCK_GDK
+    Benchmark::startFromArgs(g_args, &engine, engine.rootObjects().first(), &app);
+#endif
     ret = app.exec();
     hid_exit();
+    ActivityManager::instance()->writeStats();
+    Trace::close();
+    // the managers and the engine are destroyed after this, their messages
+    // are then written synchronously
+    Logger::instance()->stop();
     return ret;
 }
-
-#ifdef Q_OS_WIN
-#include <mutex>
-#if defined(_GLIBCXX_HAS_GTHREADS) && defined(_GLIBCXX_USE_C99_STDINT_TR1)
-namespace
-{
-  inline std::unique_lock<std::mutex>*&
-  __get_once_functor_lock_ptr()
-  {
-    static std::unique_lock<std::mutex>* __once_functor_lock_ptr = 0;
-    return __once_functor_lock_ptr;
-  }
-}
-
-namespace std _GLIBCXX_VISIBILITY(default)
-{
-_GLIBCXX_BEGIN_NAMESPACE_VERSION
-
-// Explicit instantiation due to -fno-implicit-instantiation.
-  template class function<void()>;
-  function<void()> __once_functor;
-
-  mutex&
-  __get_once_mutex()
-  {
-    static mutex once_mutex;
-    return once_mutex;
-  }
-
-  // code linked against ABI 3.4.12 and later uses this
-  void
-  __set_once_functor_lock_ptr(unique_lock<mutex>* __ptr)
-  {
-    __get_once_functor_lock_ptr() = __ptr;
-  }
-
-  // unsafe - retained for compatibility with ABI 3.4.11
-  unique_lock<mutex>&
-  __get_once_functor_lock()
-  {
-    static unique_lock<mutex> once_functor_lock(__get_once_mutex(), defer_lock);
-    return once_functor_lock;
-  }
-
-  extern "C"
-  {
-    void __once_proxy()
-    {
-      function<void()> __once_call = std::move(__once_functor);
-      if (unique_lock<mutex>* __lock = __get_once_functor_lock_ptr())
-      {
-        // caller is using new ABI and provided lock ptr
-        __get_once_functor_lock_ptr() = 0;
-        __lock->unlock();
-      }
-      else
-        __get_once_functor_lock().unlock();  // global lock
-      __once_call();
-    }
-  }
-
-_GLIBCXX_END_NAMESPACE_VERSION
-} // namespace std
-
-#endif // _GLIBCXX_HAS_GTHREADS && _GLIBCXX_USE_C99_STDINT_TR1
-#endif
@@ -0,0 +1,166 @@
+#include "benchmark.h"
+#include "jadebenchmark.h"
+#include "mockwallet.h"
+#include "modelbenchmark.h"
+#include "viewbenchmark.h"
+
+#include "loginhandler.h"
+#include "network.h"
+#include "networkmanager.h"
+#include "session.h"
+#include "wallet.h"
+#include "walletmanager.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QTimer>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+// give up on a step after 10 minutes
+static const qint64 STEP_TIMEOUT = 10 * 60 * 1000;
+
+Benchmark::Benchmark(const QString& network_id, const QString& file_name, QObject* parent)
+    : QObject(parent)
+    , m_network_id(network_id)
+    , m_file_name(file_name)
+{
+}
+
+void Benchmark::addOptions(QCommandLineParser& args)
+{
+    args.addOption(QCommandLineOption("benchmark", "Benchmark the list models and quit", "file"));
+    args.addOption(QCommandLineOption("benchmarkviews", "Benchmark the list views and quit", "file"));
+    args.addOption(QCommandLineOption("benchmarkjade", "Benchmark the Jade flows on the emulator and quit", "file"));
+    args.addOption(QCommandLineOption("benchmarknetwork", "", "network", "testnet"));
+}
+
+void Benchmark::startFromArgs(const QCommandLineParser& args, QQmlEngine* engine, QObject* root, QObject* parent)
+{
+    const auto network_id = args.value("benchmarknetwork");
+    Benchmark* benchmark = nullptr;
+    if (args.isSet("benchmark")) {
+        benchmark = new ModelBenchmark(network_id, args.value("benchmark"), parent);
+    } else if (args.isSet("benchmarkviews")) {
+        benchmark = new ViewBenchmark(engine, root, network_id, args.value("benchmarkviews"), parent);
+    } else if (args.isSet("benchmarkjade")) {
+        benchmark = new JadeBenchmark(network_id, args.value("benchmarkjade"), parent);
+    }
+    if (benchmark) benchmark->start();
+}
+
+void Benchmark::start()
+{
+    QTimer::singleShot(0, this, [this] {
+        if (!login()) return finish(1);
+        run();
+        finish(0);
+    });
+}
+
+bool Benchmark::login()
+{
+    m_network = NetworkManager::instance()->network(m_network_id);
+    if (!m_network) {
+        qWarning() << "benchmark: unknown network" << m_network_id;
+        return false;
+    }
+
+    auto session = new Session(m_network, this);
+    session->setActive(true);
+    if (!wait([session] { return session->isConnected(); })) {
+        qWarning() << "benchmark: failed to connect";
+        return false;
+    }
+
+    // the synthetic wallet is the same for any credentials
+    auto handler = new LoginHandler(QStringLiteral("benchmark"), QStringLiteral("benchmark"), session);
+    bool done = false;
+    bool failed = false;
+    // drops the connections before the captured locals go away
+    QObject scope;
+    connect(handler, &Handler::done, &scope, [&] { done = true; });
+    connect(handler, &Handler::error, &scope, [&] { failed = true; });
+    handler->exec();
+    wait([&] { return done || failed; });
+    handler->deleteLater();
+    if (!done) {
+        qWarning() << "benchmark: failed to login";
+        return false;
+    }
+
+    // the wallet isn't added to the wallet manager so that the UI doesn't
+    // instantiate models of its own
+    m_wallet = WalletManager::instance()->createWallet(m_network, handler->walletHashId());
+    m_wallet->m_watch_only = true;
+    m_wallet->m_username = QStringLiteral("benchmark");
+    m_wallet->setSession(session);
+    m_wallet->setSession();
+    session->setParent(m_wallet);
+    if (!wait([this] { return m_wallet->ready(); })) {
+        qWarning() << "benchmark: wallet not ready";
+        return false;
+    }
+    return true;
+}
+
+bool Benchmark::wait(const std::function<bool()>& done)
+{
+    // wakes the event loop up when no event arrives
+    QTimer ticker;
+    ticker.start(100);
+    QElapsedTimer timeout;
+    timeout.start();
+    while (!done()) {
+        if (timeout.hasExpired(STEP_TIMEOUT)) return false;
+        QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents);
+    }
+    return true;
+}
+
+qint64 Benchmark::peakMemory()
+{
+#ifdef _WIN32
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef Q_OS_MACOS
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+#endif
+}
+
+void Benchmark::finish(int exit_code)
+{
+    const auto config = MockConfig::fromEnvironment();
+    QJsonObject data{
+        { "results", m_results },
+        { "network", m_network_id },
+        { "config", QJsonObject{
+            { "subaccounts", config.subaccounts },
+            { "transactions", config.transactions },
+            { "utxos", config.utxos },
+            { "assets", config.assets },
+            { "latency", config.latency },
+            { "seed", QString::number(config.seed) },
+        }},
+    };
+    QSaveFile file(m_file_name);
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write(QJsonDocument(data).toJson());
+        file.commit();
+    } else {
+        qWarning() << "benchmark: failed to write" << m_file_name;
+        exit_code = 1;
+    }
+    QCoreApplication::exit(exit_code);
+}
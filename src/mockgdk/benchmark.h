@@ -0,0 +1,49 @@
+#ifndef GREEN_BENCHMARK_H
+#define GREEN_BENCHMARK_H
+
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QObject>
+
+#include <functional>
+
+QT_FORWARD_DECLARE_CLASS(Network)
+QT_FORWARD_DECLARE_CLASS(QCommandLineParser)
+QT_FORWARD_DECLARE_CLASS(QQmlEngine)
+QT_FORWARD_DECLARE_CLASS(Wallet)
+
+// Base of the benchmarks run over the synthetic wallet of the mock gdk. It
+// logs in a watch-only wallet, runs the benchmark and writes the results to a
+// JSON file, then quits the app. The wallet size comes from the
+// GREEN_MOCK_GDK_* variables, see mockwallet.h. The benchmarks that need
+// neither a wallet nor the UI are QtTest benchmarks, see tests/tests.pri.
+class Benchmark : public QObject
+{
+    Q_OBJECT
+public:
+    Benchmark(const QString& network_id, const QString& file_name, QObject* parent = nullptr);
+    // the --benchmark* options of the app
+    static void addOptions(QCommandLineParser& args);
+    // starts the benchmark selected by the options, if any
+    static void startFromArgs(const QCommandLineParser& args, QQmlEngine* engine, QObject* root, QObject* parent);
+    void start();
+protected:
+    virtual void run() = 0;
+    Wallet* wallet() const { return m_wallet; }
+    void addResult(const QJsonObject& result) { m_results.append(result); }
+    // processes events until done returns true, false on timeout
+    bool wait(const std::function<bool()>& done);
+    // peak resident set size in KiB, 0 where not available
+    static qint64 peakMemory();
+private:
+    bool login();
+    void finish(int exit_code);
+private:
+    const QString m_network_id;
+    const QString m_file_name;
+    Network* m_network{nullptr};
+    Wallet* m_wallet{nullptr};
+    QJsonArray m_results;
+};
+
+#endif // GREEN_BENCHMARK_H
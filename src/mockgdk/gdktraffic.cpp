@@ -0,0 +1,164 @@
+#include "gdktraffic.h"
+
+#include <QDebug>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+using nlohmann::json;
+
+GdkTraffic* GdkTraffic::s_instance{nullptr};
+
+GdkTraffic* GdkTraffic::setup(const json& config)
+{
+    if (!s_instance && config.contains("mock_replay")) {
+        static GdkTraffic traffic;
+        s_instance = &traffic;
+    }
+    return s_instance;
+}
+
+int GdkTraffic::init(const json& config)
+{
+    const std::string file_name = config.value("mock_replay", "");
+    m_timing = qEnvironmentVariable("GREEN_MOCK_GDK_REPLAY_TIMING", "1") != "0";
+    if (!load(file_name)) {
+        qWarning() << "gdk traffic: failed to load" << file_name.c_str();
+        return GA_ERROR;
+    }
+    qInfo() << "gdk traffic: replaying" << m_entries.size() << "calls and" << m_notifications.size() << "notifications from" << file_name.c_str();
+    return GA_OK;
+}
+
+int GdkTraffic::setNotificationHandler(GA_session* session, GA_notification_handler handler, void* context)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_listeners[session->replay_id] = { handler, context };
+    }
+    replayed({});
+    return GA_OK;
+}
+
+void GdkTraffic::release(GA_session* session)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_listeners[session->replay_id] = { nullptr, nullptr };
+    }
+    delete session;
+}
+
+bool GdkTraffic::load(const std::string& file_name)
+{
+    std::ifstream file(file_name);
+    if (!file) return false;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty()) continue;
+        auto entry = json::parse(line, nullptr, false);
+        if (entry.is_discarded() || !entry.is_object()) return false;
+        if (entry.value("fn", "") == "notification") {
+            m_notifications.push_back(std::move(entry));
+            continue;
+        }
+        // calls are matched by function and object, the first argument
+        const auto& inputs = entry["in"];
+        const auto key = entry.value("fn", "") + (inputs.empty() ? "" : inputs[0].dump());
+        m_pending[key].push_back(m_entries.size());
+        m_entries.push_back(std::move(entry));
+    }
+    return true;
+}
+
+bool GdkTraffic::take(const char* name, const json& inputs, json& entry)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto key = std::string(name) + (inputs.empty() ? "" : inputs[0].dump());
+    auto i = m_pending.find(key);
+    if (i == m_pending.end() || i->second.empty()) return false;
+    auto& pending = i->second;
+    // prefer the first call with the same arguments, threads can interleave
+    // calls differently than in the recording
+    auto match = std::find_if(pending.begin(), pending.end(), [&](size_t index) {
+        return m_entries[index]["in"] == inputs;
+    });
+    if (match == pending.end()) match = pending.begin();
+    entry = std::move(m_entries[*match]);
+    pending.erase(match);
+    return true;
+}
+
+void GdkTraffic::replayed(const json& entry)
+{
+    std::vector<std::pair<Listener, json>> notifications;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_replayed_seq = std::max(m_replayed_seq, entry.is_object() ? entry.value("seq", int64_t(0)) : int64_t(0));
+        while (!m_notifications.empty()) {
+            auto& notification = m_notifications.front();
+            if (notification.value("after", int64_t(0)) > m_replayed_seq) break;
+            auto listener = m_listeners.find(notification.value("session", int64_t(0)));
+            // wait for the handler to be set
+            if (listener == m_listeners.end()) break;
+            if (listener->second.handler) notifications.emplace_back(listener->second, std::move(notification["out"]));
+            m_notifications.pop_front();
+        }
+    }
+    for (auto& [listener, details] : notifications) {
+        listener.handler(listener.context, Mock::ToJson(std::move(details)));
+    }
+}
+
+int GdkTraffic::unexpected(const char* name)
+{
+    qWarning() << "gdk traffic: unexpected call to" << name;
+    Mock::SetErrorDetails({{ "details", std::string("unexpected call to ") + name }});
+    return GA_ERROR;
+}
+
+json GdkTraffic::input(const GA_json* json)
+{
+    return json ? Mock::Details(json) : nlohmann::json();
+}
+
+json GdkTraffic::input(const char* string)
+{
+    return string ? json(string) : json();
+}
+
+json GdkTraffic::input(uint32_t value)
+{
+    return value;
+}
+
+void GdkTraffic::replayOutput(const json& outputs, size_t& index, GA_session** session)
+{
+    auto replay = new GA_session;
+    replay->replay_id = outputs.at(index++);
+    *session = replay;
+}
+
+void GdkTraffic::replayOutput(const json& outputs, size_t& index, GA_auth_handler** call)
+{
+    const int64_t id = outputs.at(index++);
+    if (id == 0) {
+        *call = nullptr;
+        return;
+    }
+    auto replay = new GA_auth_handler;
+    replay->replay_id = id;
+    *call = replay;
+}
+
+void GdkTraffic::replayOutput(const json& outputs, size_t& index, GA_json** json)
+{
+    *json = Mock::ToJson(outputs.at(index++));
+}
+
+void GdkTraffic::replayOutput(const json& outputs, size_t& index, char** string)
+{
+    const auto& value = outputs.at(index++);
+    *string = strdup(value.is_string() ? value.get<std::string>().c_str() : "");
+}
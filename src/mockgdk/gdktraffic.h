@@ -0,0 +1,99 @@
+#ifndef GREEN_GDKTRAFFIC_H
+#define GREEN_GDKTRAFFIC_H
+
+#include "mockgdk.h"
+
+#include <QtGlobal>
+
+#include <chrono>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Replays a recording of gdk traffic in place of the mock wallet, see
+// src/gdkrecorder.h for the recording. Enabled with the "mock_replay" file in
+// the GA_init config.
+//
+// Replay matches calls by function, object and arguments, sleeps the recorded
+// durations unless GREEN_MOCK_GDK_REPLAY_TIMING=0, and delivers each
+// notification right after the call that preceded it in the recording.
+class GdkTraffic
+{
+public:
+    // returns the active instance, null when serving the mock wallet
+    static GdkTraffic* instance() { return s_instance; }
+    // creates the instance if the config asks for it
+    static GdkTraffic* setup(const nlohmann::json& config);
+
+    int init(const nlohmann::json& config);
+    int setNotificationHandler(GA_session* session, GA_notification_handler handler, void* context);
+    // deletes a replayed session
+    void release(GA_session* session);
+
+    // replays a call
+    template <typename... Params>
+    int call(const char* name, int (*)(Params...), std::common_type_t<Params>... args);
+
+private:
+    struct Listener {
+        GA_notification_handler handler;
+        void* context;
+    };
+
+    GdkTraffic() = default;
+    bool load(const std::string& file_name);
+    bool take(const char* name, const nlohmann::json& inputs, nlohmann::json& entry);
+    void replayed(const nlohmann::json& entry);
+    int unexpected(const char* name);
+
+    nlohmann::json input(GA_session* session) { return session->replay_id; }
+    nlohmann::json input(GA_auth_handler* call) { return call->replay_id; }
+    nlohmann::json input(const GA_json* json);
+    nlohmann::json input(const char* string);
+    nlohmann::json input(uint32_t value);
+    // output arguments are filled after the call
+    template <typename T>
+    nlohmann::json input(T**) { return nullptr; }
+
+    void replayOutput(const nlohmann::json& outputs, size_t& index, GA_session** session);
+    void replayOutput(const nlohmann::json& outputs, size_t& index, GA_auth_handler** call);
+    void replayOutput(const nlohmann::json& outputs, size_t& index, GA_json** json);
+    void replayOutput(const nlohmann::json& outputs, size_t& index, char** string);
+    template <typename T>
+    void replayOutput(const nlohmann::json&, size_t&, T) {}
+
+    static GdkTraffic* s_instance;
+    std::mutex m_mutex;
+    bool m_timing{true};
+    std::vector<nlohmann::json> m_entries;
+    std::map<std::string, std::deque<size_t>> m_pending;
+    std::deque<nlohmann::json> m_notifications;
+    int64_t m_replayed_seq{0};
+    std::map<int64_t, Listener> m_listeners;
+};
+
+template <typename... Params>
+int GdkTraffic::call(const char* name, int (*)(Params...), std::common_type_t<Params>... args)
+{
+    const auto inputs = nlohmann::json::array({ input(args)... });
+    nlohmann::json entry;
+    if (!take(name, inputs, entry)) return unexpected(name);
+    if (m_timing) std::this_thread::sleep_for(std::chrono::microseconds(entry.value("d", int64_t(0))));
+    const int rc = entry.value("rc", GA_ERROR);
+    if (rc == GA_OK) {
+        size_t index = 0;
+        (replayOutput(entry["out"], index, args), ...);
+    }
+    Mock::SetErrorDetails(entry.value("error", nlohmann::json::object()));
+    replayed(entry);
+    return rc;
+}
+
+// hands the call to the replay when one is active
+#define GDK_TRAFFIC(function, ...) \
+    if (auto traffic = GdkTraffic::instance()) return traffic->call(#function, &function, __VA_ARGS__)
+
+#endif // GREEN_GDKTRAFFIC_H
@@ -0,0 +1,159 @@
+#include "jadebenchmark.h"
+
+#include "activity.h"
+#include "activitymanager.h"
+#include "jadeapi.h"
+#include "jadedevice.h"
+#include "jadeemulatorimpl.h"
+#include "jadeupdatecontroller.h"
+#include "wallet.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+
+namespace {
+
+QJsonArray Path(int branch, int pointer)
+{
+    return { 2147483732.0, 2147483649.0, 2147483648.0, branch, pointer };
+}
+
+} // namespace
+
+void JadeBenchmark::run()
+{
+    m_emulator = new JadeEmulatorImpl;
+    auto api = new JadeAPI(m_emulator);
+    JadeDevice device(api, QStringLiteral("emulator"));
+    api->setParent(&device);
+    JadeUpdateController controller;
+    controller.setDevice(&device);
+    m_device = &device;
+
+    bool connected = false;
+    QObject scope;
+    connect(api, &JadeAPI::onConnected, &scope, [&] { connected = true; });
+    api->connectDevice();
+    if (!wait([&] { return connected; })) {
+        qWarning() << "benchmark: jade emulator didn't connect";
+        return;
+    }
+
+    const bool ok = step("version info", 1, [&](int, const Done& done) {
+        auto context = new QObject(&scope);
+        connect(&device, &JadeDevice::versionInfoChanged, context, [=] { context->deleteLater(); done(true); });
+        connect(&device, &JadeDevice::error, context, [=] { context->deleteLater(); done(false); });
+        device.updateVersionInfo();
+    }) && step("unlock", 1, [&](int, const Done& done) {
+        // the controller queues the unlock in the http manager
+        watch(controller.unlock(), done);
+    }) && step("unlock with pinserver", 1, [&](int, const Done& done) {
+        // the mock gdk stands in for the pinserver, the requests take the
+        // same path as in the app
+        m_emulator->setPinServerUrl(QStringLiteral("https://pinserver.invalid"));
+        watch(controller.unlock(), done);
+    }) && step("get xpub", 100, [&](int i, const Done& done) {
+        exec(device.getWalletPublicKey(wallet()->network(), { 2147483732u, 2147483649u, 2147483648u + i }), done);
+    }) && sign(1) && sign(10) && sign(100)
+       && ota(256 * 1024) && ota(1024 * 1024);
+    if (!ok) qWarning() << "benchmark: jade step failed";
+
+    api->disconnectDevice();
+    m_device = nullptr;
+    m_emulator = nullptr;
+}
+
+void JadeBenchmark::watch(Activity* activity, const Done& done)
+{
+    connect(activity, &Activity::finished, activity, [=] {
+        activity->deleteLater();
+        done(true);
+    });
+    connect(activity, &Activity::failed, activity, [=] {
+        activity->deleteLater();
+        done(false);
+    });
+}
+
+void JadeBenchmark::exec(Activity* activity, const Done& done)
+{
+    watch(activity, done);
+    ActivityManager::instance()->exec(activity);
+}
+
+bool JadeBenchmark::step(const QString& name, int count, const std::function<void(int, const Done&)>& request, QJsonObject result)
+{
+    int done = 0;
+    bool failed = false;
+    std::function<void()> next = [&] {
+        request(done, [&](bool ok) {
+            if (!ok) {
+                qWarning() << "benchmark:" << name << "failed";
+                failed = true;
+                return;
+            }
+            if (++done < count) next();
+        });
+    };
+    QElapsedTimer timer;
+    timer.start();
+    next();
+    const bool finished = wait([&] { return failed || done == count; });
+    const double duration = timer.nsecsElapsed() / 1e6;
+
+    result.insert("step", name);
+    result.insert("count", count);
+    result.insert("ms", duration);
+    result.insert("ms_per_call", duration / count);
+    if (result.contains("bytes")) result.insert("bytes_per_second", result.value("bytes").toDouble() * 1000 / duration);
+    result.insert("latency_ms", qEnvironmentVariable("GREEN_JADE_EMULATOR_LATENCY", "5").toInt());
+    result.insert("bandwidth", qEnvironmentVariableIntValue("GREEN_JADE_EMULATOR_BANDWIDTH"));
+    if (failed) result.insert("failed", true);
+    if (!finished) result.insert("timeout", true);
+    qInfo().noquote() << "benchmark: jade" << name << count << "in" << duration << "ms";
+    addResult(result);
+    return finished && !failed;
+}
+
+bool JadeBenchmark::sign(int count)
+{
+    // a one input, two output transaction stands in for the previous ones,
+    // all inputs spend it
+    const QString txhash(64, '1');
+    const QJsonObject signing_transactions{{ txhash, QString(QByteArray(225, 0x01).toHex()) }};
+    QJsonArray inputs;
+    for (int i = 0; i < count; ++i) {
+        inputs.append(QJsonObject{
+            { "address_type", "p2wpkh" },
+            { "txhash", txhash },
+            { "prevout_script", "0014751e76e8199196d454941c45d1b3a323f1433bd6" },
+            { "satoshi", 100000 },
+            { "user_path", Path(0, i) },
+            { "ae_host_commitment", QString(QByteArray(32, char(i)).toHex()) },
+            { "ae_host_entropy", QString(QByteArray(32, char(i)).toHex()) },
+        });
+    }
+    const QJsonObject transaction{{ "transaction", QString(QByteArray(10 + count * 41 + 2 * 31, 0x02).toHex()) }};
+    const QJsonArray outputs{ QJsonObject{{ "is_change", false }}, QJsonObject{{ "is_change", false }} };
+    return step("sign", 1, [&](int, const Done& done) {
+        exec(m_device->signTransaction(wallet()->network(), transaction, inputs, outputs, signing_transactions), done);
+    }, {{ "inputs", count }});
+}
+
+bool JadeBenchmark::ota(int size)
+{
+    // the emulator doesn't decompress, any bytes do
+    QByteArray firmware(size, Qt::Uninitialized);
+    for (int i = 0; i < size; ++i) firmware[i] = char(i * 31);
+    const int chunk_size = m_device->versionInfo().value("JADE_OTA_MAX_CHUNK", 4096).toInt();
+    return step("ota", 1, [&](int, const Done& done) {
+        // the activity the controller runs once the firmware is downloaded,
+        // the download and the firmware cache are left out
+        auto activity = new JadeUpdateActivity({{ "size", size * 2 }, { "version", "0.1.48" }, { "config", "BLE" }}, firmware, m_device);
+        connect(activity, &JadeUpdateActivity::locked, activity, [=] {
+            qWarning() << "benchmark: jade locked during ota";
+            activity->fail();
+        });
+        exec(activity, done);
+    }, {{ "bytes", size }, { "chunk_size", chunk_size }});
+}
@@ -0,0 +1,40 @@
+#ifndef GREEN_JADEBENCHMARK_H
+#define GREEN_JADEBENCHMARK_H
+
+#include "benchmark.h"
+
+QT_FORWARD_DECLARE_CLASS(Activity)
+QT_FORWARD_DECLARE_CLASS(JadeDevice)
+QT_FORWARD_DECLARE_CLASS(JadeEmulatorImpl)
+
+// Runs the Jade flows the app runs, through JadeDevice, its activities and
+// JadeUpdateController, against the in-process emulator and times them:
+// version info, unlock, also through the pinserver handshake answered by the
+// mock gdk, get_xpub, signing transactions with a growing number of inputs
+// and OTA uploads. The emulator latency and link speed come from the
+// GREEN_JADE_EMULATOR_* variables, see jadeemulatorimpl.h, and the pinserver
+// latency from GREEN_MOCK_GDK_LATENCY. Logs in the mock wallet for its
+// network. Started with --benchmarkjade <file>.
+class JadeBenchmark : public Benchmark
+{
+    Q_OBJECT
+public:
+    using Benchmark::Benchmark;
+protected:
+    void run() override;
+private:
+    using Done = std::function<void(bool)>;
+    // issues count requests one after the other, each once the previous one
+    // is done, false if one fails or times out
+    bool step(const QString& name, int count, const std::function<void(int, const Done&)>& request, QJsonObject result = {});
+    // done tells whether the activity finished, watch is for activities
+    // already started, exec also runs it
+    static void watch(Activity* activity, const Done& done);
+    static void exec(Activity* activity, const Done& done);
+    bool sign(int inputs);
+    bool ota(int size);
+    JadeEmulatorImpl* m_emulator{nullptr};
+    JadeDevice* m_device{nullptr};
+};
+
+#endif // GREEN_JADEBENCHMARK_H
@@ -0,0 +1,754 @@
+#include "gdktraffic.h"
+#include "mockgdk.h"
+
+#include <wally_bip39.h>
+#include <wally_core.h>
+#include <wally_crypto.h>
+
+#include <QDebug>
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+
+using nlohmann::json;
+using Mock::Details;
+using Mock::ToJson;
+
+namespace {
+
+thread_local json g_error_details = json::object();
+
+char* ToString(const std::string& value)
+{
+    return strdup(value.c_str());
+}
+
+int Fail(const std::string& details)
+{
+    g_error_details = {{ "details", details }};
+    return GA_ERROR;
+}
+
+int Succeed()
+{
+    g_error_details = json::object();
+    return GA_OK;
+}
+
+std::string Sha256Hex(const std::string& data)
+{
+    unsigned char hash[SHA256_LEN];
+    wally_sha256(reinterpret_cast<const unsigned char*>(data.data()), data.size(), hash, sizeof(hash));
+    char* hex;
+    wally_hex_from_bytes(hash, sizeof(hash), &hex);
+    std::string result(hex);
+    wally_free_string(hex);
+    return result;
+}
+
+const json& Networks()
+{
+    static const json networks = [] {
+        json networks = {{ "all_networks", json::array() }};
+        const auto add = [&](const std::string& id, const std::string& name, bool mainnet, bool liquid, bool electrum) {
+            networks["all_networks"].push_back(id);
+            networks[id] = {
+                { "name", name },
+                { "network", id },
+                { "mainnet", mainnet },
+                { "liquid", liquid },
+                { "development", false },
+                { "server_type", electrum ? "electrum" : "green" },
+                { "policy_asset", liquid ? std::string(64, mainnet ? '6' : '1') : "" },
+                { "tx_explorer_url", "https://example.com/tx/" },
+                { "electrum_url", "" },
+            };
+        };
+        add("mainnet", "Bitcoin", true, false, false);
+        add("liquid", "Liquid", true, true, false);
+        add("testnet", "Testnet", false, false, false);
+        add("testnet-liquid", "Testnet Liquid", false, true, false);
+        add("electrum-mainnet", "Bitcoin Electrum", true, false, true);
+        add("electrum-testnet", "Testnet Electrum", false, false, true);
+        return networks;
+    }();
+    return networks;
+}
+
+void Notify(GA_session* session, const std::string& event, json payload)
+{
+    std::lock_guard<std::mutex> lock(session->notification_mutex);
+    if (!session->notification_handler) return;
+    // the handler takes ownership
+    session->notification_handler(session->notification_context, ToJson({{ "event", event }, { event, std::move(payload) }}));
+}
+
+void RunNotifier(GA_session* session)
+{
+    using clock = std::chrono::steady_clock;
+    const auto block_interval = std::chrono::milliseconds(session->config.block_interval);
+    const auto tx_interval = std::chrono::milliseconds(session->config.tx_interval);
+    auto next_block = clock::now() + block_interval;
+    auto next_tx = clock::now() + tx_interval;
+
+    std::unique_lock<std::mutex> lock(session->notifier_mutex);
+    while (!session->stop) {
+        auto deadline = clock::time_point::max();
+        if (block_interval.count() > 0) deadline = std::min(deadline, next_block);
+        if (tx_interval.count() > 0) deadline = std::min(deadline, next_tx);
+        session->notifier_condition.wait_until(lock, deadline);
+        if (session->stop) break;
+        const auto now = clock::now();
+        const bool block = block_interval.count() > 0 && now >= next_block;
+        const bool tx = tx_interval.count() > 0 && now >= next_tx;
+        if (block) next_block += block_interval;
+        if (tx) next_tx += tx_interval;
+        if (!session->logged_in) continue;
+
+        lock.unlock();
+        if (tx) Notify(session, "transaction", session->wallet->receiveTransaction());
+        if (block) Notify(session, "block", session->wallet->mineBlock());
+        lock.lock();
+    }
+}
+
+int MakeHandler(GA_session* session, const char* action, GA_auth_handler** call, std::function<json()> fn)
+{
+    auto handler = new GA_auth_handler;
+    handler->action = action;
+    handler->latency = session->config.latency;
+    handler->call = std::move(fn);
+    handler->status = {{ "status", "call" }, { "action", action }};
+    *call = handler;
+    return Succeed();
+}
+
+int MakeWalletHandler(GA_session* session, const char* action, GA_auth_handler** call, std::function<json(MockWallet*)> fn)
+{
+    if (!session->wallet) return Fail("id_you_are_not_connected");
+    return MakeHandler(session, action, call, [wallet = session->wallet.get(), fn = std::move(fn)] {
+        return fn(wallet);
+    });
+}
+
+int Login(GA_session* session, const GA_json* hw_device, const GA_json* details, GA_auth_handler** call, const char* action)
+{
+    if (!session->wallet) return Fail("id_you_are_not_connected");
+    const auto& data = Details(details);
+    // hardware wallets are not asked for xpubs, the synthetic wallet is the
+    // same for any credentials
+    std::string secret = Details(hw_device).value("device", json::object()).value("name", "");
+    for (const char* key : { "mnemonic", "pin", "username" }) {
+        if (data.contains(key) && data[key].is_string()) secret += data[key].get<std::string>();
+    }
+    if (data.contains("mnemonic")) session->secret = data["mnemonic"].get<std::string>();
+    if (data.contains("username")) session->watch_only_username = data["username"].get<std::string>();
+    return MakeHandler(session, action, call, [session, secret] {
+        const auto network = session->wallet->network().value("network", "");
+        json result = {{ "wallet_hash_id", Sha256Hex(network + secret) }};
+        {
+            std::lock_guard<std::mutex> lock(session->notifier_mutex);
+            session->logged_in = true;
+        }
+        Notify(session, "settings", session->wallet->settings());
+        Notify(session, "twofactor_reset", {{ "is_active", false }, { "days_remaining", -1 }, { "is_disputed", false }});
+        Notify(session, "block", {{ "block_height", session->wallet->blockHeight() }, { "block_hash", std::string(64, '0') }});
+        return result;
+    });
+}
+
+int GenerateMnemonic(size_t entropy_len, char** output)
+{
+    std::random_device random;
+    unsigned char entropy[BIP39_ENTROPY_LEN_256];
+    for (size_t i = 0; i < entropy_len; ++i) entropy[i] = random() & 0xff;
+    char* mnemonic;
+    if (bip39_mnemonic_from_bytes(nullptr, entropy, entropy_len, &mnemonic) != WALLY_OK) return Fail("id_invalid_mnemonic");
+    *output = ToString(mnemonic);
+    wally_free_string(mnemonic);
+    return Succeed();
+}
+
+const std::map<std::string, double>& Units()
+{
+    static const std::map<std::string, double> units{
+        { "btc", 1e8 }, { "mbtc", 1e5 }, { "ubtc", 1e2 }, { "bits", 1e2 }, { "sats", 1 },
+    };
+    return units;
+}
+
+} // namespace
+
+const json& Mock::Details(const GA_json* details)
+{
+    static const json empty = json::object();
+    return details ? *reinterpret_cast<const json*>(details) : empty;
+}
+
+GA_json* Mock::ToJson(json value)
+{
+    // the app reads GA_json as nlohmann::json, see json.cpp
+    return reinterpret_cast<GA_json*>(new json(std::move(value)));
+}
+
+void Mock::SetErrorDetails(json details)
+{
+    g_error_details = std::move(details);
+}
+
+extern "C" {
+
+int GA_init(const GA_json* config)
+{
+    if (auto traffic = GdkTraffic::setup(Details(config))) return traffic->init(Details(config));
+    const auto mock = MockConfig::fromEnvironment();
+    qInfo() << "mock gdk:" << mock.subaccounts << "subaccounts," << mock.transactions << "transactions and"
+            << mock.utxos << "utxos per subaccount," << mock.assets << "assets," << mock.latency << "ms latency";
+    Q_UNUSED(config);
+    return Succeed();
+}
+
+int GA_get_thread_error_details(GA_json** output)
+{
+    *output = ToJson(g_error_details);
+    return GA_OK;
+}
+
+int GA_create_session(GA_session** session)
+{
+    GDK_TRAFFIC(GA_create_session, session);
+    *session = new GA_session;
+    return Succeed();
+}
+
+int GA_set_notification_handler(GA_session* session, GA_notification_handler handler, void* context)
+{
+    if (auto traffic = GdkTraffic::instance()) return traffic->setNotificationHandler(session, handler, context);
+    std::lock_guard<std::mutex> lock(session->notification_mutex);
+    session->notification_handler = handler;
+    session->notification_context = context;
+    return Succeed();
+}
+
+int GA_destroy_session(GA_session* session)
+{
+    if (auto traffic = GdkTraffic::instance()) {
+        const int rc = traffic->call("GA_destroy_session", &GA_destroy_session, session);
+        traffic->release(session);
+        return rc;
+    }
+    {
+        std::lock_guard<std::mutex> lock(session->notifier_mutex);
+        session->stop = true;
+    }
+    session->notifier_condition.notify_all();
+    if (session->notifier.joinable()) session->notifier.join();
+    delete session;
+    return Succeed();
+}
+
+int GA_connect(GA_session* session, const GA_json* net_params)
+{
+    GDK_TRAFFIC(GA_connect, session, net_params);
+    const std::string name = Details(net_params).value("name", "");
+    if (!Networks().contains(name)) return Fail("id_unknown_network");
+    std::this_thread::sleep_for(std::chrono::milliseconds(session->config.latency));
+    if (!session->wallet) {
+        session->wallet = std::make_unique<MockWallet>(session->config, Networks()[name]);
+        if (session->config.block_interval > 0 || session->config.tx_interval > 0) {
+            session->notifier = std::thread(RunNotifier, session);
+        }
+    }
+    Notify(session, "network", {{ "current_state", "connected" }, { "next_state", "connected" }, { "wait_ms", 0 }});
+    return Succeed();
+}
+
+int GA_http_request(GA_session* session, const GA_json* params, GA_json** output)
+{
+    GDK_TRAFFIC(GA_http_request, session, params, output);
+    // stands in for a pinserver, enough for the auth_user handshake of the
+    // Jade emulator, see GREEN_JADE_EMULATOR_PINSERVER
+    const json& details = Details(params);
+    const auto urls = details.value("urls", json::array());
+    const std::string url = urls.empty() ? std::string() : urls.front().get<std::string>();
+    const auto path = url.substr(url.find_last_of('/') + 1);
+    json body;
+    if (path == "start_handshake") {
+        body = {{ "ske", Sha256Hex("ske") }, { "sig", Sha256Hex("sig") }};
+    } else if (path == "get_pin") {
+        body = {{ "encrypted_key", Sha256Hex(details.value("data", json::object()).dump()) }, { "hmac", Sha256Hex("hmac") }};
+    } else {
+        return Fail("http requests are not available in the mock gdk");
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(session->config.latency));
+    *output = ToJson({{ "body", body }});
+    return Succeed();
+}
+
+int GA_refresh_assets(GA_session* session, const GA_json* params, GA_json** output)
+{
+    GDK_TRAFFIC(GA_refresh_assets, session, params, output);
+    Q_UNUSED(params);
+    if (!session->wallet) return Fail("id_you_are_not_connected");
+    *output = ToJson(session->wallet->assets());
+    return Succeed();
+}
+
+int GA_get_networks(GA_json** output)
+{
+    GDK_TRAFFIC(GA_get_networks, output);
+    *output = ToJson(Networks());
+    return Succeed();
+}
+
+int GA_register_user(GA_session* session, const GA_json* hw_device, const GA_json* details, GA_auth_handler** call)
+{
+    GDK_TRAFFIC(GA_register_user, session, hw_device, details, call);
+    return Login(session, hw_device, details, call, "register_user");
+}
+
+int GA_login_user(GA_session* session, const GA_json* hw_device, const GA_json* details, GA_auth_handler** call)
+{
+    GDK_TRAFFIC(GA_login_user, session, hw_device, details, call);
+    return Login(session, hw_device, details, call, "login_user");
+}
+
+int GA_set_watch_only(GA_session* session, const char* username, const char* password)
+{
+    GDK_TRAFFIC(GA_set_watch_only, session, username, password);
+    Q_UNUSED(password);
+    session->watch_only_username = username;
+    return Succeed();
+}
+
+int GA_get_watch_only_username(GA_session* session, char** username)
+{
+    GDK_TRAFFIC(GA_get_watch_only_username, session, username);
+    *username = ToString(session->watch_only_username);
+    return Succeed();
+}
+
+int GA_remove_account(GA_session* session, GA_auth_handler** call)
+{
+    GDK_TRAFFIC(GA_remove_account, session, call);
+    return MakeHandler(session, "remove_account", call, [] { return json::object(); });
+}
+
+int GA_create_subaccount(GA_session* session, const GA_json* details, GA_auth_handler** call)
+{
+    GDK_TRAFFIC(GA_create_subaccount, session, details, call);
+    return MakeWalletHandler(session, "create_subaccount", call, [details = Details(details)](MockWallet* wallet) {
+        return wallet->createSubaccount(details);
+    });
+}
+
+int GA_get_subaccounts(GA_session* session, const GA_json* details, GA_auth_handler** call)
+{
+    GDK_TRAFFIC(GA_get_subaccounts, session, details, call);
+    Q_UNUSED(details);
+    return MakeWalletHandler(session, "get_subaccounts", call, [](MockWallet* wallet) {
+        return json{{ "subaccounts", wallet->subaccounts() }};
+    });
+}
+
+int GA_rename_subaccount(GA_session* session, uint32_t subaccount, const char* new_name)
+{
+    GDK_TRAFFIC(GA_rename_subaccount, session, subaccount, new_name);
+    if (!session->wallet || !session->wallet->renameSubaccount(subaccount, new_name)) return Fail("id_unknown_subaccount");
+    return Succeed();
+}
+
+int GA_update_subaccount(GA_session* session, const GA_json* details, GA_auth_handler** call)
+{
+    GDK_TRAFFIC(GA_update_subaccount, session, details, call);
+    return MakeWalletHandler(session, "update_subaccount", call, [details = Details(details)](MockWallet* wallet) {
+        if (!wallet->updateSubaccount(details)) throw std::runtime_error("id_unknown_subaccount");
+        return json::object();
+    });
+}
+
+int GA_get_transactions(GA_session* session, const GA_json* details, GA_auth_handler** call)
+{
+    GDK_TRAFFIC(GA_get_transactions, session, details, call);
+    return MakeWalletHandler(session, "get_transactions", call, [details = Details(details)](MockWallet* wallet) {
+        const auto transactions = wallet->transactions(details.value("subaccount", 0u), details.value("first", 0u), details.value("count", 30u));
+        return json{{ "transactions", transactions }};
+    });
+}
+
+int GA_get_receive_address(GA_session* session, const GA_json* details, GA_auth_handler** call)
+{
+    GDK_TRAFFIC(GA_get_receive_address, session, details, call);
+    return MakeWalletHandler(session, "get_receive_address", call, [details = Details(details)](MockWallet* wallet) {
+        auto address = wallet->receiveAddress(details.value("subaccount", 0u));
+        if (address.is_null()) throw std::runtime_error("id_unknown_subaccount");
+        return address;
+    });
+}
+
+int GA_get_previous_addresses(GA_session* session, const GA_json* details, GA_auth_handler** call)
+{
+    GDK_TRAFFIC(GA_get_previous_addresses, session, details, call);
+    return MakeWalletHandler(session, "get_previous_addresses", call, [details = Details(details)](MockWallet* wallet) {
+        auto addresses = wallet->previousAddresses(details.value("subaccount", 0u), details.value("last_pointer", 0));
+        if (addresses.is_null()) throw std::runtime_error("id_unknown_subaccount");
+        return addresses;
+    });
+}
+
+int GA_get_unspent_outputs(GA_session* session, const GA_json* details, GA_auth_handler** call)
+{
+    GDK_TRAFFIC(GA_get_unspent_outputs, session, details, call);
+    return MakeWalletHandler(session, "get_unspent_outputs", call, [details = Details(details)](MockWallet* wallet) {
+        const auto outputs = wallet->unspentOutputs(details.value("subaccount", 0u), details.value("num_confs", 0u));
+        return json{{ "unspent_outputs", outputs }};
+    });
+}
+
+int GA_set_unspent_outputs_status(GA_session* session, const GA_json* details, GA_auth_handler** call)
+{
+    GDK_TRAFFIC(GA_set_unspent_outputs_status, session, details, call);
+    return MakeHandler(session, "set_utxo_status", call, [details = Details(details)] { return details; });
+}
+
+int GA_get_balance(GA_session* session, const GA_json* details, GA_auth_handler** call)
+{
+    GDK_TRAFFIC(GA_get_balance, session, details, call);
+    return MakeWalletHandler(session, "get_balance", call, [details = Details(details)](MockWallet* wallet) {
+        auto balance = wallet->balance(details.value("subaccount", 0u), details.value("num_confs", 0u));
+        if (balance.is_null()) throw std::runtime_error("id_unknown_subaccount");
+        return balance;
+    });
+}
+
+int GA_get_available_currencies(GA_session* session, GA_json** currencies)
+{
+    GDK_TRAFFIC(GA_get_available_currencies, session, currencies);
+    Q_UNUSED(session);
+    *currencies = ToJson({
+        { "all", { "USD", "EUR", "GBP" } },
+        { "per_exchange", {{ "BITFINEX", { "USD", "EUR", "GBP" } }} },
+    });
+    return Succeed();
+}
+
+int GA_set_transaction_memo(GA_session* session, const char* txhash_hex, const char* memo, uint32_t memo_type)
+{
+    GDK_TRAFFIC(GA_set_transaction_memo, session, txhash_hex, memo, memo_type);
+    Q_UNUSED(memo_type);
+    if (!session->wallet || !session->wallet->setMemo(txhash_hex, memo)) return Fail("id_invalid_transaction");
+    return Succeed();
+}
+
+int GA_get_fee_estimates(GA_session* session, GA_json** estimates)
+{
+    GDK_TRAFFIC(GA_get_fee_estimates, session, estimates);
+    Q_UNUSED(session);
+    // fee rates in sat/kvB for 0 to 24 blocks
+    json fees = json::array();
+    for (int i = 0; i < 25; ++i) fees.push_back(i == 0 ? 1000 : 1000 + 25000 / i);
+    *estimates = ToJson({{ "fees", fees }});
+    return Succeed();
+}
+
+int GA_get_credentials(GA_session* session, const GA_json* details, GA_auth_handler** call)
+{
+    GDK_TRAFFIC(GA_get_credentials, session, details, call);
+    Q_UNUSED(details);
+    return MakeHandler(session, "get_credentials", call, [mnemonic = session->secret] {
+        return json{{ "mnemonic", mnemonic }, { "password", "" }};
+    });
+}
+
+int GA_get_system_message(GA_session* session, char** message_text)
+{
+    GDK_TRAFFIC(GA_get_system_message, session, message_text);
+    Q_UNUSED(session);
+    *message_text = ToString("");
+    return Succeed();
+}
+
+int GA_ack_system_message(GA_session* session, const char* message_text, GA_auth_handler** call)
+{
+    GDK_TRAFFIC(GA_ack_system_message, session, message_text, call);
+    Q_UNUSED(message_text);
+    return MakeHandler(session, "ack_system_message", call, [] { return json::object(); });
+}
+
+int GA_get_twofactor_config(GA_session* session, GA_json** config)
+{
+    GDK_TRAFFIC(GA_get_twofactor_config, session, config);
+    Q_UNUSED(session);
+    const json method = {{ "enabled", false }, { "confirmed", false }, { "data", "" }};
+    *config = ToJson({
+        { "all_methods", { "email", "sms", "phone", "gauth" } },
+        { "enabled_methods", json::array() },
+        { "any_enabled", false },
+        { "email", method },
+        { "sms", method },
+        { "phone", method },
+        { "gauth", method },
+        { "limits", {{ "is_fiat", false }, { "satoshi", 0 }} },
+        { "twofactor_reset", {{ "is_active", false }, { "days_remaining", -1 }, { "is_disputed", false }} },
+    });
+    return Succeed();
+}
+
+int GA_create_transaction(GA_session* session, const GA_json* transaction_details, GA_auth_handler** call)
+{
+    GDK_TRAFFIC(GA_create_transaction, session, transaction_details, call);
+    return MakeHandler(session, "create_transaction", call, [details = Details(transaction_details)] {
+        auto transaction = details;
+        json satoshi = json::object();
+        for (const auto& addressee : details.value("addressees", json::array())) {
+            const std::string asset = addressee.value("asset_id", "btc");
+            satoshi[asset] = satoshi.value(asset, int64_t(0)) + addressee.value("satoshi", int64_t(0));
+        }
+        transaction["satoshi"] = satoshi;
+        transaction["fee"] = 1410;
+        transaction["fee_rate"] = 10000;
+        transaction["transaction_vsize"] = 141;
+        transaction["error"] = "";
+        return transaction;
+    });
+}
+
+int GA_sign_transaction(GA_session* session, const GA_json* transaction_details, GA_auth_handler** call)
+{
+    GDK_TRAFFIC(GA_sign_transaction, session, transaction_details, call);
+    return MakeHandler(session, "sign_tx", call, [details = Details(transaction_details)] {
+        auto transaction = details;
+        transaction["user_signed"] = true;
+        return transaction;
+    });
+}
+
+int GA_send_transaction(GA_session* session, const GA_json* transaction_details, GA_auth_handler** call)
+{
+    GDK_TRAFFIC(GA_send_transaction, session, transaction_details, call);
+    return MakeHandler(session, "send_raw_tx", call, [details = Details(transaction_details)] {
+        auto transaction = details;
+        transaction["txhash"] = Sha256Hex(details.dump());
+        return transaction;
+    });
+}
+
+int GA_send_nlocktimes(GA_session* session)
+{
+    GDK_TRAFFIC(GA_send_nlocktimes, session);
+    Q_UNUSED(session);
+    return Succeed();
+}
+
+int GA_set_csvtime(GA_session* session, const GA_json* locktime_details, GA_auth_handler** call)
+{
+    GDK_TRAFFIC(GA_set_csvtime, session, locktime_details, call);
+    return MakeWalletHandler(session, "set_csvtime", call, [details = Details(locktime_details)](MockWallet* wallet) {
+        wallet->setSettings({{ "csvtime", details.value("value", 0) }});
+        return json::object();
+    });
+}
+
+int GA_get_settings(GA_session* session, GA_json** settings)
+{
+    GDK_TRAFFIC(GA_get_settings, session, settings);
+    if (!session->wallet) return Fail("id_you_are_not_connected");
+    *settings = ToJson(session->wallet->settings());
+    return Succeed();
+}
+
+int GA_change_settings(GA_session* session, const GA_json* settings, GA_auth_handler** call)
+{
+    GDK_TRAFFIC(GA_change_settings, session, settings, call);
+    return MakeWalletHandler(session, "change_settings", call, [session, details = Details(settings)](MockWallet* wallet) {
+        wallet->setSettings(details);
+        Notify(session, "settings", wallet->settings());
+        return json::object();
+    });
+}
+
+int GA_convert_amount(GA_session* session, const GA_json* value_details, GA_json** output)
+{
+    GDK_TRAFFIC(GA_convert_amount, session, value_details, output);
+    Q_UNUSED(session);
+    const auto& details = Details(value_details);
+    int64_t satoshi = 0;
+    if (details.contains("satoshi")) {
+        satoshi = details["satoshi"].get<int64_t>();
+    } else {
+        bool found = false;
+        for (const auto& [unit, factor] : Units()) {
+            if (!details.contains(unit)) continue;
+            const auto& value = details[unit];
+            const double amount = value.is_string() ? std::atof(value.get<std::string>().c_str()) : value.get<double>();
+            satoshi = std::llround(amount * factor);
+            found = true;
+            break;
+        }
+        if (!found) return Fail("id_invalid_amount");
+    }
+    json result = {
+        { "satoshi", satoshi },
+        { "sats", std::to_string(satoshi) },
+        { "fiat_currency", "USD" },
+        { "fiat_rate", "50000.00" },
+    };
+    char buffer[32];
+    for (const auto& [unit, factor] : Units()) {
+        if (unit == "sats") continue;
+        const int decimals = factor == 1e8 ? 8 : factor == 1e5 ? 5 : 2;
+        snprintf(buffer, sizeof(buffer), "%.*f", decimals, satoshi / factor);
+        result[unit] = buffer;
+    }
+    snprintf(buffer, sizeof(buffer), "%.2f", satoshi / 1e8 * 50000);
+    result["fiat"] = buffer;
+    *output = ToJson(result);
+    return Succeed();
+}
+
+int GA_encrypt_with_pin(GA_session* session, const GA_json* details, GA_auth_handler** call)
+{
+    GDK_TRAFFIC(GA_encrypt_with_pin, session, details, call);
+    return MakeHandler(session, "encrypt_with_pin", call, [details = Details(details)] {
+        const auto data = details.dump();
+        return json{{ "pin_data", {
+            { "encrypted_data", Sha256Hex("data" + data) },
+            { "pin_identifier", Sha256Hex("identifier" + data).substr(0, 32) },
+            { "salt", Sha256Hex("salt" + data).substr(0, 32) },
+        }}};
+    });
+}
+
+int GA_disable_all_pin_logins(GA_session* session)
+{
+    GDK_TRAFFIC(GA_disable_all_pin_logins, session);
+    Q_UNUSED(session);
+    return Succeed();
+}
+
+int GA_get_wallet_identifier(const GA_json* net_params, const GA_json* params, GA_json** output)
+{
+    GDK_TRAFFIC(GA_get_wallet_identifier, net_params, params, output);
+    const std::string network = Details(net_params).value("name", "");
+    const std::string master_xpub = Details(params).value("master_xpub", "");
+    *output = ToJson({{ "wallet_hash_id", Sha256Hex(network + master_xpub) }});
+    return Succeed();
+}
+
+int GA_generate_mnemonic(char** output)
+{
+    GDK_TRAFFIC(GA_generate_mnemonic, output);
+    return GenerateMnemonic(BIP39_ENTROPY_LEN_256, output);
+}
+
+int GA_generate_mnemonic_12(char** output)
+{
+    GDK_TRAFFIC(GA_generate_mnemonic_12, output);
+    return GenerateMnemonic(BIP39_ENTROPY_LEN_128, output);
+}
+
+int GA_convert_json_to_string(const GA_json* json, char** output)
+{
+    *output = ToString(Details(json).dump());
+    return Succeed();
+}
+
+int GA_convert_string_to_json(const char* input, GA_json** output)
+{
+    auto value = json::parse(input, nullptr, false);
+    if (value.is_discarded()) return Fail("id_invalid_json");
+    *output = ToJson(std::move(value));
+    return Succeed();
+}
+
+int GA_destroy_json(GA_json* json)
+{
+    delete reinterpret_cast<nlohmann::json*>(json);
+    return GA_OK;
+}
+
+void GA_destroy_string(char* str)
+{
+    free(str);
+}
+
+int GA_auth_handler_request_code(GA_auth_handler* call, const char* method)
+{
+    GDK_TRAFFIC(GA_auth_handler_request_code, call, method);
+    // two factor authentication is never enabled in the mock wallet
+    Q_UNUSED(call);
+    Q_UNUSED(method);
+    return Succeed();
+}
+
+int GA_auth_handler_resolve_code(GA_auth_handler* call, const char* code)
+{
+    GDK_TRAFFIC(GA_auth_handler_resolve_code, call, code);
+    Q_UNUSED(call);
+    Q_UNUSED(code);
+    return Succeed();
+}
+
+int GA_auth_handler_call(GA_auth_handler* call)
+{
+    GDK_TRAFFIC(GA_auth_handler_call, call);
+    std::this_thread::sleep_for(std::chrono::milliseconds(call->latency));
+    try {
+        call->status = {{ "status", "done" }, { "action", call->action }, { "result", call->call() }};
+    } catch (const std::exception& e) {
+        call->status = {{ "status", "error" }, { "action", call->action }, { "error", e.what() }};
+    }
+    return Succeed();
+}
+
+int GA_auth_handler_get_status(GA_auth_handler* call, GA_json** output)
+{
+    GDK_TRAFFIC(GA_auth_handler_get_status, call, output);
+    *output = ToJson(call->status);
+    return Succeed();
+}
+
+int GA_destroy_auth_handler(GA_auth_handler* call)
+{
+    if (auto traffic = GdkTraffic::instance()) {
+        const int rc = traffic->call("GA_destroy_auth_handler", &GA_destroy_auth_handler, call);
+        delete call;
+        return rc;
+    }
+    delete call;
+    return Succeed();
+}
+
+int GA_change_settings_twofactor(GA_session* session, const char* method, const GA_json* twofactor_details, GA_auth_handler** call)
+{
+    GDK_TRAFFIC(GA_change_settings_twofactor, session, method, twofactor_details, call);
+    Q_UNUSED(method);
+    Q_UNUSED(twofactor_details);
+    return MakeHandler(session, "enable_2fa", call, [] { return json::object(); });
+}
+
+int GA_twofactor_reset(GA_session* session, const char* email, uint32_t is_dispute, GA_auth_handler** call)
+{
+    GDK_TRAFFIC(GA_twofactor_reset, session, email, is_dispute, call);
+    Q_UNUSED(email);
+    Q_UNUSED(is_dispute);
+    return MakeHandler(session, "request_2fa_reset", call, [] { return json::object(); });
+}
+
+int GA_twofactor_cancel_reset(GA_session* session, GA_auth_handler** call)
+{
+    GDK_TRAFFIC(GA_twofactor_cancel_reset, session, call);
+    return MakeHandler(session, "cancel_2fa_reset", call, [] { return json::object(); });
+}
+
+int GA_twofactor_change_limits(GA_session* session, const GA_json* limit_details, GA_auth_handler** call)
+{
+    GDK_TRAFFIC(GA_twofactor_change_limits, session, limit_details, call);
+    return MakeHandler(session, "change_tx_limits", call, [details = Details(limit_details)] { return details; });
+}
+
+} // extern "C"
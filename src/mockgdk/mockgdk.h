@@ -0,0 +1,53 @@
+#ifndef GREEN_MOCKGDK_H
+#define GREEN_MOCKGDK_H
+
+#include "mockwallet.h"
+
+#include <gdk.h>
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <thread>
+
+struct GA_session
+{
+    MockConfig config{MockConfig::fromEnvironment()};
+    std::unique_ptr<MockWallet> wallet;
+    std::string secret;
+    std::string watch_only_username;
+    bool logged_in{false};
+
+    std::mutex notification_mutex;
+    GA_notification_handler notification_handler{nullptr};
+    void* notification_context{nullptr};
+
+    std::mutex notifier_mutex;
+    std::condition_variable notifier_condition;
+    std::thread notifier;
+    bool stop{false};
+
+    // id of the session in the recording being replayed
+    int64_t replay_id{0};
+};
+
+struct GA_auth_handler
+{
+    std::string action;
+    int latency{0};
+    std::function<nlohmann::json()> call;
+    nlohmann::json status;
+
+    // id of the auth handler in the recording being replayed
+    int64_t replay_id{0};
+};
+
+namespace Mock {
+
+const nlohmann::json& Details(const GA_json* details);
+GA_json* ToJson(nlohmann::json value);
+void SetErrorDetails(nlohmann::json details);
+
+} // namespace Mock
+
+#endif // GREEN_MOCKGDK_H
@@ -0,0 +1,32 @@
+# Offline implementation of the GA_* functions used by the app, serving a
+# synthetic wallet, see mockwallet.h for the knobs. Enable with
+#   qmake CONFIG+=mockgdk
+# gdk is still linked for wally, boost and nlohmann. The definitions here
+# take precedence over the ones in the gdk library. gdktraffic.h replays gdk
+# traffic recorded with --gdkrecord, see --gdkreplay.
+# modelbenchmark.h and viewbenchmark.h drive the list models and views over
+# the synthetic wallet, see --benchmark and --benchmarkviews. jadebenchmark.h
+# times the Jade flows on the emulator, see --benchmarkjade. The benchmarks
+# that need neither a wallet nor the UI are in tests/, see tests/tests.pri.
+
+DEFINES += GREEN_MOCK_GDK
+
+INCLUDEPATH += $$PWD
+
+SOURCES += \
+    $$PWD/benchmark.cpp \
+    $$PWD/gdktraffic.cpp \
+    $$PWD/jadebenchmark.cpp \
+    $$PWD/mockgdk.cpp \
+    $$PWD/mockwallet.cpp \
+    $$PWD/modelbenchmark.cpp \
+    $$PWD/viewbenchmark.cpp
+
+HEADERS += \
+    $$PWD/benchmark.h \
+    $$PWD/gdktraffic.h \
+    $$PWD/jadebenchmark.h \
+    $$PWD/mockgdk.h \
+    $$PWD/mockwallet.h \
+    $$PWD/modelbenchmark.h \
+    $$PWD/viewbenchmark.h
@@ -0,0 +1,474 @@
+#include "mockwallet.h"
+
+#include <QtGlobal>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+using nlohmann::json;
+
+namespace {
+
+int EnvironmentInt(const char* name, int default_value)
+{
+    return qEnvironmentVariableIsSet(name) ? qEnvironmentVariableIntValue(name) : default_value;
+}
+
+int64_t Now()
+{
+    using namespace std::chrono;
+    return duration_cast<microseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+std::string AddressType(const json& subaccount)
+{
+    const std::string type = subaccount.value("type", "");
+    return type == "2of2" ? "csv" : type;
+}
+
+uint64_t SplitMix64(uint64_t& state)
+{
+    uint64_t z = (state += 0x9e3779b97f4a7c15);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    return z ^ (z >> 31);
+}
+
+// multisig outputs expire after ~1 year of blocks
+constexpr uint32_t CSV_BLOCKS = 51840;
+constexpr int64_t BLOCK_TIME = 600LL * 1000 * 1000;
+
+} // namespace
+
+MockConfig MockConfig::fromEnvironment()
+{
+    MockConfig config;
+    config.subaccounts = qMax(1, EnvironmentInt("GREEN_MOCK_GDK_SUBACCOUNTS", config.subaccounts));
+    config.transactions = qMax(0, EnvironmentInt("GREEN_MOCK_GDK_TRANSACTIONS", config.transactions));
+    config.utxos = qMax(0, EnvironmentInt("GREEN_MOCK_GDK_UTXOS", config.utxos));
+    config.assets = qMax(0, EnvironmentInt("GREEN_MOCK_GDK_ASSETS", config.assets));
+    config.latency = qMax(0, EnvironmentInt("GREEN_MOCK_GDK_LATENCY", config.latency));
+    config.block_interval = qMax(0, EnvironmentInt("GREEN_MOCK_GDK_BLOCK_INTERVAL", config.block_interval));
+    config.tx_interval = qMax(0, EnvironmentInt("GREEN_MOCK_GDK_TX_INTERVAL", config.tx_interval));
+    config.seed = qEnvironmentVariable("GREEN_MOCK_GDK_SEED", "0").toULongLong();
+    return config;
+}
+
+MockWallet::MockWallet(const MockConfig& config, const json& network)
+    : m_config(config)
+    , m_network(network)
+    , m_random(config.seed)
+{
+    m_settings = {
+        { "unit", "BTC" },
+        { "altimeout", 5 },
+        { "required_num_blocks", 12 },
+        { "csvtime", CSV_BLOCKS },
+        { "nlocktime", 12960 },
+        { "notifications", {{ "email_incoming", false }, { "email_outgoing", false }} },
+        { "pricing", {{ "currency", "USD" }, { "exchange", "BITFINEX" }} },
+    };
+
+    if (isLiquid()) {
+        for (int i = 0; i < m_config.assets; ++i) m_assets.push_back(randomHex(32));
+    }
+
+    const bool electrum = m_network.value("server_type", "") == "electrum";
+    for (int i = 0; i < m_config.subaccounts; ++i) {
+        auto& subaccount = addSubaccount(i == 0 ? "" : "Account " + std::to_string(i + 1), electrum ? "p2wpkh" : "2of2");
+        // spread history over the last blocks, oldest first
+        for (int j = 0; j < m_config.transactions; ++j) {
+            const uint32_t height = m_block_height - (m_config.transactions - j) * 3;
+            subaccount.transactions.push_back(makeTransaction(subaccount, height, (j % 3) != 2));
+        }
+        std::reverse(subaccount.transactions.begin(), subaccount.transactions.end());
+        for (int j = 0; j < m_config.utxos; ++j) {
+            subaccount.utxos.push_back(makeUtxo(subaccount, m_block_height - (m_config.utxos - j)));
+        }
+    }
+}
+
+bool MockWallet::isLiquid() const
+{
+    return m_network.value("liquid", false);
+}
+
+std::string MockWallet::policyAsset() const
+{
+    return m_network.value("policy_asset", "");
+}
+
+MockWallet::Subaccount& MockWallet::addSubaccount(const std::string& name, const std::string& type)
+{
+    uint32_t pointer = 0;
+    if (type == "2of2" || type == "2of3") {
+        while (m_subaccounts.count(pointer)) ++pointer;
+    } else {
+        // singlesig pointers encode the script type in the low bits
+        pointer = 1;
+        while (m_subaccounts.count(pointer)) pointer += 16;
+    }
+    auto& subaccount = m_subaccounts[pointer];
+    subaccount.data = {
+        { "pointer", pointer },
+        { "name", name },
+        { "type", type },
+        { "hidden", false },
+        { "receiving_id", type == "2of2" ? "GA" + randomHex(12) : "" },
+        { "recovery_pub_key", "" },
+        { "required_ca", 0 },
+        { "bip44_discovered", true },
+    };
+    return subaccount;
+}
+
+std::string MockWallet::randomHex(size_t bytes)
+{
+    static const char digits[] = "0123456789abcdef";
+    std::string hex;
+    hex.reserve(bytes * 2);
+    for (size_t i = 0; i < bytes; ++i) {
+        const auto byte = m_random() & 0xff;
+        hex.push_back(digits[byte >> 4]);
+        hex.push_back(digits[byte & 0xf]);
+    }
+    return hex;
+}
+
+int64_t MockWallet::randomAmount()
+{
+    // 10k to ~10M sats, log-uniform like real wallets
+    std::uniform_real_distribution<double> exponent(4, 7);
+    return static_cast<int64_t>(std::pow(10.0, exponent(m_random)));
+}
+
+std::string MockWallet::randomAsset()
+{
+    if (!isLiquid()) return "btc";
+    if (m_assets.empty() || m_random() % 2 == 0) return policyAsset();
+    return m_assets[m_random() % m_assets.size()];
+}
+
+std::string MockWallet::makeAddress(const Subaccount& subaccount, uint32_t pointer) const
+{
+    const bool mainnet = m_network.value("mainnet", false);
+    std::string address = isLiquid() ? (mainnet ? "ex1q" : "tex1q") : (mainnet ? "bc1q" : "tb1q");
+    // not a valid address, only unique and stable for the given pointers
+    uint64_t state = m_config.seed ^ (uint64_t(subaccount.data.value("pointer", 0u)) << 32) ^ pointer;
+    char buffer[17];
+    for (int i = 0; i < 3; ++i) {
+        snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(SplitMix64(state)));
+        address.append(buffer, i < 2 ? 16 : 8);
+    }
+    return address;
+}
+
+json MockWallet::makeTransaction(Subaccount& subaccount, uint32_t block_height, bool incoming)
+{
+    const auto asset = randomAsset();
+    const int64_t amount = randomAmount();
+    const int64_t vsize = 141 + (m_random() % 4) * 68;
+    const int64_t fee = vsize * (1 + m_random() % 20);
+    const auto address = makeAddress(subaccount, subaccount.next_address++);
+    const int64_t age = block_height > 0 ? m_block_height - block_height : 0;
+
+    json output = {
+        { "address", incoming ? address : makeAddress(subaccount, 0x8000 | (m_random() & 0x7fff)) },
+        { "satoshi", amount },
+        { "is_relevant", incoming },
+        { "pt_idx", 0 },
+    };
+    json input = {
+        { "address", incoming ? "" : address },
+        { "satoshi", amount + fee },
+        { "is_relevant", !incoming },
+        { "pt_idx", 0 },
+    };
+    if (isLiquid()) {
+        output["asset_id"] = asset;
+        input["asset_id"] = asset;
+    }
+
+    return {
+        { "txhash", randomHex(32) },
+        { "block_height", block_height },
+        { "created_at_ts", Now() - age * BLOCK_TIME },
+        { "type", incoming ? "incoming" : "outgoing" },
+        { "satoshi", {{ asset, amount }} },
+        { "fee", fee },
+        { "fee_rate", fee * 1000 / vsize },
+        { "memo", "" },
+        { "inputs", json::array({ input }) },
+        { "outputs", json::array({ output }) },
+        { "can_rbf", !incoming && block_height == 0 },
+        { "can_cpfp", false },
+        { "rbf_optin", !incoming },
+        { "spv_verified", "disabled" },
+        { "transaction_size", vsize + 81 },
+        { "transaction_vsize", vsize },
+        { "transaction_weight", vsize * 4 },
+    };
+}
+
+json MockWallet::makeUtxo(Subaccount& subaccount, uint32_t block_height)
+{
+    const auto type = subaccount.data.value("type", "");
+    const uint32_t pointer = subaccount.next_address++;
+    json utxo = {
+        { "txhash", randomHex(32) },
+        { "pt_idx", m_random() % 4 },
+        { "satoshi", randomAmount() },
+        { "block_height", block_height },
+        { "subaccount", subaccount.data["pointer"] },
+        { "pointer", pointer },
+        { "address", makeAddress(subaccount, pointer) },
+        { "address_type", AddressType(subaccount.data) },
+        { "user_status", 0 },
+        { "is_internal", false },
+    };
+    if (type == "2of2" && block_height > 0) utxo["expiry_height"] = block_height + CSV_BLOCKS;
+    if (isLiquid()) {
+        utxo["asset_id"] = randomAsset();
+        utxo["confidential"] = true;
+    }
+    return utxo;
+}
+
+json MockWallet::balanceLocked(const Subaccount& subaccount, uint32_t num_confs) const
+{
+    json balance = json::object();
+    balance[isLiquid() ? policyAsset() : "btc"] = 0;
+    for (const auto& utxo : subaccount.utxos) {
+        const uint32_t height = utxo["block_height"];
+        const uint32_t confs = height == 0 ? 0 : m_block_height - height + 1;
+        if (confs < num_confs) continue;
+        const auto key = isLiquid() ? utxo["asset_id"].get<std::string>() : "btc";
+        balance[key] = balance.value(key, int64_t(0)) + utxo["satoshi"].get<int64_t>();
+    }
+    return balance;
+}
+
+json MockWallet::subaccounts()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    json result = json::array();
+    for (const auto& [pointer, subaccount] : m_subaccounts) {
+        auto data = subaccount.data;
+        data["satoshi"] = balanceLocked(subaccount, 0);
+        result.push_back(data);
+    }
+    return result;
+}
+
+json MockWallet::subaccount(uint32_t pointer)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto i = m_subaccounts.find(pointer);
+    if (i == m_subaccounts.end()) return nullptr;
+    auto data = i->second.data;
+    data["satoshi"] = balanceLocked(i->second, 0);
+    return data;
+}
+
+json MockWallet::createSubaccount(const json& details)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto& subaccount = addSubaccount(details.value("name", ""), details.value("type", "2of2"));
+    auto data = subaccount.data;
+    data["satoshi"] = balanceLocked(subaccount, 0);
+    return data;
+}
+
+bool MockWallet::renameSubaccount(uint32_t pointer, const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto i = m_subaccounts.find(pointer);
+    if (i == m_subaccounts.end()) return false;
+    i->second.data["name"] = name;
+    return true;
+}
+
+bool MockWallet::updateSubaccount(const json& details)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto i = m_subaccounts.find(details.value("subaccount", 0u));
+    if (i == m_subaccounts.end()) return false;
+    if (details.contains("name")) i->second.data["name"] = details["name"];
+    if (details.contains("hidden")) i->second.data["hidden"] = details["hidden"];
+    return true;
+}
+
+json MockWallet::transactions(uint32_t pointer, size_t first, size_t count)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    json result = json::array();
+    auto i = m_subaccounts.find(pointer);
+    if (i == m_subaccounts.end()) return result;
+    const auto& transactions = i->second.transactions;
+    for (size_t j = first; j < transactions.size() && j < first + count; ++j) {
+        result.push_back(transactions[j]);
+    }
+    return result;
+}
+
+json MockWallet::unspentOutputs(uint32_t pointer, uint32_t num_confs)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    json result = json::object();
+    auto i = m_subaccounts.find(pointer);
+    if (i == m_subaccounts.end()) return result;
+    for (const auto& utxo : i->second.utxos) {
+        const uint32_t height = utxo["block_height"];
+        const uint32_t confs = height == 0 ? 0 : m_block_height - height + 1;
+        if (confs < num_confs) continue;
+        const auto key = isLiquid() ? utxo["asset_id"].get<std::string>() : "btc";
+        result[key].push_back(utxo);
+    }
+    return result;
+}
+
+json MockWallet::balance(uint32_t pointer, uint32_t num_confs)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto i = m_subaccounts.find(pointer);
+    if (i == m_subaccounts.end()) return nullptr;
+    return balanceLocked(i->second, num_confs);
+}
+
+json MockWallet::previousAddresses(uint32_t pointer, int last_pointer)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto i = m_subaccounts.find(pointer);
+    if (i == m_subaccounts.end()) return nullptr;
+    const auto& subaccount = i->second;
+    // pages of 10 from the newest address, like gdk
+    const int start = last_pointer > 0 ? last_pointer - 1 : int(subaccount.next_address) - 1;
+    json list = json::array();
+    int pointer_at = start;
+    for (; pointer_at > 0 && list.size() < 10; --pointer_at) {
+        list.push_back({
+            { "address", makeAddress(subaccount, pointer_at) },
+            { "address_type", AddressType(subaccount.data) },
+            { "pointer", pointer_at },
+            { "subaccount", pointer },
+            { "tx_count", pointer_at % 3 },
+        });
+    }
+    json result = {{ "list", list }};
+    if (pointer_at > 0) result["last_pointer"] = pointer_at + 1;
+    return result;
+}
+
+json MockWallet::receiveAddress(uint32_t pointer)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto i = m_subaccounts.find(pointer);
+    if (i == m_subaccounts.end()) return nullptr;
+    auto& subaccount = i->second;
+    const uint32_t address_pointer = subaccount.next_address++;
+    return {
+        { "address", makeAddress(subaccount, address_pointer) },
+        { "address_type", AddressType(subaccount.data) },
+        { "pointer", address_pointer },
+        { "subaccount", pointer },
+    };
+}
+
+json MockWallet::assets()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    json assets = json::object();
+    for (size_t i = 0; i < m_assets.size(); ++i) {
+        const auto& id = m_assets[i];
+        assets[id] = {
+            { "asset_id", id },
+            { "name", "Mock Asset " + std::to_string(i + 1) },
+            { "ticker", "MA" + std::to_string(i + 1) },
+            { "precision", int(i % 9) },
+            { "entity", {{ "domain", "example.com" }} },
+        };
+    }
+    return {{ "assets", assets }, { "icons", json::object() }};
+}
+
+json MockWallet::settings()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_settings;
+}
+
+void MockWallet::setSettings(const json& settings)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_settings.update(settings);
+}
+
+bool MockWallet::setMemo(const std::string& txhash, const std::string& memo)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& [pointer, subaccount] : m_subaccounts) {
+        for (auto& transaction : subaccount.transactions) {
+            if (transaction["txhash"] == txhash) {
+                transaction["memo"] = memo;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+uint32_t MockWallet::blockHeight()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_block_height;
+}
+
+json MockWallet::mineBlock()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto previous_hash = randomHex(32);
+    ++m_block_height;
+    for (auto& [pointer, subaccount] : m_subaccounts) {
+        for (auto& transaction : subaccount.transactions) {
+            if (transaction["block_height"] != 0) break;
+            transaction["block_height"] = m_block_height;
+            transaction["can_rbf"] = false;
+        }
+        for (auto& utxo : subaccount.utxos) {
+            if (utxo["block_height"] != 0) continue;
+            utxo["block_height"] = m_block_height;
+            if (subaccount.data["type"] == "2of2") utxo["expiry_height"] = m_block_height + CSV_BLOCKS;
+        }
+    }
+    return {
+        { "block_height", m_block_height },
+        { "block_hash", randomHex(32) },
+        { "previous_hash", previous_hash },
+    };
+}
+
+json MockWallet::receiveTransaction()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto i = m_subaccounts.begin();
+    std::advance(i, m_random() % m_subaccounts.size());
+    auto& subaccount = i->second;
+
+    auto transaction = makeTransaction(subaccount, 0, true);
+    auto utxo = makeUtxo(subaccount, 0);
+    utxo["txhash"] = transaction["txhash"];
+    utxo["pt_idx"] = 0;
+    utxo["satoshi"] = transaction["outputs"][0]["satoshi"];
+    if (isLiquid()) utxo["asset_id"] = transaction["outputs"][0]["asset_id"];
+    subaccount.transactions.insert(subaccount.transactions.begin(), transaction);
+    subaccount.utxos.push_back(utxo);
+
+    return {
+        { "subaccounts", json::array({ i->first }) },
+        { "txhash", transaction["txhash"] },
+        { "satoshi", utxo["satoshi"] },
+        { "type", "incoming" },
+    };
+}
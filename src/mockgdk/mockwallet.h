@@ -0,0 +1,99 @@
+#ifndef GREEN_MOCKWALLET_H
+#define GREEN_MOCKWALLET_H
+
+#include <nlohmann/json.hpp>
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+// Synthetic wallet served by the mock gdk. The shape of the wallet and the
+// timings come from the environment so that runs are reproducible:
+//   GREEN_MOCK_GDK_SUBACCOUNTS       number of subaccounts (3)
+//   GREEN_MOCK_GDK_TRANSACTIONS      transactions per subaccount (100)
+//   GREEN_MOCK_GDK_UTXOS             unspent outputs per subaccount (50)
+//   GREEN_MOCK_GDK_ASSETS            issued assets, liquid networks only (0)
+//   GREEN_MOCK_GDK_LATENCY           milliseconds per auth handler call (50)
+//   GREEN_MOCK_GDK_BLOCK_INTERVAL    milliseconds between block notifications, 0 disables (0)
+//   GREEN_MOCK_GDK_TX_INTERVAL       milliseconds between incoming transactions, 0 disables (0)
+//   GREEN_MOCK_GDK_SEED              random seed (0)
+struct MockConfig
+{
+    int subaccounts{3};
+    int transactions{100};
+    int utxos{50};
+    int assets{0};
+    int latency{50};
+    int block_interval{0};
+    int tx_interval{0};
+    uint64_t seed{0};
+
+    static MockConfig fromEnvironment();
+};
+
+class MockWallet
+{
+public:
+    MockWallet(const MockConfig& config, const nlohmann::json& network);
+
+    const MockConfig& config() const { return m_config; }
+    const nlohmann::json& network() const { return m_network; }
+    bool isLiquid() const;
+    std::string policyAsset() const;
+
+    // all accessors are thread safe, results are copies
+    nlohmann::json subaccounts();
+    nlohmann::json subaccount(uint32_t pointer);
+    nlohmann::json createSubaccount(const nlohmann::json& details);
+    bool renameSubaccount(uint32_t pointer, const std::string& name);
+    bool updateSubaccount(const nlohmann::json& details);
+    nlohmann::json transactions(uint32_t pointer, size_t first, size_t count);
+    nlohmann::json unspentOutputs(uint32_t pointer, uint32_t num_confs);
+    nlohmann::json balance(uint32_t pointer, uint32_t num_confs);
+    nlohmann::json previousAddresses(uint32_t pointer, int last_pointer);
+    nlohmann::json receiveAddress(uint32_t pointer);
+    nlohmann::json assets();
+    nlohmann::json settings();
+    void setSettings(const nlohmann::json& settings);
+    bool setMemo(const std::string& txhash, const std::string& memo);
+    uint32_t blockHeight();
+
+    // advances the chain, confirms pending transactions and returns the block
+    // notification payload
+    nlohmann::json mineBlock();
+    // adds an unconfirmed incoming transaction to a random subaccount and
+    // returns the transaction notification payload
+    nlohmann::json receiveTransaction();
+
+private:
+    struct Subaccount {
+        nlohmann::json data;
+        // newest first, as gdk returns them
+        std::vector<nlohmann::json> transactions;
+        std::vector<nlohmann::json> utxos;
+        uint32_t next_address{1};
+    };
+
+    Subaccount& addSubaccount(const std::string& name, const std::string& type);
+    nlohmann::json makeTransaction(Subaccount& subaccount, uint32_t block_height, bool incoming);
+    nlohmann::json makeUtxo(Subaccount& subaccount, uint32_t block_height);
+    std::string randomAsset();
+    std::string randomHex(size_t bytes);
+    std::string makeAddress(const Subaccount& subaccount, uint32_t pointer) const;
+    int64_t randomAmount();
+    nlohmann::json balanceLocked(const Subaccount& subaccount, uint32_t num_confs) const;
+
+    const MockConfig m_config;
+    const nlohmann::json m_network;
+    std::mutex m_mutex;
+    std::mt19937_64 m_random;
+    uint32_t m_block_height{700000};
+    std::map<uint32_t, Subaccount> m_subaccounts;
+    std::vector<std::string> m_assets;
+    nlohmann::json m_settings;
+};
+
+#endif // GREEN_MOCKWALLET_H
@@ -0,0 +1,130 @@
+#include "modelbenchmark.h"
+
+#include "account.h"
+#include "accountlistmodel.h"
+#include "addresslistmodel.h"
+#include "addresslistmodelfilter.h"
+#include "outputlistmodel.h"
+#include "outputlistmodelfilter.h"
+#include "transactionlistmodel.h"
+#include "wallet.h"
+
+#include <QDebug>
+
+void ModelBenchmark::run()
+{
+    benchmarkAccounts();
+    for (auto account : wallet()->m_accounts) {
+        benchmarkTransactions(account);
+        benchmarkOutputs(account);
+        benchmarkAddresses(account);
+    }
+}
+
+void ModelBenchmark::benchmarkAccounts()
+{
+    AccountListModel model;
+    const auto rows = [&] { return model.rowCount(); };
+    measure("accounts", nullptr, "load", [&] { model.setWallet(wallet()); }, [] { return true; }, rows);
+    measure("accounts", nullptr, "filter", [&] { model.setFilter("!hidden"); }, [] { return true; }, rows);
+    measure("accounts", nullptr, "reload", [&] { wallet()->reload(true); }, [&] { return !wallet()->hasActivities(); }, rows);
+}
+
+void ModelBenchmark::benchmarkTransactions(Account* account)
+{
+    TransactionListModel model;
+    TransactionFilterProxyModel filter;
+    const auto rows = [&] { return model.rowCount(); };
+    const auto filtered_rows = [&] { return filter.rowCount(); };
+    // fetches the next page each time the previous one arrives
+    const auto fetch_all = [&] {
+        if (model.fetching()) return false;
+        if (!model.canFetchMore({})) return true;
+        model.fetchMore({});
+        return false;
+    };
+    bool reloaded = false;
+    QObject scope;
+    connect(&model, &TransactionListModel::fetchingChanged, &scope, [&] {
+        if (!model.fetching()) reloaded = true;
+    });
+
+    measure("transactions", account, "first page", [&] { model.setAccount(account); }, [&] { return !model.fetching(); }, rows);
+    measure("transactions", account, "load", [] {}, fetch_all, rows);
+    measure("transactions", account, "proxy", [&] { filter.setModel(&model); }, [] { return true; }, filtered_rows);
+    measure("transactions", account, "filter", [&] { filter.setFilter("ff"); }, [&] { return !model.fetching(); }, filtered_rows);
+    measure("transactions", account, "clear filter", [&] { filter.setFilter({}); }, [] { return true; }, filtered_rows);
+    // includes the 200 ms debounce of the reload timer
+    measure("transactions", account, "reload", [&] { reloaded = false; model.reload(); }, [&] { return reloaded; }, rows);
+}
+
+void ModelBenchmark::benchmarkOutputs(Account* account)
+{
+    OutputListModel model;
+    OutputListModelFilter filter;
+    const auto rows = [&] { return model.rowCount(); };
+    const auto filtered_rows = [&] { return filter.rowCount(); };
+
+    measure("outputs", account, "load", [&] { model.setAccount(account); }, [&] { return !model.fetching(); }, rows);
+    // the filter sorts by block height when the model is set
+    measure("outputs", account, "proxy", [&] { filter.setModel(&model); }, [] { return true; }, filtered_rows);
+    measure("outputs", account, "filter", [&] { filter.setFilter("!locked p2wsh"); }, [] { return true; }, filtered_rows);
+    measure("outputs", account, "clear filter", [&] { filter.setFilter({}); }, [] { return true; }, filtered_rows);
+    measure("outputs", account, "sort", [&] { filter.sort(0, Qt::AscendingOrder); }, [] { return true; }, filtered_rows);
+    measure("outputs", account, "reload", [&] { model.fetch(); }, [&] { return !model.fetching(); }, rows);
+}
+
+void ModelBenchmark::benchmarkAddresses(Account* account)
+{
+    AddressListModel model;
+    AddressListModelFilter filter;
+    const auto rows = [&] { return model.rowCount(); };
+    const auto filtered_rows = [&] { return filter.rowCount(); };
+    const auto fetch_all = [&] {
+        if (model.fetching()) return false;
+        if (!model.canFetchMore({})) return true;
+        model.fetchMore({});
+        return false;
+    };
+    bool reloaded = false;
+    QObject scope;
+    connect(&model, &AddressListModel::fetchingChanged, &scope, [&](bool fetching) {
+        if (!fetching) reloaded = true;
+    });
+
+    measure("addresses", account, "load", [&] { model.setAccount(account); }, fetch_all, rows);
+    measure("addresses", account, "proxy", [&] { filter.setModel(&model); }, [] { return true; }, filtered_rows);
+    measure("addresses", account, "filter", [&] { filter.setFilter("ff"); }, [] { return true; }, filtered_rows);
+    measure("addresses", account, "clear filter", [&] { filter.setFilter({}); }, [] { return true; }, filtered_rows);
+    measure("addresses", account, "sort", [&] {
+        filter.setSortRole(AddressListModel::CountRole);
+        filter.sort(0, Qt::DescendingOrder);
+    }, [] { return true; }, filtered_rows);
+    // includes the 200 ms debounce of the reload timer
+    measure("addresses", account, "reload", [&] { reloaded = false; model.reload(); }, [&] { return reloaded; }, rows);
+}
+
+bool ModelBenchmark::measure(const QString& model, Account* account, const QString& step, const std::function<void()>& run, const std::function<bool()>& done, const std::function<int()>& rows)
+{
+    const auto peak_before = peakMemory();
+    m_timer.start();
+    run();
+    const bool finished = wait(done);
+    const double duration = m_timer.nsecsElapsed() / 1e6;
+    const auto peak = peakMemory();
+
+    QJsonObject result{
+        { "model", model },
+        { "step", step },
+        { "rows", rows() },
+        { "ms", duration },
+        { "peak_rss_kb", peak },
+        { "peak_rss_growth_kb", peak - peak_before },
+    };
+    if (account) result.insert("account", static_cast<qint64>(account->pointer()));
+    if (!finished) result.insert("timeout", true);
+    qInfo().noquote() << "benchmark:" << model << (account ? QString::number(account->pointer()) : QString()) << step
+                      << result.value("rows").toInt() << "rows" << duration << "ms, peak rss" << peak << "KiB";
+    addResult(result);
+    return finished;
+}
@@ -0,0 +1,31 @@
+#ifndef GREEN_MODELBENCHMARK_H
+#define GREEN_MODELBENCHMARK_H
+
+#include "benchmark.h"
+
+#include <QElapsedTimer>
+
+QT_FORWARD_DECLARE_CLASS(Account)
+
+// Drives the list models and their filter proxies without the UI and records
+// the duration, row count and peak memory of each step. Started with
+// --benchmark <file>.
+class ModelBenchmark : public Benchmark
+{
+    Q_OBJECT
+public:
+    using Benchmark::Benchmark;
+protected:
+    void run() override;
+private:
+    void benchmarkAccounts();
+    void benchmarkTransactions(Account* account);
+    void benchmarkOutputs(Account* account);
+    void benchmarkAddresses(Account* account);
+    // runs the step and processes events until done returns true
+    bool measure(const QString& model, Account* account, const QString& step, const std::function<void()>& run, const std::function<bool()>& done, const std::function<int()>& rows);
+private:
+    QElapsedTimer m_timer;
+};
+
+#endif // GREEN_MODELBENCHMARK_H
@@ -0,0 +1,195 @@
+#include "viewbenchmark.h"
+
+#include "account.h"
+#include "wallet.h"
+
+#include <QAbstractItemModel>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QQmlComponent>
+#include <QQmlContext>
+#include <QQmlEngine>
+#include <QQuickItem>
+#include <QQuickWindow>
+#include <QSet>
+#include <QSortFilterProxyModel>
+#include <QTimer>
+
+#include <algorithm>
+
+namespace {
+
+// frames per scroll run and the distance scrolled on each frame, roughly a
+// fast fling at 60 fps
+const int SCROLL_FRAMES = 300;
+const qreal SCROLL_STEP = 120;
+
+QJsonObject Summary(QVector<double> values)
+{
+    if (values.isEmpty()) return {};
+    std::sort(values.begin(), values.end());
+    const auto percentile = [&](double p) {
+        return values.at(std::min<int>(values.size() - 1, p * values.size()));
+    };
+    double total = 0;
+    for (auto value : values) total += value;
+    return {
+        { "mean", total / values.size() },
+        { "p50", percentile(0.5) },
+        { "p95", percentile(0.95) },
+        { "p99", percentile(0.99) },
+        { "max", values.last() },
+    };
+}
+
+QQuickItem* FindListView(QQuickItem* view)
+{
+    for (auto item : view->findChildren<QQuickItem*>()) {
+        if (!item->inherits("QQuickListView")) continue;
+        if (qobject_cast<QAbstractItemModel*>(item->property("model").value<QObject*>())) return item;
+    }
+    return nullptr;
+}
+
+} // namespace
+
+ViewBenchmark::ViewBenchmark(QQmlEngine* engine, QObject* root, const QString& network_id, const QString& file_name, QObject* parent)
+    : Benchmark(network_id, file_name, parent)
+    , m_engine(engine)
+    , m_root(root)
+{
+}
+
+void ViewBenchmark::run()
+{
+    QQuickWindow window;
+    window.setTitle(QStringLiteral("benchmark"));
+    window.resize(1280, 800);
+    window.show();
+    for (auto account : wallet()->m_accounts) {
+        for (auto name : { "TransactionListView", "OutputsListView", "AddressesListView" }) {
+            benchmarkView(&window, name, account);
+        }
+    }
+}
+
+void ViewBenchmark::benchmarkView(QQuickWindow* window, const QString& name, Account* account)
+{
+    QQmlComponent component(m_engine, QUrl(name + ".qml"));
+    if (component.isError()) {
+        qWarning() << "benchmark:" << component.errors();
+        return;
+    }
+
+    // connections made with this context are dropped when the view is done
+    QObject scope;
+    const auto peak_before = peakMemory();
+    QElapsedTimer timer;
+    timer.start();
+
+    auto view = qobject_cast<QQuickItem*>(component.createWithInitialProperties({{ "account", QVariant::fromValue(account) }}, qmlContext(m_root)));
+    if (!view) {
+        qWarning() << "benchmark: failed to create" << name << component.errors();
+        return;
+    }
+    view->setParentItem(window->contentItem());
+    view->setSize(window->size());
+
+    auto list = FindListView(view);
+    auto proxy = list ? qobject_cast<QSortFilterProxyModel*>(list->property("model").value<QObject*>()) : nullptr;
+    auto model = proxy ? proxy->sourceModel() : nullptr;
+    auto content = list ? list->property("contentItem").value<QQuickItem*>() : nullptr;
+    if (!model || !content) {
+        qWarning() << "benchmark: no list view in" << name;
+        delete view;
+        return;
+    }
+
+    // delegates are parented to the content item, count the new children
+    int delegates = 0;
+    QSet<QQuickItem*> children;
+    connect(content, &QQuickItem::childrenChanged, &scope, [&] {
+        const auto items = content->childItems();
+        const QSet<QQuickItem*> current(items.begin(), items.end());
+        delegates += (current - children).size();
+        children = current;
+    });
+
+    bool swapped = false;
+    bool scrolling = false;
+    QVector<double> frame_times;
+    QVector<double> render_times;
+    qint64 step_start = 0;
+    qint64 sync_start = 0;
+    const auto fetching = [&] { return model->property("fetching").toBool(); };
+    const auto step = [&] {
+        step_start = timer.nsecsElapsed();
+        list->setProperty("contentY", list->property("contentY").toReal() + SCROLL_STEP);
+    };
+    connect(window, &QQuickWindow::beforeSynchronizing, &scope, [&] {
+        sync_start = timer.nsecsElapsed();
+    }, Qt::DirectConnection);
+    connect(window, &QQuickWindow::frameSwapped, &scope, [&] {
+        swapped = true;
+        if (!scrolling) return;
+        const auto now = timer.nsecsElapsed();
+        frame_times.append((now - step_start) / 1e6);
+        render_times.append((now - sync_start) / 1e6);
+        if (frame_times.size() >= SCROLL_FRAMES || list->property("atYEnd").toBool()) {
+            scrolling = false;
+            return;
+        }
+        QTimer::singleShot(0, &scope, step);
+    }, Qt::DirectConnection);
+
+    const auto report = [&](const QString& step, double duration, bool finished) {
+        const auto peak = peakMemory();
+        QJsonObject result{
+            { "view", name },
+            { "account", static_cast<qint64>(account->pointer()) },
+            { "step", step },
+            { "rows", list->property("count").toInt() },
+            { "ms", duration },
+            { "delegates_created", delegates },
+            { "delegates_live", children.size() },
+            { "peak_rss_kb", peak },
+            { "peak_rss_growth_kb", peak - peak_before },
+        };
+        if (!frame_times.isEmpty()) {
+            result.insert("frames", frame_times.size());
+            result.insert("frame_ms", Summary(frame_times));
+            result.insert("render_ms", Summary(render_times));
+        }
+        if (!finished) result.insert("timeout", true);
+        qInfo().noquote() << "benchmark:" << name << account->pointer() << step << result.value("rows").toInt() << "rows"
+                          << duration << "ms," << delegates << "delegates, peak rss" << peak << "KiB";
+        addResult(result);
+    };
+
+    // first frame with the first page of data
+    bool finished = wait([&] { return !fetching(); });
+    swapped = false;
+    window->update();
+    finished = wait([&] { return swapped; }) && finished;
+    report("create", timer.nsecsElapsed() / 1e6, finished);
+
+    // fetch the remaining pages so that scrolling doesn't wait for data
+    timer.restart();
+    delegates = 0;
+    finished = wait([&] {
+        if (fetching()) return false;
+        if (!model->canFetchMore({})) return true;
+        model->fetchMore({});
+        return false;
+    });
+    report("load", timer.nsecsElapsed() / 1e6, finished);
+
+    timer.restart();
+    delegates = 0;
+    scrolling = true;
+    step();
+    finished = wait([&] { return !scrolling; });
+    report("scroll", timer.nsecsElapsed() / 1e6, finished);
+
+    delete view;
+}
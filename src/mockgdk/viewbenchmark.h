@@ -0,0 +1,31 @@
+#ifndef GREEN_VIEWBENCHMARK_H
+#define GREEN_VIEWBENCHMARK_H
+
+#include "benchmark.h"
+
+QT_FORWARD_DECLARE_CLASS(Account)
+QT_FORWARD_DECLARE_CLASS(QQmlEngine)
+QT_FORWARD_DECLARE_CLASS(QQuickItem)
+QT_FORWARD_DECLARE_CLASS(QQuickWindow)
+
+// Loads the transaction, output and address list views in a window of their
+// own and scrolls them programmatically, recording frame times, delegate
+// instantiations and peak memory. The views are created in the context of
+// the main window so that they resolve constants and helpers as in the app.
+// Meant to run with the software scene graph backend on the offscreen
+// platform, started with --benchmarkviews <file>.
+class ViewBenchmark : public Benchmark
+{
+    Q_OBJECT
+public:
+    ViewBenchmark(QQmlEngine* engine, QObject* root, const QString& network_id, const QString& file_name, QObject* parent = nullptr);
+protected:
+    void run() override;
+private:
+    void benchmarkView(QQuickWindow* window, const QString& name, Account* account);
+private:
+    QQmlEngine* const m_engine;
+    QObject* const m_root;
+};
+
+#endif // GREEN_VIEWBENCHMARK_H
@@ -1,6 +1,7 @@
 #include "network.h"
 #include "networkmanager.h"
 #include "ga.h"
+#include "gdkrecorder.h"
 #include "json.h"
 
 #include <gdk.h>
@@ -8,7 +9,7 @@
 static QJsonObject get_networks()
 {
     GA_json* output;
-    int err = GA_get_networks(&output);
+    int err = GDK_CALL(GA_get_networks, &output);
     Q_ASSERT(err == GA_OK);
     auto networks = Json::toObject(output);
     err = GA_destroy_json(output);
@@ -1,5 +1,6 @@
 #include "renameaccountcontroller.h"
 #include "account.h"
+#include "gdkrecorder.h"
 #include "json.h"
 #include "wallet.h"
 
@@ -13,7 +14,7 @@ RenameAccountController::RenameAccountController(QObject* parent)
 void RenameAccountController::rename(const QString& name)
 {
     if (!account()) return;
-    int res = GA_rename_subaccount(session(), account()->pointer(), name.toUtf8().constData());
+    int res = GDK_CALL(GA_rename_subaccount, session(), account()->pointer(), name.toUtf8().constData());
     Q_ASSERT(res == GA_OK);
     wallet()->reload();
 }
@@ -0,0 +1,100 @@
+#ifndef GREEN_RINGBUFFER_H
+#define GREEN_RINGBUFFER_H
+
+#include <QtGlobal>
+
+#include <array>
+#include <atomic>
+#include <utility>
+
+// Fixed capacity lock-free queue for exactly one producer thread and one
+// consumer thread. Capacity must be a power of two.
+template <typename T, quint32 N>
+class RingBuffer
+{
+    static_assert(N > 0 && (N & (N - 1)) == 0, "capacity must be a power of two");
+public:
+    bool push(T value)
+    {
+        const auto head = m_head.load(std::memory_order_relaxed);
+        const auto tail = m_tail.load(std::memory_order_acquire);
+        if (head - tail == N) return false;
+        m_items[head & (N - 1)] = std::move(value);
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+    bool pop(T& value)
+    {
+        const auto tail = m_tail.load(std::memory_order_relaxed);
+        const auto head = m_head.load(std::memory_order_acquire);
+        if (head == tail) return false;
+        value = std::move(m_items[tail & (N - 1)]);
+        m_items[tail & (N - 1)] = T();
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+    bool isEmpty() const
+    {
+        return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+    }
+private:
+    std::array<T, N> m_items;
+    alignas(64) std::atomic<quint32> m_head{0};
+    alignas(64) std::atomic<quint32> m_tail{0};
+};
+
+// Fixed capacity lock-free queue for any number of producer threads and
+// exactly one consumer thread. Each slot carries a sequence number so that
+// producers claim slots with a single compare and swap. Capacity must be a
+// power of two.
+template <typename T, quint32 N>
+class MpscRingBuffer
+{
+    static_assert(N > 0 && (N & (N - 1)) == 0, "capacity must be a power of two");
+public:
+    MpscRingBuffer()
+    {
+        for (quint32 i = 0; i < N; ++i) m_cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    bool push(T value)
+    {
+        auto head = m_head.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &m_cells[head & (N - 1)];
+            const auto sequence = cell->sequence.load(std::memory_order_acquire);
+            const auto diff = qint32(sequence - head);
+            if (diff == 0) {
+                if (m_head.compare_exchange_weak(head, head + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;
+            } else {
+                head = m_head.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = std::move(value);
+        cell->sequence.store(head + 1, std::memory_order_release);
+        return true;
+    }
+    bool pop(T& value)
+    {
+        Cell& cell = m_cells[m_tail & (N - 1)];
+        const auto sequence = cell.sequence.load(std::memory_order_acquire);
+        if (qint32(sequence - (m_tail + 1)) < 0) return false;
+        value = std::move(cell.value);
+        cell.value = T();
+        cell.sequence.store(m_tail + N, std::memory_order_release);
+        ++m_tail;
+        return true;
+    }
+private:
+    struct Cell {
+        std::atomic<quint32> sequence;
+        T value;
+    };
+    std::array<Cell, N> m_cells;
+    alignas(64) std::atomic<quint32> m_head{0};
+    alignas(64) quint32 m_tail{0};
+};
+
+#endif // GREEN_RINGBUFFER_H
@@ -1,3 +1,4 @@
+#include "gdkrecorder.h"
 #include "handlers/connecthandler.h"
 #include "json.h"
 #include "network.h"
@@ -8,6 +9,8 @@
 #include <QMutexLocker>
 #include <QtConcurrentRun>
 
+#include <algorithm>
+
 #include <gdk.h>
 
 namespace  {
@@ -97,11 +100,12 @@ void Session::setActive(bool active)
 void Session::update()
 {
     if (m_active && !m_session) {
-        int rc = GA_create_session(&m_session);
+        int rc = GDK_CALL(GA_create_session, &m_session);
         Q_ASSERT(rc == GA_OK);
 
         rc = GA_set_notification_handler(m_session, [](void* context, GA_json* details) {
             auto session = reinterpret_cast<Session*>(context);
+            GdkRecorder::notification(session->m_session, details);
             auto notification = Json::toObject(details);
 
             GA_destroy_json(details);
@@ -132,16 +136,27 @@ void Session::update()
         m_connect_handler.destroy();
 
         GA_set_notification_handler(m_session, nullptr, nullptr);
-        QtConcurrent::run([=] {
-            int rc = GA_destroy_session(m_session);
+        QtConcurrent::run([session = m_session, pending_calls = m_pending_calls] {
+            for (auto future : pending_calls) future.waitForFinished();
+            int rc = GDK_CALL(GA_destroy_session, session);
             Q_ASSERT(rc == GA_OK);
         });
+        m_pending_calls.clear();
 
         m_session = nullptr;
         return;
     }
 }
 
+void Session::addPendingCall(const QFuture<void>& future)
+{
+    Q_ASSERT(m_session);
+    m_pending_calls.erase(std::remove_if(m_pending_calls.begin(), m_pending_calls.end(), [](const QFuture<void>& future) {
+        return future.isFinished();
+    }), m_pending_calls.end());
+    m_pending_calls.append(future);
+}
+
 SessionActivity::SessionActivity(QObject* parent)
     : Activity(parent)
 {
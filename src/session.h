@@ -6,6 +6,7 @@
 #include "entity.h"
 
 #include <QtQml>
+#include <QFuture>
 #include <QObject>
 
 QT_FORWARD_DECLARE_CLASS(ConnectHandler);
@@ -48,6 +49,9 @@ public:
     bool isConnecting() const { return m_connecting; }
     QList<QJsonObject> events() const { return m_events; }
     QJsonObject event() const { return m_event; }
+    // work running on the GA_session outside of handlers, the session is
+    // only destroyed once it finishes
+    void addPendingCall(const QFuture<void>& future);
 signals:
     void notificationHandled(const QJsonObject& notification);
     void activeChanged(bool active);
@@ -71,6 +75,7 @@ private:
     bool const m_enable_spv;
     QString const m_electrum_url;
     bool m_active{false};
+    QList<QFuture<void>> m_pending_calls;
 public:
     // TODO: make m_session private
     GA_session* m_session{nullptr};
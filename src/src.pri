@@ -9,6 +9,7 @@ SOURCES += \
     $$PWD/addresslistmodel.cpp \
     $$PWD/addresslistmodelfilter.cpp \
     $$PWD/appupdatecontroller.cpp \
+    $$PWD/automationserver.cpp \
     $$PWD/asset.cpp \
     $$PWD/balance.cpp \
     $$PWD/blogcontroller.cpp \
@@ -16,6 +17,7 @@ SOURCES += \
     $$PWD/command.cpp \
     $$PWD/controller.cpp \
     $$PWD/createaccountcontroller.cpp \
+    $$PWD/derivationcache.cpp \
     $$PWD/device.cpp \
     $$PWD/devicediscoveryagent.cpp \
     $$PWD/devicediscoveryagent_linux.cpp \
@@ -25,13 +27,16 @@ SOURCES += \
     $$PWD/devicemanager.cpp \
     $$PWD/entity.cpp \
     $$PWD/ga.cpp \
+    $$PWD/gdkrecorder.cpp \
     $$PWD/httpmanager.cpp \
     $$PWD/httprequestactivity.cpp \
     $$PWD/json.cpp \
+    $$PWD/logger.cpp \
     $$PWD/main.cpp \
     $$PWD/navigation.cpp \
     $$PWD/network.cpp \
     $$PWD/networkmanager.cpp \
+    $$PWD/once_win.cpp \
     $$PWD/renameaccountcontroller.cpp \
     $$PWD/resolver.cpp \
     $$PWD/restorecontroller.cpp \
@@ -42,6 +47,7 @@ SOURCES += \
     $$PWD/output.cpp \
     $$PWD/outputlistmodel.cpp \
     $$PWD/outputlistmodelfilter.cpp \
+    $$PWD/trace.cpp \
     $$PWD/transaction.cpp \
     $$PWD/transactionlistmodel.cpp \
     $$PWD/twofactorcontroller.cpp \
@@ -61,6 +67,7 @@ HEADERS += \
     $$PWD/addresslistmodel.h \
     $$PWD/addresslistmodelfilter.h \
     $$PWD/appupdatecontroller.h \
+    $$PWD/automationserver.h \
     $$PWD/asset.h \
     $$PWD/balance.h \
     $$PWD/blogcontroller.h \
@@ -69,6 +76,7 @@ HEADERS += \
     $$PWD/connectable.h \
     $$PWD/controller.h \
     $$PWD/createaccountcontroller.h \
+    $$PWD/derivationcache.h \
     $$PWD/device.h \
     $$PWD/device_p.h \
     $$PWD/devicediscoveryagent.h \
@@ -79,9 +87,11 @@ HEADERS += \
     $$PWD/devicemanager.h \
     $$PWD/entity.h \
     $$PWD/ga.h \
+    $$PWD/gdkrecorder.h \
     $$PWD/httpmanager.h \
     $$PWD/httprequestactivity.h \
     $$PWD/json.h \
+    $$PWD/logger.h \
     $$PWD/navigation.h \
     $$PWD/network.h \
     $$PWD/networkmanager.h \
@@ -90,11 +100,13 @@ HEADERS += \
     $$PWD/restorecontroller.h \
     $$PWD/semver.h \
     $$PWD/session.h \
+    $$PWD/ringbuffer.h \
     $$PWD/settings.h \
     $$PWD/signupcontroller.h \
     $$PWD/output.h \
     $$PWD/outputlistmodel.h \
     $$PWD/outputlistmodelfilter.h \
+    $$PWD/trace.h \
     $$PWD/transaction.h \
     $$PWD/transactionlistmodel.h \
     $$PWD/twofactorcontroller.h \
@@ -112,6 +124,10 @@ include(resolvers/resolvers.pri)
 include(jade/jade.pri)
 include(ledger/ledger.pri)
 
+mockgdk {
+    include(mockgdk/mockgdk.pri)
+}
+
 win32 {
     RESOURCES += $$PWD/win.qrc
 } else {
@@ -0,0 +1,92 @@
+#include "trace.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonDocument>
+#include <QMutex>
+#include <QThread>
+
+#define TRACE_FLUSH_SIZE (64 * 1024)
+
+std::atomic<bool> Trace::s_enabled{false};
+
+namespace {
+
+QMutex g_mutex;
+QFile g_file;
+QByteArray g_buffer;
+QElapsedTimer g_clock;
+
+void Flush()
+{
+    g_file.write(g_buffer);
+    g_file.flush();
+    g_buffer.resize(0);
+}
+
+} // namespace
+
+void Trace::open(const QString& file_name)
+{
+    QMutexLocker locker(&g_mutex);
+    if (g_file.isOpen()) return;
+    g_file.setFileName(file_name);
+    if (!g_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "trace: failed to open" << file_name;
+        return;
+    }
+    // the closing bracket is optional in the array format, so the file is
+    // usable even if the process doesn't exit cleanly
+    g_buffer.reserve(TRACE_FLUSH_SIZE * 2);
+    g_buffer.append("[\n");
+    g_clock.start();
+    s_enabled = true;
+    qInfo() << "trace: writing to" << file_name;
+}
+
+void Trace::close()
+{
+    QMutexLocker locker(&g_mutex);
+    if (!g_file.isOpen()) return;
+    s_enabled = false;
+    Flush();
+    g_file.close();
+}
+
+void Trace::begin(const char* category, const QString& name, quintptr id, const QJsonObject& args)
+{
+    event('b', category, name, id, args);
+}
+
+void Trace::end(const char* category, const QString& name, quintptr id, const QJsonObject& args)
+{
+    event('e', category, name, id, args);
+}
+
+void Trace::instant(const char* category, const QString& name, quintptr id, const QJsonObject& args)
+{
+    event('n', category, name, id, args);
+}
+
+void Trace::event(char phase, const char* category, const QString& name, quintptr id, const QJsonObject& args)
+{
+    if (!enabled()) return;
+    QJsonObject event{
+        { "name", name },
+        { "cat", category },
+        { "ph", QString(QChar(phase)) },
+        { "id", QString::number(id, 16).prepend("0x") },
+        { "pid", QCoreApplication::applicationPid() },
+        { "tid", QString::number(reinterpret_cast<quintptr>(QThread::currentThreadId())) },
+    };
+    if (!args.isEmpty()) event.insert("args", args);
+
+    QMutexLocker locker(&g_mutex);
+    if (!g_file.isOpen()) return;
+    event.insert("ts", double(g_clock.nsecsElapsed()) / 1000);
+    g_buffer.append(QJsonDocument(event).toJson(QJsonDocument::Compact));
+    g_buffer.append(",\n");
+    if (g_buffer.size() >= TRACE_FLUSH_SIZE) Flush();
+}
@@ -0,0 +1,29 @@
+#ifndef GREEN_TRACE_H
+#define GREEN_TRACE_H
+
+#include <QJsonObject>
+#include <QString>
+
+#include <atomic>
+
+// Opt-in tracing in the Chrome trace event format, load the file in
+// chrome://tracing or Perfetto. Spans are async events keyed by category and
+// id so they can start and end on different threads. Call sites check
+// enabled() first, so disabled tracing costs a relaxed atomic load.
+class Trace
+{
+public:
+    static void open(const QString& file_name);
+    static void close();
+    static bool enabled() { return s_enabled.load(std::memory_order_relaxed); }
+    static void begin(const char* category, const QString& name, quintptr id, const QJsonObject& args = {});
+    static void end(const char* category, const QString& name, quintptr id, const QJsonObject& args = {});
+    static void instant(const char* category, const QString& name, quintptr id, const QJsonObject& args = {});
+    template <typename T>
+    static quintptr id(const T* object) { return reinterpret_cast<quintptr>(object); }
+private:
+    static void event(char phase, const char* category, const QString& name, quintptr id, const QJsonObject& args);
+    static std::atomic<bool> s_enabled;
+};
+
+#endif // GREEN_TRACE_H
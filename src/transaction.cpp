@@ -1,5 +1,6 @@
 #include "account.h"
 #include "asset.h"
+#include "gdkrecorder.h"
 #include "json.h"
 #include "network.h"
 #include "session.h"
@@ -176,7 +177,7 @@ void Transaction::updateMemo(const QString& memo)
     Q_ASSERT(memo.length() <= 1024);
     if (m_memo == memo) return;
     auto txhash = m_data.value("txhash").toString().toLocal8Bit();
-    int err = GA_set_transaction_memo(m_account->wallet()->m_session->m_session, txhash.constData(), memo.toUtf8().constData(), 0);
+    int err = GDK_CALL(GA_set_transaction_memo, m_account->wallet()->m_session->m_session, txhash.constData(), memo.toUtf8().constData(), 0);
     Q_ASSERT(err == GA_OK);
     setMemo(memo);
 }
@@ -1,8 +1,10 @@
 #include "account.h"
+#include "activitymanager.h"
 #include "asset.h"
 #include "balance.h"
 #include "ga.h"
 #include "device.h"
+#include "gdkrecorder.h"
 #include "json.h"
 #include "createaccounthandler.h"
 #include "loginhandler.h"
@@ -25,6 +27,7 @@
 #include <QUuid>
 
 #include <gdk.h>
+#include <wally_bip32.h>
 
 class ReloginHandler : public Handler
 {
@@ -33,7 +36,7 @@ public:
     void call(GA_session* session, GA_auth_handler** auth_handler) override
     {
         QJsonObject hw_device, details;
-        GA_login_user(session, Json::fromObject(hw_device).get(), Json::fromObject(details).get(), auth_handler);
+        GDK_CALL(GA_login_user, session, Json::fromObject(hw_device).get(), Json::fromObject(details).get(), auth_handler);
     }
 };
 
@@ -59,6 +62,7 @@ void Wallet::disconnect()
     auto accounts = m_accounts;
     m_accounts.clear();
     m_accounts_by_pointer.clear();
+    m_prefetched_accounts.clear();
     emit accountsChanged();
 
     m_settings = {};
@@ -230,6 +234,7 @@ void Wallet::reload(bool refresh_accounts)
 
         updateConfig();
         updateEmpty();
+        prefetchDevicePublicKeys();
 
         if (m_network->isLiquid()) {
             // Update cached assets
@@ -238,7 +243,7 @@ void Wallet::reload(bool refresh_accounts)
 
         if (!m_watch_only) {
             char* data;
-            GA_get_watch_only_username(m_session->m_session, &data);
+            GDK_CALL(GA_get_watch_only_username, m_session->m_session, &data);
             auto username = QString::fromUtf8(data);
             GA_destroy_string(data);
             if (m_username != username) {
@@ -277,7 +282,7 @@ public:
             { "refresh", m_refresh }
         });
         GA_json* output;
-        int rc = GA_refresh_assets(session, params.get(), &output);
+        int rc = GDK_CALL(GA_refresh_assets, session, params.get(), &output);
         if (rc != GA_OK) return;
 
         m_assets = Json::toObject(output);
@@ -349,7 +354,7 @@ void Wallet::rename(QString name, bool active_focus)
 void Wallet::setWatchOnly(const QString& username, const QString& password)
 {
     Q_ASSERT(!m_watch_only);
-    int rc = GA_set_watch_only(m_session->m_session, username.toUtf8().constData(), password.toUtf8().constData());
+    int rc = GDK_CALL(GA_set_watch_only, m_session->m_session, username.toUtf8().constData(), password.toUtf8().constData());
     if (rc != GA_OK) return;
     m_username = username;
     emit usernameChanged(m_username);
@@ -450,6 +455,37 @@ void Wallet::setPinData(const QByteArray& pin_data)
     save();
 }
 
+void Wallet::prefetchDevicePublicKeys()
+{
+    // Pull the xpubs gdk asks for when accounts are used, so that those
+    // requests hit the derivation cache instead of waiting on the device.
+    // Runs with background priority, device requests from the user go first.
+    // Each account is prefetched once, the first reload after login covers
+    // the existing accounts and later reloads only the created ones.
+    if (!m_device) return;
+    const uint32_t hardened = BIP32_INITIAL_HARDENED_CHILD;
+    for (auto account : m_accounts) {
+        if (m_prefetched_accounts.contains(account->pointer())) continue;
+        m_prefetched_accounts.insert(account->pointer());
+        QVector<uint32_t> path;
+        if (m_network->isElectrum()) {
+            const auto type = account->type();
+            const uint32_t purpose = type == "p2wpkh" ? 84 : type == "p2sh-p2wpkh" ? 49 : 44;
+            const uint32_t coin_type = !m_network->isMainnet() ? 1 : m_network->isLiquid() ? 1776 : 0;
+            path = { hardened | purpose, hardened | coin_type, hardened | (account->pointer() >> 4) };
+        } else if (account->pointer() > 0) {
+            path = { hardened | 3, hardened | account->pointer() };
+        } else {
+            continue;
+        }
+        auto activity = m_device->getWalletPublicKey(m_network, path);
+        activity->setPriority(DeviceActivity::Priority::Background);
+        QObject::connect(activity, &Activity::finished, activity, &QObject::deleteLater);
+        QObject::connect(activity, &Activity::failed, activity, &QObject::deleteLater);
+        ActivityManager::instance()->exec(activity);
+    }
+}
+
 void Wallet::updateEmpty()
 {
     for (const auto& account : m_accounts_by_pointer.values()) {
@@ -486,7 +522,7 @@ QJsonObject Wallet::convert(const QJsonObject& value) const
 {
     auto details = Json::fromObject(value);
     GA_json* balance;
-    int err = GA_convert_amount(m_session->m_session, details.get(), &balance);
+    int err = GDK_CALL(GA_convert_amount, m_session->m_session, details.get(), &balance);
     if (err != GA_OK) return {};
     QJsonObject result = Json::toObject(balance);
     GA_destroy_json(balance);
@@ -529,7 +565,7 @@ qint64 Wallet::parseAmount(const QString& amount, const QString& unit) const
     sanitized_amount.replace(',', '.');
     auto details = Json::fromObject({{ unit == "\u00B5BTC" ? "ubtc" : unit.toLower(), sanitized_amount }});
     GA_json* balance;
-    int err = GA_convert_amount(m_session->m_session, details.get(), &balance);
+    int err = GDK_CALL(GA_convert_amount, m_session->m_session, details.get(), &balance);
     if (err != GA_OK) return 0;
     QJsonObject result = Json::toObject(balance);
     GA_destroy_json(balance);
@@ -597,6 +633,7 @@ void Wallet::setDevice(Device* device)
 {
     if (m_device == device) return;
     m_device = device;
+    m_prefetched_accounts.clear();
     if (m_device) {
         QObject::connect(m_device, &QObject::destroyed, this, [=] {
             setDevice(nullptr);
@@ -850,7 +887,7 @@ void EncryptWithPinHandler::call(GA_session *session, GA_auth_handler **auth_han
         { "pin", m_pin },
         { "plaintext", m_plaintext }
     });
-    GA_encrypt_with_pin(session, details.get(), auth_handler);
+    GDK_CALL(GA_encrypt_with_pin, session, details.get(), auth_handler);
 }
 
 EncryptWithPinHandler::EncryptWithPinHandler(const QJsonObject& plaintext, const QString& pin, Session* session)
@@ -910,5 +947,5 @@ QString GetCredentialsHandler::mnemonic() const
 void GetCredentialsHandler::call(GA_session *session, GA_auth_handler **auth_handler)
 {
     auto details = Json::fromObject({{"password", ""}});
-    GA_get_credentials(session, details.get(), auth_handler);
+    GDK_CALL(GA_get_credentials, session, details.get(), auth_handler);
 }
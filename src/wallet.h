@@ -10,6 +10,7 @@
 #include <QList>
 #include <QObject>
 #include <QQmlListProperty>
+#include <QSet>
 #include <QThread>
 #include <QJsonObject>
 
@@ -182,6 +183,7 @@ protected:
 private:
     void updateEmpty();
     void setEmpty(bool empty);
+    void prefetchDevicePublicKeys();
 private:
     bool m_ready{false};
     bool m_empty{true};
@@ -209,6 +211,8 @@ public:
     QMap<QString, Asset*> m_assets;
     QList<Account*> m_accounts;
     QMap<int, Account*> m_accounts_by_pointer;
+    // accounts whose device xpubs were already prefetched
+    QSet<int> m_prefetched_accounts;
 
     QByteArray getPinData() const;
     QByteArray m_pin_data;
@@ -0,0 +1,109 @@
+#include "cborbenchmark.h"
+
+#include "jaderequestwriter.h"
+
+#include <QCborMap>
+#include <QCborValue>
+#include <QTest>
+
+namespace {
+
+const QVariantList CHANGE{ QVariant(), QVariantMap{{ "variant", "sh(wpkh(k))" }, { "path", QVariantList{ 2147483697u, 2147483649u, 2147483648u, 1, 7 } }} };
+const QVector<quint32> PATH{ 2147483697u, 2147483649u, 2147483648u, 0, 3 };
+const QByteArray SCRIPT = QByteArray::fromHex("0014751e76e8199196d454941c45d1b3a323f1433bd6");
+const QByteArray COMMITMENT(32, 0x02);
+
+QCborMap Request(const int id, const QString& method, const QCborValue& params)
+{
+    QCborMap request;
+    request.insert(QCborValue("id"), QString::number(id));
+    request.insert(QCborValue("method"), method);
+    request.insert(QCborValue("params"), params);
+    return request;
+}
+
+// transactions from 256 bytes to 1 MiB, with each encoder
+void AddRows()
+{
+    QTest::addColumn<QString>("encoder");
+    QTest::addColumn<int>("size");
+    for (const char* encoder : { "stream", "map" }) {
+        for (int size : { 256, 10 * 1024, 100 * 1024, 1024 * 1024 }) {
+            QTest::addRow("%s/%d", encoder, size) << QString(encoder) << size;
+        }
+    }
+}
+
+} // namespace
+
+void CborBenchmark::signTx_data()
+{
+    AddRows();
+}
+
+void CborBenchmark::signTx()
+{
+    QFETCH(QString, encoder);
+    QFETCH(int, size);
+    const QByteArray txn(size, 0x01);
+    QByteArray buffer;
+
+    if (encoder == "stream") {
+        QBENCHMARK {
+            JadeRequestWriter request(&buffer, 1, "sign_tx", 5);
+            request.appendString("network", "testnet");
+            request.appendBool("use_ae_signatures", true);
+            request.appendBytes("txn", txn);
+            request.appendInteger("num_inputs", 100);
+            request.appendValue("change", CHANGE);
+        }
+    } else {
+        QBENCHMARK {
+            QCborMap params;
+            params.insert(QCborValue("network"), QCborValue("testnet"));
+            params.insert(QCborValue("use_ae_signatures"), true);
+            params.insert(QCborValue("txn"), txn);
+            params.insert(QCborValue("num_inputs"), 100);
+            params.insert(QCborValue("change"), QCborValue::fromVariant(CHANGE));
+            buffer = Request(1, "sign_tx", params).toCborValue().toCbor();
+        }
+    }
+    QVERIFY(buffer.size() > size);
+}
+
+void CborBenchmark::txInput_data()
+{
+    AddRows();
+}
+
+void CborBenchmark::txInput()
+{
+    QFETCH(QString, encoder);
+    QFETCH(int, size);
+    // the previous transaction is sent along with each input
+    const QByteArray txn(size, 0x01);
+    QByteArray buffer;
+
+    if (encoder == "stream") {
+        QBENCHMARK {
+            JadeRequestWriter request(&buffer, 2, "tx_input", 5);
+            request.appendBool("is_witness", true);
+            request.appendBytes("input_tx", txn);
+            request.appendBytes("script", SCRIPT);
+            request.appendPath("path", PATH);
+            request.appendBytes("ae_host_commitment", COMMITMENT);
+        }
+    } else {
+        const QVariantMap input{
+            { "is_witness", true },
+            { "input_tx", txn },
+            { "script", SCRIPT },
+            { "path", QVariantList{ 2147483697u, 2147483649u, 2147483648u, 0, 3 } },
+            { "ae_host_commitment", COMMITMENT },
+        };
+        QBENCHMARK {
+            buffer = Request(2, "tx_input", QCborMap::fromVariantMap(input)).toCborValue().toCbor();
+        }
+    }
+    QVERIFY(buffer.size() > size);
+}
@@ -0,0 +1,19 @@
+#ifndef GREEN_CBORBENCHMARK_H
+#define GREEN_CBORBENCHMARK_H
+
+#include <QObject>
+
+// Measures the encoding of Jade sign_tx and tx_input requests for growing
+// transactions, written with JadeRequestWriter and, for comparison, built as
+// a QCborMap and serialised as JadeAPI used to. Nothing is sent.
+class CborBenchmark : public QObject
+{
+    Q_OBJECT
+private slots:
+    void signTx_data();
+    void signTx();
+    void txInput_data();
+    void txInput();
+};
+
+#endif // GREEN_CBORBENCHMARK_H
@@ -0,0 +1,101 @@
+#include "devicebenchmark.h"
+
+#include "devicemanager.h"
+#include "ledgerdevice.h"
+#include "ledgeremulator.h"
+#include "networkmanager.h"
+
+#include <QCryptographicHash>
+#include <QTest>
+#include <QUuid>
+
+namespace {
+
+QByteArray MasterPublicKey(int index)
+{
+    return QCryptographicHash::hash(QByteArray::number(index), QCryptographicHash::Sha256);
+}
+
+QList<LedgerDevice*> CreateDevices(int count)
+{
+    auto network = NetworkManager::instance()->networks().first();
+    QList<LedgerDevice*> devices;
+    for (int i = 0; i < count; ++i) {
+        auto device = LedgerEmulatorPrivate::create();
+        device->setMasterPublicKey(network, MasterPublicKey(i));
+        devices.append(device);
+    }
+    return devices;
+}
+
+} // namespace
+
+void DeviceBenchmark::addRemove_data()
+{
+    QTest::addColumn<int>("count");
+    for (int count : { 10, 100, 1000 }) {
+        QTest::addRow("%d", count) << count;
+    }
+}
+
+void DeviceBenchmark::addRemove()
+{
+    QFETCH(int, count);
+    auto manager = DeviceManager::instance();
+    const auto devices = CreateDevices(count);
+
+    QBENCHMARK {
+        for (auto device : devices) manager->addDevice(device);
+        for (auto device : devices) manager->removeDevice(device);
+    }
+    qDeleteAll(devices);
+}
+
+void DeviceBenchmark::lookup_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<QString>("ids");
+    for (const char* ids : { "connected", "reconnected", "unknown" }) {
+        for (int count : { 10, 100, 1000 }) {
+            QTest::addRow("%s/%d", ids, count) << count << QString(ids);
+        }
+    }
+}
+
+void DeviceBenchmark::lookup()
+{
+    QFETCH(int, count);
+    QFETCH(QString, ids);
+    auto manager = DeviceManager::instance();
+
+    // devices that go away, their ids are looked up after they reconnect
+    QStringList stale_ids;
+    for (auto device : CreateDevices(count)) {
+        stale_ids.append(device->uuid());
+        manager->addDevice(device);
+        manager->removeDevice(device);
+        delete device;
+    }
+
+    const auto devices = CreateDevices(count);
+    QStringList connected_ids;
+    for (auto device : devices) {
+        connected_ids.append(device->uuid());
+        manager->addDevice(device);
+    }
+
+    QStringList lookup_ids = connected_ids;
+    if (ids == "reconnected") lookup_ids = stale_ids;
+    if (ids == "unknown") lookup_ids = QStringList{ QUuid::createUuid().toString(QUuid::WithoutBraces) };
+    const bool expected = ids != "unknown";
+
+    int i = 0;
+    bool found = expected;
+    QBENCHMARK {
+        found = manager->deviceWithId(lookup_ids.at(i++ % lookup_ids.size()));
+    }
+
+    for (auto device : devices) manager->removeDevice(device);
+    qDeleteAll(devices);
+    QCOMPARE(found, expected);
+}
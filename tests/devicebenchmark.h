@@ -0,0 +1,20 @@
+#ifndef GREEN_DEVICEBENCHMARK_H
+#define GREEN_DEVICEBENCHMARK_H
+
+#include <QObject>
+
+// Measures the DeviceManager indexes with many simulated devices: adding and
+// removing them, and deviceWithId for connected devices, for ids of devices
+// that reconnected under a new id with the same master xpub, and for unknown
+// ids. Devices are Ledger emulators, their xpubs are made up.
+class DeviceBenchmark : public QObject
+{
+    Q_OBJECT
+private slots:
+    void addRemove_data();
+    void addRemove();
+    void lookup_data();
+    void lookup();
+};
+
+#endif // GREEN_DEVICEBENCHMARK_H
@@ -0,0 +1,197 @@
+#include "hidrawbenchmark.h"
+
+#ifdef Q_OS_LINUX
+
+#include "command.h"
+#include "devicediscoveryagent_linux.h"
+#include "ledgerdevice.h"
+
+#include <QEventLoop>
+#include <QTest>
+#include <QThread>
+#include <QTimer>
+
+#include <atomic>
+#include <cstring>
+#include <functional>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+// APDUs per iteration and the size of the stand-in responses, about the size
+// of a trusted input
+const int APDU_COUNT = 200;
+const int RESPONSE_SIZE = 56;
+// in ms, an iteration that takes longer fails
+const int EXCHANGE_TIMEOUT = 60 * 1000;
+
+// sends APDU_COUNT APDUs and waits for the last response, false if one fails
+bool Exchange(LedgerDevice* device, const QByteArray& payload, bool pipelined)
+{
+    int done = 0;
+    bool failed = false;
+    QEventLoop loop;
+    // connections made with this context are dropped once the run is over
+    QObject scope;
+    auto check = [&] {
+        if (failed || done == APDU_COUNT) loop.quit();
+    };
+
+    CommandBatch* batch = nullptr;
+    std::function<void()> send;
+    if (pipelined) {
+        batch = new CommandBatch;
+        for (int i = 0; i < APDU_COUNT; ++i) {
+            auto command = new LedgerGenericCommand(device, payload);
+            command->setParent(batch);
+            batch->add(command);
+        }
+        QObject::connect(batch, &Command::finished, &scope, [&] { done = APDU_COUNT; check(); });
+        QObject::connect(batch, &Command::error, &scope, [&] { failed = true; check(); });
+        batch->exec();
+    } else {
+        send = [&] {
+            auto command = device->exchange(payload);
+            QObject::connect(command, &Command::finished, &scope, [&, command] {
+                command->deleteLater();
+                if (++done < APDU_COUNT) send(); else check();
+            });
+            QObject::connect(command, &Command::error, &scope, [&, command] {
+                command->deleteLater();
+                failed = true;
+                check();
+            });
+        };
+        send();
+    }
+    QTimer::singleShot(EXCHANGE_TIMEOUT, &loop, [&] {
+        failed = true;
+        loop.quit();
+    });
+    if (!failed && done < APDU_COUNT) loop.exec();
+    if (batch) batch->deleteLater();
+    return !failed && done == APDU_COUNT;
+}
+
+} // namespace
+
+// Reassembles the APDUs written by the I/O thread and answers each one, after
+// the configured latency, with RESPONSE_SIZE bytes and the 0x9000 status.
+class HidrawStandIn : public QThread
+{
+public:
+    explicit HidrawStandIn(int fd) : m_fd(fd) {}
+    void setLatency(int latency) { m_latency = latency; }
+protected:
+    void run() override
+    {
+        QByteArray apdu;
+        int expected = 0;
+        uint8_t report[65];
+        // returns 0 once the transport closes its end
+        while (::read(m_fd, report, sizeof(report)) == sizeof(report)) {
+            // report id, channel, tag, index and, in the first report, the length
+            const uint8_t* p = report + 1;
+            const uint16_t index = (p[3] << 8) | p[4];
+            p += 5;
+            if (index == 0) {
+                expected = (p[0] << 8) | p[1];
+                p += 2;
+                apdu.clear();
+            }
+            const int chunk = qMin(int(report + sizeof(report) - p), expected - apdu.size());
+            apdu.append(reinterpret_cast<const char*>(p), chunk);
+            if (apdu.size() < expected) continue;
+            if (m_latency > 0) QThread::usleep(m_latency);
+            respond(QByteArray(RESPONSE_SIZE, 0x01) + QByteArray::fromHex("9000"));
+        }
+    }
+private:
+    void respond(const QByteArray& response)
+    {
+        uint8_t report[64];
+        int offset = 0;
+        uint16_t index = 0;
+        do {
+            memset(report, 0, sizeof(report));
+            uint8_t* p = report;
+            *p++ = 0x01;
+            *p++ = 0x01;
+            *p++ = 0x05;
+            *p++ = index >> 8;
+            *p++ = index & 0xff;
+            if (index == 0) {
+                *p++ = response.size() >> 8;
+                *p++ = response.size() & 0xff;
+            }
+            const int chunk = qMin(int(report + sizeof(report) - p), response.size() - offset);
+            memcpy(p, response.constData() + offset, chunk);
+            offset += chunk;
+            ++index;
+            if (::write(m_fd, report, sizeof(report)) != sizeof(report)) return;
+        } while (offset < response.size());
+    }
+    const int m_fd;
+    // in microseconds
+    std::atomic<int> m_latency{0};
+};
+
+void HidrawBenchmark::initTestCase()
+{
+    QVERIFY(socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, m_fds) == 0);
+    m_stand_in = new HidrawStandIn(m_fds[1]);
+    m_stand_in->start();
+
+    // not published to the device manager
+    auto impl = new DevicePrivateImpl;
+    impl->handle = nullptr;
+    impl->fd = m_fds[0];
+    impl->m_type = Device::LedgerNanoS;
+    impl->start();
+    m_device = new LedgerDevice(impl);
+}
+
+void HidrawBenchmark::cleanupTestCase()
+{
+    // stops the I/O thread and closes its end, which ends the stand-in
+    delete m_device;
+    m_device = nullptr;
+    if (m_stand_in) {
+        m_stand_in->wait();
+        delete m_stand_in;
+        m_stand_in = nullptr;
+    }
+    if (m_fds[1] >= 0) close(m_fds[1]);
+}
+
+void HidrawBenchmark::exchange_data()
+{
+    QTest::addColumn<int>("latency");
+    QTest::addColumn<int>("size");
+    QTest::addColumn<bool>("pipelined");
+    for (int latency : { 0, 1000 }) {
+        for (int size : { 0, 64, 250 }) {
+            QTest::addRow("sequential/%dus/%d", latency, size) << latency << size << false;
+            QTest::addRow("pipelined/%dus/%d", latency, size) << latency << size << true;
+        }
+    }
+}
+
+void HidrawBenchmark::exchange()
+{
+    QFETCH(int, latency);
+    QFETCH(int, size);
+    QFETCH(bool, pipelined);
+    m_stand_in->setLatency(latency);
+    const auto payload = apdu(BTCHIP_CLA, BTCHIP_INS_GET_TRUSTED_INPUT, 0x80, 0x00, QByteArray(size, 0));
+
+    bool ok = true;
+    QBENCHMARK {
+        ok = Exchange(m_device, payload, pipelined) && ok;
+    }
+    QVERIFY(ok);
+}
+
+#endif // Q_OS_LINUX
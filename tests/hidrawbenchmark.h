@@ -0,0 +1,34 @@
+#ifndef GREEN_HIDRAWBENCHMARK_H
+#define GREEN_HIDRAWBENCHMARK_H
+
+#include <QtGlobal>
+
+#ifdef Q_OS_LINUX
+#include <QObject>
+
+QT_FORWARD_DECLARE_CLASS(LedgerDevice)
+
+class HidrawStandIn;
+
+// Measures the Linux hidraw transport, I/O thread included, against a
+// stand-in device on the other end of a SOCK_SEQPACKET socket pair, which
+// keeps the 65 and 64 byte report boundaries of hidraw. Each iteration sends
+// a run of APDUs, one at a time from the response handler of the previous
+// one or pipelined in a command batch, for a few sizes and device latencies.
+class HidrawBenchmark : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void exchange_data();
+    void exchange();
+private:
+    int m_fds[2]{-1, -1};
+    HidrawStandIn* m_stand_in{nullptr};
+    LedgerDevice* m_device{nullptr};
+};
+
+#endif // Q_OS_LINUX
+
+#endif // GREEN_HIDRAWBENCHMARK_H
@@ -0,0 +1,157 @@
+#include "ledgerbenchmark.h"
+
+#include "activitymanager.h"
+#include "device.h"
+#include "ledgerdevice.h"
+#include "ledgeremulator.h"
+
+#include <QDataStream>
+#include <QEventLoop>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QTest>
+#include <QTimer>
+
+namespace {
+
+const QByteArray SCRIPT = QByteArray::fromHex("0014751e76e8199196d454941c45d1b3a323f1433bd6");
+// in ms, a signing that takes longer fails
+const int SIGN_TIMEOUT = 10 * 60 * 1000;
+
+struct Transaction
+{
+    QJsonObject transaction;
+    QJsonArray signing_inputs;
+    QJsonArray outputs;
+    QJsonObject signing_transactions;
+};
+
+// a one input, two output transaction, it stands in for the transactions
+// spent by the inputs
+QByteArray PreviousTransaction()
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream << quint32(2) << quint8(1);
+    stream.writeRawData(QByteArray(32, 0x01).constData(), 32);
+    stream << quint32(0) << quint8(0) << quint32(0xffffffff);
+    stream << quint8(2);
+    for (int i = 0; i < 2; ++i) {
+        stream << quint64(100000) << quint8(SCRIPT.size());
+        stream.writeRawData(SCRIPT.constData(), SCRIPT.size());
+    }
+    stream << quint32(0);
+    return data;
+}
+
+Transaction MakeTransaction(int inputs)
+{
+    const QString previous = PreviousTransaction().toHex();
+    Transaction tx;
+    tx.transaction = {{ "transaction_version", 2 }, { "transaction_locktime", 0 }};
+    for (int i = 0; i < inputs; ++i) {
+        const QString txhash = QString::number(i, 16).rightJustified(64, '0');
+        tx.signing_transactions.insert(txhash, previous);
+        tx.signing_inputs.append(QJsonObject{
+            { "address_type", "p2wpkh" },
+            { "txhash", txhash },
+            { "pt_idx", 0 },
+            { "sequence", double(0xfffffffd) },
+            { "satoshi", 100000 },
+            { "prevout_script", QString(SCRIPT.toHex()) },
+            { "user_path", QJsonArray{ 2147483732.0, 2147483649.0, 2147483648.0, 0, i } },
+        });
+    }
+    for (int i = 0; i < 2; ++i) {
+        tx.outputs.append(QJsonObject{{ "satoshi", 50000 }, { "script", QString(SCRIPT.toHex()) }});
+    }
+    return tx;
+}
+
+// runs the signing activity, false if it fails or times out
+bool Sign(LedgerDevice* device, const Transaction& tx)
+{
+    auto activity = device->signTransaction(nullptr, tx.transaction, tx.signing_inputs, tx.outputs, tx.signing_transactions);
+    bool finished = false;
+    bool failed = false;
+    QEventLoop loop;
+    QObject::connect(activity, &Activity::finished, &loop, [&] { finished = true; loop.quit(); });
+    QObject::connect(activity, &Activity::failed, &loop, [&] { failed = true; loop.quit(); });
+    QTimer::singleShot(SIGN_TIMEOUT, &loop, &QEventLoop::quit);
+    ActivityManager::instance()->exec(activity);
+    if (!finished && !failed) loop.exec();
+    const bool signed_all = finished && activity->signatures().size() == tx.signing_inputs.size();
+    activity->deleteLater();
+    return signed_all;
+}
+
+void AddRows()
+{
+    QTest::addColumn<int>("inputs");
+    QTest::addColumn<bool>("cached");
+    for (int inputs : { 1, 10, 50 }) {
+        QTest::addRow("fetched/%d", inputs) << inputs << false;
+        QTest::addRow("cached/%d", inputs) << inputs << true;
+    }
+}
+
+} // namespace
+
+void LedgerBenchmark::initTestCase()
+{
+    if (!qEnvironmentVariableIsSet("GREEN_LEDGER_EMULATOR_LATENCY")) {
+        qputenv("GREEN_LEDGER_EMULATOR_LATENCY", "0");
+    }
+    m_emulator = new LedgerEmulatorPrivate;
+    m_device = new LedgerDevice(m_emulator);
+}
+
+void LedgerBenchmark::cleanupTestCase()
+{
+    delete m_device;
+    m_device = nullptr;
+    m_emulator = nullptr;
+}
+
+void LedgerBenchmark::sign_data()
+{
+    AddRows();
+}
+
+void LedgerBenchmark::sign()
+{
+    QFETCH(int, inputs);
+    QFETCH(bool, cached);
+    const auto tx = MakeTransaction(inputs);
+
+    // a new session drops the cached trusted inputs
+    m_device->startSession();
+    if (cached) QVERIFY(Sign(m_device, tx));
+
+    bool ok = true;
+    QBENCHMARK {
+        if (!cached) m_device->startSession();
+        ok = Sign(m_device, tx) && ok;
+    }
+    QVERIFY(ok);
+}
+
+void LedgerBenchmark::signApdus_data()
+{
+    AddRows();
+}
+
+void LedgerBenchmark::signApdus()
+{
+    QFETCH(int, inputs);
+    QFETCH(bool, cached);
+    const auto tx = MakeTransaction(inputs);
+
+    m_device->startSession();
+    if (cached) QVERIFY(Sign(m_device, tx));
+
+    const qint64 start = m_emulator->apduCount();
+    QVERIFY(Sign(m_device, tx));
+    QTest::setBenchmarkResult(m_emulator->apduCount() - start, QTest::Events);
+}
@@ -0,0 +1,29 @@
+#ifndef GREEN_LEDGERBENCHMARK_H
+#define GREEN_LEDGERBENCHMARK_H
+
+#include <QObject>
+
+QT_FORWARD_DECLARE_CLASS(LedgerDevice)
+QT_FORWARD_DECLARE_CLASS(LedgerEmulatorPrivate)
+
+// Signs transactions with a growing number of segwit inputs through
+// LedgerSignTransactionActivity on the Ledger emulator, with the trusted
+// inputs fetched again for every signing or cached. sign times the signing,
+// signApdus reports the APDUs it takes. The emulator answers without latency
+// unless GREEN_LEDGER_EMULATOR_LATENCY is set.
+class LedgerBenchmark : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void sign_data();
+    void sign();
+    void signApdus_data();
+    void signApdus();
+private:
+    LedgerEmulatorPrivate* m_emulator{nullptr};
+    LedgerDevice* m_device{nullptr};
+};
+
+#endif // GREEN_LEDGERBENCHMARK_H
@@ -0,0 +1,68 @@
+#include "logbenchmark.h"
+
+#include "logger.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QTest>
+#include <QThread>
+
+namespace {
+
+const QString MESSAGE = QStringLiteral("wallet: account 3 transactions updated, 25 new, 1024 total");
+// idle periods measured by wake
+const int WAKE_COUNT = 200;
+// long enough for the logger thread to go idle
+const int IDLE_INTERVAL = 5;
+
+} // namespace
+
+void LogBenchmark::initTestCase()
+{
+    auto logger = Logger::instance();
+    QVERIFY(!logger->isRunning());
+    m_file_name = QDir::temp().filePath("green-logbenchmark.txt");
+    logger->setFileName(m_file_name);
+    logger->open();
+}
+
+void LogBenchmark::cleanupTestCase()
+{
+    Logger::instance()->stop();
+    QFile::remove(m_file_name);
+}
+
+void LogBenchmark::burst_data()
+{
+    QTest::addColumn<int>("burst");
+    for (int burst : { 1, 16, 256 }) {
+        QTest::addRow("%d", burst) << burst;
+    }
+}
+
+void LogBenchmark::burst()
+{
+    QFETCH(int, burst);
+    auto logger = Logger::instance();
+    QBENCHMARK {
+        for (int i = 0; i < burst; ++i) {
+            logger->log("app:debug", MESSAGE);
+        }
+    }
+}
+
+void LogBenchmark::wake()
+{
+    // QBENCHMARK would time the idle periods too, the calls are timed one by
+    // one and the mean is reported instead
+    auto logger = Logger::instance();
+    QElapsedTimer timer;
+    qint64 total = 0;
+    for (int n = 0; n < WAKE_COUNT; ++n) {
+        QThread::msleep(IDLE_INTERVAL);
+        timer.start();
+        logger->log("app:debug", MESSAGE);
+        total += timer.nsecsElapsed();
+    }
+    QTest::setBenchmarkResult(qreal(total) / WAKE_COUNT, QTest::WalltimeNanoseconds);
+}
@@ -0,0 +1,22 @@
+#ifndef GREEN_LOGBENCHMARK_H
+#define GREEN_LOGBENCHMARK_H
+
+#include <QObject>
+
+// Measures the time a log call takes on the calling thread, for bursts of
+// messages, and for the first call after the logger thread went idle, which
+// also pays for waking it. Logs to a temporary file.
+class LogBenchmark : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void burst_data();
+    void burst();
+    void wake();
+private:
+    QString m_file_name;
+};
+
+#endif // GREEN_LOGBENCHMARK_H
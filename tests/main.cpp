@@ -0,0 +1,62 @@
+#include "cborbenchmark.h"
+#include "devicebenchmark.h"
+#include "ga.h"
+#include "hidrawbenchmark.h"
+#include "ledgerbenchmark.h"
+#include "logbenchmark.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include <memory>
+#include <vector>
+
+extern QString g_data_location;
+QCommandLineParser g_args;
+
+// Runs every benchmark, or the one named by the first argument, the other
+// arguments go to QTest, ie.
+//   green-tests DeviceBenchmark lookup -iterations 1000
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    // keeps the gdk data and the device state away from the app
+    QTemporaryDir data_dir;
+    g_data_location = data_dir.path();
+    // the app options stay unset, the arguments belong to QTest
+    g_args.addOption(QCommandLineOption("debug"));
+    g_args.addOption(QCommandLineOption("gdkrecord", "", "file"));
+    g_args.addOption(QCommandLineOption("gdkreplay", "", "file"));
+    g_args.parse({ app.arguments().first() });
+    gdk::init(g_args);
+
+    std::vector<std::unique_ptr<QObject>> tests;
+    tests.emplace_back(new CborBenchmark);
+    tests.emplace_back(new DeviceBenchmark);
+#ifdef Q_OS_LINUX
+    tests.emplace_back(new HidrawBenchmark);
+#endif
+    tests.emplace_back(new LedgerBenchmark);
+    tests.emplace_back(new LogBenchmark);
+
+    QStringList arguments = app.arguments();
+    QString name;
+    if (arguments.size() > 1 && !arguments.at(1).startsWith('-')) name = arguments.takeAt(1);
+
+    int status = 0;
+    bool found = false;
+    for (const auto& test : tests) {
+        if (!name.isEmpty() && name != test->metaObject()->className()) continue;
+        found = true;
+        status |= QTest::qExec(test.get(), arguments);
+    }
+    if (!found) {
+        qWarning() << "unknown benchmark" << name;
+        return 1;
+    }
+    return status;
+}
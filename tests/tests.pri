@@ -0,0 +1,26 @@
+# QtTest benchmarks of the parts that need neither a wallet nor the UI,
+# green-tests. Enable with
+#   qmake CONFIG+=test
+# It replaces the QML UI and src/main.cpp and builds with the mock gdk, for
+# the emulators, see tests/main.cpp to run one of them.
+
+SOURCES -= $$clean_path($$PWD/../src/main.cpp)
+
+QT += testlib
+
+INCLUDEPATH += $$PWD
+
+SOURCES += \
+    $$PWD/cborbenchmark.cpp \
+    $$PWD/devicebenchmark.cpp \
+    $$PWD/hidrawbenchmark.cpp \
+    $$PWD/ledgerbenchmark.cpp \
+    $$PWD/logbenchmark.cpp \
+    $$PWD/main.cpp
+
+HEADERS += \
+    $$PWD/cborbenchmark.h \
+    $$PWD/devicebenchmark.h \
+    $$PWD/hidrawbenchmark.h \
+    $$PWD/ledgerbenchmark.h \
+    $$PWD/logbenchmark.h